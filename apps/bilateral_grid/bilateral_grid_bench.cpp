@@ -0,0 +1,104 @@
+// Benchmark the root and streaming CPU schedules of the bilateral grid
+// at 4K and 8K, over a range of thread counts, and check that they
+// agree.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+#include "halide_benchmark.h"
+
+#include "bilateral_grid.h"
+#include "bilateral_grid_root.h"
+
+using namespace Halide::Runtime;
+using namespace Halide::Tools;
+
+int main(int argc, char **argv) {
+    const float r_sigma = 0.1f;
+
+    int max_threads = (int)std::thread::hardware_concurrency();
+    if (argc == 2) {
+        max_threads = atoi(argv[1]);
+    } else if (argc != 1) {
+        printf("Usage: %s [max_threads]\n", argv[0]);
+        return -1;
+    }
+    max_threads = std::max(max_threads, 1);
+
+    // Powers of two up to the number of cores, and the number of cores.
+    std::vector<int> thread_counts;
+    for (int t = 1; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+
+    struct Size {
+        const char *name;
+        int width, height;
+    };
+    const Size sizes[] = {{"4K", 3840, 2160}, {"8K", 7680, 4320}};
+
+    for (const Size &size : sizes) {
+        // A smooth gradient with some noise, so the grid is spread
+        // across many values of z.
+        Buffer<float> input(size.width, size.height);
+        input.for_each_element([&](int x, int y) {
+            input(x, y) = (float)((x + y) % 1024) / 1024.0f + (rand() % 64) / 1024.0f;
+        });
+        Buffer<float> out_root(size.width, size.height), out_streaming(size.width, size.height);
+
+        bilateral_grid_root(input, r_sigma, out_root);
+        bilateral_grid(input, r_sigma, out_streaming);
+        for (int y = 0; y < size.height; y++) {
+            for (int x = 0; x < size.width; x++) {
+                float a = out_root(x, y), b = out_streaming(x, y);
+                if (std::abs(a - b) > 1e-4f * std::max(1.0f, std::abs(a))) {
+                    printf("%s: out_streaming(%d, %d) = %f instead of %f\n",
+                           size.name, x, y, b, a);
+                    return -1;
+                }
+            }
+        }
+
+        const double mpix = (double)size.width * size.height / 1e6;
+        printf("%s (%dx%d)\n", size.name, size.width, size.height);
+        printf("%8s %12s %12s %12s %12s %12s\n",
+               "threads", "root (ms)", "stream (ms)", "MPix/s", "speedup", "efficiency");
+
+        double t_single = 0;
+        for (int threads : thread_counts) {
+            halide_set_num_threads(threads);
+
+            BenchmarkResult r_root = benchmark([&]() {
+                bilateral_grid_root(input, r_sigma, out_root);
+            });
+            BenchmarkResult r_streaming = benchmark([&]() {
+                bilateral_grid(input, r_sigma, out_streaming);
+            });
+
+            const std::string suffix = std::string("_") + size.name + "_t" + std::to_string(threads);
+            report_benchmark("bilateral_grid_root" + suffix, r_root);
+            report_benchmark("bilateral_grid_streaming" + suffix, r_streaming);
+
+            // Thread scaling is reported for the streaming schedule.
+            if (threads == 1) {
+                t_single = r_streaming.min;
+            }
+            const double speedup = t_single / r_streaming.min;
+            printf("%8d %12.2f %12.2f %12.1f %11.2fx %11.0f%%\n",
+                   threads, r_root.min * 1e3, r_streaming.min * 1e3,
+                   mpix / r_streaming.min, speedup, 100 * speedup / threads);
+        }
+        halide_set_num_threads(0);
+    }
+
+    printf("Success!\n");
+    return 0;
+}
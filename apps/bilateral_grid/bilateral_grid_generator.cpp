@@ -2,9 +2,31 @@
 
 namespace {
 
+enum class BilateralGridCPUSchedule {
+    Root,      // Each stage of the grid is computed over the whole
+               // image before the next one starts.
+    Streaming, // Each strip of output rows splats, blurs and slices its
+               // own rows of the grid, which stay in cache.
+};
+
+std::map<std::string, BilateralGridCPUSchedule> bilateralGridCPUScheduleEnumMap() {
+    return {
+        {"root",      BilateralGridCPUSchedule::Root},
+        {"streaming", BilateralGridCPUSchedule::Streaming},
+    };
+};
+
 class BilateralGrid : public Halide::Generator<BilateralGrid> {
 public:
     GeneratorParam<int>   s_sigma{"s_sigma", 8};
+    GeneratorParam<BilateralGridCPUSchedule> cpu_schedule{
+        "cpu_schedule",
+        BilateralGridCPUSchedule::Streaming,
+        bilateralGridCPUScheduleEnumMap()
+    };
+    // The number of rows of the grid in each strip of the streaming
+    // schedule.
+    GeneratorParam<int>   strip_size{"strip_size", 16};
 
     ImageParam            input{Float(32), 2, "input"};
     Param<float>          r_sigma{"r_sigma"};
@@ -89,7 +111,7 @@ public:
             blurx.compute_root().gpu_tile(x, y, z, xi, yi, zi, 8, 8, 1);
             blury.compute_root().gpu_tile(x, y, z, xi, yi, zi, 8, 8, 1);
             bilateral_grid.compute_root().gpu_tile(x, y, xi, yi, s_sigma, s_sigma);
-        } else {
+        } else if (cpu_schedule == BilateralGridCPUSchedule::Root) {
             // The CPU schedule.
             blurz.compute_root().reorder(c, z, x, y).parallel(y).vectorize(x, 8).unroll(c);
             histogram.compute_at(blurz, y);
@@ -97,6 +119,36 @@ public:
             blurx.compute_root().reorder(c, x, y, z).parallel(z).vectorize(x, 8).unroll(c);
             blury.compute_root().reorder(c, x, y, z).parallel(z).vectorize(x, 8).unroll(c);
             bilateral_grid.compute_root().parallel(y).vectorize(x, 8);
+        } else {
+            // The streaming CPU schedule. The output is split into
+            // strips of strip_size rows of the grid, which run in
+            // parallel. Within a strip, each stage of the grid is
+            // computed a row at a time, just before the output rows
+            // that need it, and kept in a buffer that slides down
+            // the strip. Only the first few rows of the grid in each
+            // strip are computed twice.
+            //
+            // The splat doesn't need per-thread partial grids: each
+            // cell of the grid gathers from its own block of the
+            // input, so strips never write to the same cell, and the
+            // splat runs in parallel along with the rest of the
+            // strip.
+            //
+            // The last strip is guarded rather than shifted inwards,
+            // so that images shorter than one strip still work.
+            Var yo("yo");
+            bilateral_grid.compute_root()
+                .split(y, yo, y, s_sigma * (int)strip_size, TailStrategy::GuardWithIf)
+                .parallel(yo)
+                .vectorize(x, 8);
+            blury.store_at(bilateral_grid, yo).compute_at(bilateral_grid, y)
+                .reorder(c, x, z, y).vectorize(x, 8).unroll(c);
+            blurx.store_at(bilateral_grid, yo).compute_at(bilateral_grid, y)
+                .reorder(c, x, z, y).vectorize(x, 8).unroll(c);
+            blurz.store_at(bilateral_grid, yo).compute_at(bilateral_grid, y)
+                .reorder(c, z, x, y).vectorize(x, 8).unroll(c);
+            histogram.compute_at(blurz, y);
+            histogram.update().reorder(c, r.x, r.y, x, y).unroll(c);
         }
 
         return bilateral_grid;
@@ -29,10 +29,13 @@ int main(int argc, char **argv) {
 
     // Timing code. Timing doesn't include copying the input data to
     // the gpu or copying the output back.
-    double min_t = benchmark(timing_iterations, 10, [&]() {
+    BenchmarkConfig config;
+    config.min_samples = timing_iterations;
+    BenchmarkResult t = benchmark([&]() {
         bilateral_grid(input, r_sigma, output);
-    });
-    printf("Time: %gms\n", min_t * 1e3);
+    }, config);
+    report_benchmark("bilateral_grid", t);
+    printf("Time: %gms (median %gms, p90 %gms)\n", t.min * 1e3, t.median * 1e3, t.p90 * 1e3);
 
     save_image(output, argv[2]);
 
@@ -61,22 +61,24 @@ int main(int argc, char **argv) {
     int blackLevel = 25;
     int whiteLevel = 1023;
 
+    BenchmarkConfig config;
+    config.min_samples = timing_iterations;
     double best;
 
-    best = benchmark(timing_iterations, 1, [&]() {
+    best = report_benchmark("camera_pipe", benchmark([&]() {
         camera_pipe(input, matrix_3200, matrix_7000,
                     color_temp, gamma, contrast, blackLevel, whiteLevel,
                     output);
-    });
+    }, config));
     fprintf(stderr, "Halide:\t%gus\n", best * 1e6);
     fprintf(stderr, "output: %s\n", argv[6]);
     save_image(output, argv[6]);
     fprintf(stderr, "        %d %d\n", output.width(), output.height());
 
     Buffer<uint8_t> output_c(output.width(), output.height(), output.channels());
-    best = benchmark(timing_iterations, 1, [&]() {
+    best = benchmark([&]() {
         FCam::demosaic(input, output_c, color_temp, contrast, true, blackLevel, whiteLevel, gamma);
-    });
+    }, config);
     fprintf(stderr, "C++:\t%gus\n", best * 1e6);
     if (argc > 7) {
         fprintf(stderr, "output_c: %s\n", argv[7]);
@@ -85,9 +87,9 @@ int main(int argc, char **argv) {
     fprintf(stderr, "        %d %d\n", output_c.width(), output_c.height());
 
     Buffer<uint8_t> output_asm(output.width(), output.height(), output.channels());
-    best = benchmark(timing_iterations, 1, [&]() {
+    best = benchmark([&]() {
         FCam::demosaic_ARM(input, output_asm, color_temp, contrast, true, blackLevel, whiteLevel, gamma);
-    });
+    }, config);
     fprintf(stderr, "ASM:\t%gus\n", best * 1e6);
     if (argc > 8) {
         fprintf(stderr, "output_asm: %s\n", argv[8]);
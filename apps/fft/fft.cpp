@@ -6,7 +6,9 @@
 
 #include <cassert>
 #include <cmath>
+#include <complex>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <map>
 #include <ostream>
@@ -62,6 +64,37 @@ int product(const vector<int> &R) {
     return p;
 }
 
+// Compute a factorization of N suitable for use in the FFT.
+vector<int> radix_factor(int N) {
+    // Some special cases to optimize.
+    switch (N) {
+    case 16: return { 4, 4 };
+    case 32: return { 8, 4 };
+    case 64: return { 8, 8 };
+    case 128: return { 8, 4, 4 };
+    case 256: return { 8, 8, 4 };
+    }
+
+    // Factor N into factors found in the 'radices' set. The odd radices
+    // only pick up what the even ones leave behind.
+    static const int radices[] = { 8, 6, 4, 2, 3, 5, 7 };
+    vector<int> R;
+    for (int r : radices) {
+        while (N % r == 0) {
+            R.push_back(r);
+            N /= r;
+        }
+    }
+
+    // If there are still factors left over, just include them as a radix.
+    if (N != 1 || R.empty()) {
+        R.push_back(N);
+    }
+
+    return R;
+}
+
+
 // These tersely named functions concatenate vectors of Var/Expr for use
 // in generating argument lists to Halide functions. They are named to avoid
 // bloating the code, since these are used extremely frequently, and often many
@@ -469,6 +502,227 @@ std::pair<FuncType, FuncType> tiled_transpose(FuncType f, int max_tile_size,
     return { fT, f_tiledT };
 }
 
+// Sizes with prime factors larger than this are computed with Bluestein's
+// algorithm, rather than with a direct DFT of the leftover factor.
+const int kMaxRadix = 16;
+
+bool needs_bluestein(const vector<int> &R) {
+    return *std::max_element(R.begin(), R.end()) > kMaxRadix;
+}
+
+// Compute the DFT of a in place, in double precision. The size of a must be
+// a power of 2. This is only used to precompute constant data for the
+// pipelines defined here.
+void host_fft(vector<std::complex<double>> &a, int sign) {
+    const int N = (int)a.size();
+    for (int i = 1, j = 0; i < N; i++) {
+        int bit = N >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(a[i], a[j]);
+        }
+    }
+    for (int len = 2; len <= N; len *= 2) {
+        for (int i = 0; i < N; i += len) {
+            for (int k = 0; k < len / 2; k++) {
+                std::complex<double> w = std::polar(1.0, sign * 2 * M_PI * k / len);
+                std::complex<double> u = a[i + k];
+                std::complex<double> v = a[i + k + len / 2] * w;
+                a[i + k] = u + v;
+                a[i + k + len / 2] = u - v;
+            }
+        }
+    }
+}
+
+// Compute the N point DFT of dimension dim of x with Bluestein's
+// algorithm. Substituting nk = (n^2 + k^2 - (k - n)^2)/2 turns the DFT into a
+// convolution with the chirp w_n = e^(sign*j*pi*n^2/N):
+//
+//   X_k = w_k * sum[ (x_n w_n) (w_(k - n))* ]
+//
+// We compute this as a cyclic convolution of size M >= 2N - 1, where M is a
+// power of 2, so the DFT costs about two FFTs of size M for any N.
+// fft_M(f, M, sign, prefix) should compute the M point DFT of dimension dim
+// of f. The two transforms it defines are returned in fwd and inv so the
+// caller can schedule them.
+template <typename FFT>
+ComplexFunc bluestein(ComplexFunc x, int dim, int N, int sign, Expr gain,
+                      const string& prefix, FFT fft_M,
+                      ComplexFunc *fwd, ComplexFunc *inv) {
+    int M = 1;
+    while (M < 2 * N - 1) {
+        M *= 2;
+    }
+
+    // Compute the chirp and the DFT of the convolution kernel up front, in
+    // double precision. Reducing n^2 modulo 2N before converting it to
+    // floating point keeps the chirp accurate for large N.
+    Buffer<float> chirp(N, 2);
+    vector<std::complex<double>> kernel(M, 0.0);
+    for (int n = 0; n < N; n++) {
+        double theta = sign * M_PI * (double)(((int64_t)n * n) % (2 * N)) / N;
+        std::complex<double> w = std::polar(1.0, theta);
+        chirp(n, 0) = (float)w.real();
+        chirp(n, 1) = (float)w.imag();
+        kernel[n] = std::conj(w);
+        if (n > 0) {
+            kernel[M - n] = std::conj(w);
+        }
+    }
+    host_fft(kernel, -1);
+    // Fold the 1/M normalization of the inverse FFT into the kernel.
+    Buffer<float> kernel_dft(M, 2);
+    for (int m = 0; m < M; m++) {
+        kernel_dft(m, 0) = (float)(kernel[m].real() / M);
+        kernel_dft(m, 1) = (float)(kernel[m].imag() / M);
+    }
+
+    vector<Var> args = x.args();
+    Var n = args[dim];
+    vector<Expr> x_args(args.begin(), args.end());
+    Expr n_clamped = min(n, N - 1);
+    x_args[dim] = n_clamped;
+
+    // Multiply by the chirp, and zero pad to M points.
+    ComplexFunc chirped(prefix + "chirped");
+    ComplexExpr w_n(chirp(n_clamped, 0), chirp(n_clamped, 1));
+    chirped(args) = select(n < N, likely(x(x_args) * w_n), ComplexExpr(0.0f, 0.0f));
+
+    // Convolve with the conjugate chirp.
+    *fwd = fft_M(chirped, M, -1, prefix + "conv_fwd_");
+    ComplexFunc conv(prefix + "conv");
+    conv(args) = (*fwd)(args) * ComplexExpr(kernel_dft(n, 0), kernel_dft(n, 1));
+    *inv = fft_M(conv, M, 1, prefix + "conv_inv_");
+
+    // Multiply by the chirp again.
+    ComplexFunc X(prefix + "bluestein");
+    X(args) = (*inv)(args) * ComplexExpr(chirp(n, 0), chirp(n, 1)) * gain;
+    return X;
+}
+
+// Compute the product(R) point DFT of dimension 1 of x. This uses fft_dim1 if
+// the radices R are small, and Bluestein's algorithm otherwise.
+ComplexFunc dft_dim1(ComplexFunc x,
+                     const vector<int>& R,
+                     int sign,
+                     int extent_0,
+                     Expr gain,
+                     bool parallel,
+                     const string& prefix,
+                     const Target& target,
+                     TwiddleFactorSet* twiddle_cache) {
+    if (!needs_bluestein(R)) {
+        return fft_dim1(x, R, sign, extent_0, gain, parallel, prefix, target, twiddle_cache);
+    }
+
+    int N = product(R);
+    auto fft_M = [&](ComplexFunc f, int M, int s, const string& p) {
+        // The two transforms have opposite signs, so they can't share
+        // twiddle factors with each other or with the caller.
+        TwiddleFactorSet cache;
+        return fft_dim1(f, radix_factor(M), s, extent_0, 1.0f, false, p, target, &cache);
+    };
+    ComplexFunc fwd, inv;
+    ComplexFunc X = bluestein(x, 1, N, sign, gain, prefix, fft_M, &fwd, &inv);
+
+    // Like fft_dim1, compute the transforms in groups of columns, and
+    // vectorize within the group.
+    Var n0(x.args()[0]), n1(x.args()[1]);
+    int vector_width = std::min(target.natural_vector_size<float>(), extent_0);
+    X.split(n0, group, n0, vector_width)
+        .reorder(n0, n1, group);
+    if (vector_width > 1) {
+        X.vectorize(n0);
+    }
+    if (parallel) {
+        X.parallel(group);
+    }
+    fwd.compute_at(X, group);
+    inv.compute_at(X, group);
+    X.bound(n1, 0, N);
+
+    return X;
+}
+
+// Compute the N point DFT of dimension 0 of x. Large transforms use the
+// four-step algorithm: with n = n1 + N1*n2 and k = k2 + N2*k1,
+//
+//   X_(k2 + N2*k1) = sum_n1[ W_N1^(n1*k1) W_N^(n1*k2) sum_n2[ W_N2^(n2*k2) x_(n1 + N1*n2) ] ]
+//
+// which is N1 DFTs of size N2 down the columns of an N1 x N2 matrix, a
+// twiddle factor multiplication and transpose, and N2 DFTs of size N1. Each
+// pass works on columns of about sqrt(N) points, vectorized across the
+// columns. The sub-transforms are radix passes if they factor into small
+// radices, or Bluestein's algorithm otherwise. Prime N uses Bluestein's
+// algorithm, with four-step transforms of the padded size.
+ComplexFunc fft1d(ComplexFunc x, int N, int sign, Expr gain, bool parallel,
+                  const string& prefix, const Target& target) {
+    vector<Var> args = x.args();
+    Var n(args[0]);
+    args.erase(args.begin());
+
+    // Get the innermost variable outside the FFT.
+    Var outer = Var::outermost();
+    if (!args.empty()) {
+        outer = args.front();
+    }
+
+    // Find the most square factorization N = N1*N2, with N1 <= N2.
+    int N1 = (int)std::sqrt((double)N);
+    while (N % N1 != 0) {
+        N1--;
+    }
+    int N2 = N / N1;
+
+    ComplexFunc X(prefix + "X1d");
+    if (N < 10) {
+        // Small DFTs are just unrolled.
+        ComplexFunc dft = dftN(x, N, sign, prefix);
+        X(A({n}, args)) = dft(A({n}, args)) * gain;
+        dft.compute_at(X, outer);
+    } else if (N1 == 1) {
+        auto fft_M = [&](ComplexFunc f, int M, int s, const string& p) {
+            return fft1d(f, M, s, 1.0f, parallel, p, target);
+        };
+        ComplexFunc fwd, inv;
+        X = bluestein(x, 0, N, sign, gain, prefix, fft_M, &fwd, &inv);
+        fwd.compute_at(X, outer);
+        inv.compute_at(X, outer);
+    } else {
+        TwiddleFactorSet twiddle_cache;
+        Var n1(n.name() + "_1"), n2(n.name() + "_2");
+
+        ComplexFunc cols(prefix + "cols");
+        cols(A({n1, n2}, args)) = x(A({n1 + n2 * N1}, args));
+        ComplexFunc dft_cols = dft_dim1(cols, radix_factor(N2), sign, N1, 1.0f,
+                                        parallel, prefix + "cols_", target, &twiddle_cache);
+
+        // Apply the twiddle factors, and transpose so the next pass is also
+        // down the columns.
+        ComplexFunc W = twiddle_factors(N, 1.0f, sign, prefix, &twiddle_cache);
+        ComplexFunc rows(prefix + "rows");
+        rows(A({n2, n1}, args)) = dft_cols(A({n1, n2}, args)) * W((n1 * n2) % N);
+        ComplexFunc dft_rows = dft_dim1(rows, radix_factor(N1), sign, N2, gain,
+                                        parallel, prefix + "rows_", target, &twiddle_cache);
+
+        X(A({n}, args)) = dft_rows(A({n % N2, n / N2}, args));
+        dft_cols.compute_at(X, outer);
+        dft_rows.compute_at(X, outer);
+    }
+
+    X.bound(n, 0, N);
+    const int vector_width = target.natural_vector_size<float>();
+    if (N >= vector_width) {
+        X.vectorize(n, vector_width);
+    }
+
+    return X;
+}
+
 }  // namespace
 
 ComplexFunc fft2d_c2c(ComplexFunc x,
@@ -498,7 +752,7 @@ ComplexFunc fft2d_c2c(ComplexFunc x,
     std::tie(xT, x_tiled) = tiled_transpose(x, N1, target, prefix);
 
     // Compute the DFT of dimension 1 (originally dimension 0).
-    ComplexFunc dft1T = fft_dim1(xT,
+    ComplexFunc dft1T = dft_dim1(xT,
                                  R0,
                                  sign,
                                  N1,  // extent of dim 0.
@@ -513,7 +767,7 @@ ComplexFunc fft2d_c2c(ComplexFunc x,
     std::tie(dft1, dft1_tiled) = tiled_transpose(dft1T, N0, target, prefix);
 
     // Compute the DFT of dimension 1.
-    ComplexFunc dft = fft_dim1(dft1,
+    ComplexFunc dft = dft_dim1(dft1,
                                R1,
                                sign,
                                N0,  // extent of dim 0
@@ -527,7 +781,21 @@ ComplexFunc fft2d_c2c(ComplexFunc x,
     if (dft1_tiled.defined()) {
         dft1_tiled.compute_at(dft, group);
     } else {
-        xT.compute_at(dft, outer).vectorize(n0).unroll(n1);
+        xT.compute_at(dft, outer);
+        const int vector_width = target.natural_vector_size<float>();
+        if (N0 * N1 <= 64 * 64 || N0 < vector_width || N1 < vector_width) {
+            xT.vectorize(n0).unroll(n1);
+        } else {
+            // Large transposes are done in tiles, which can be split
+            // across threads.
+            Var n0o("n0o"), n1o("n1o");
+            xT.tile(n0, n1, n0o, n1o, n0, n1, vector_width, vector_width)
+                .vectorize(n0)
+                .unroll(n1);
+            if (desc.parallel) {
+                xT.parallel(n1o);
+            }
+        }
     }
     if (x_tiled.defined()) {
         x_tiled.compute_at(dft1T, group);
@@ -1003,39 +1271,6 @@ Func fft2d_c2r(ComplexFunc c,
     return unzipped;
 }
 
-namespace {
-
-// Compute a factorization of N suitable for use in the FFT.
-vector<int> radix_factor(int N) {
-    // Some special cases to optimize.
-    switch (N) {
-    case 16: return { 4, 4 };
-    case 32: return { 8, 4 };
-    case 64: return { 8, 8 };
-    case 128: return { 8, 4, 4 };
-    case 256: return { 8, 8, 4 };
-    }
-
-    // Factor N into factors found in the 'radices' set.
-    static const int radices[] = { 8, 6, 4, 2 };
-    vector<int> R;
-    for (int r : radices) {
-        while (N % r == 0) {
-            R.push_back(r);
-            N /= r;
-        }
-    }
-
-    // If there are still factors left over, just include them as a radix.
-    if (N != 1 || R.empty()) {
-        R.push_back(N);
-    }
-
-    return R;
-}
-
-}  // namespace
-
 ComplexFunc fft2d_c2c(ComplexFunc x,
                       int N0, int N1,
                       int sign,
@@ -1048,12 +1283,74 @@ ComplexFunc fft2d_r2c(Func r,
                       int N0, int N1,
                       const Target& target,
                       const Fft2dDesc& desc) {
-    return fft2d_r2c(r, radix_factor(N0), radix_factor(N1), target, desc);
+    vector<int> R0 = radix_factor(N0);
+    vector<int> R1 = radix_factor(N1);
+    if (N0 % 2 == 0 && N1 % 2 == 0 && !needs_bluestein(R0) && !needs_bluestein(R1)) {
+        return fft2d_r2c(r, R0, R1, target, desc);
+    }
+
+    // The real FFT above needs even sizes with small radices. Otherwise,
+    // compute a complex FFT of the real data, and keep the non-redundant half.
+    string prefix = desc.name.empty() ? "r2c_" : desc.name + "_";
+
+    vector<Var> args = r.args();
+    Var outer = args.size() > 2 ? args[2] : Var::outermost();
+
+    ComplexFunc c(prefix + "complex");
+    c(args) = ComplexExpr(r(args), 0.0f);
+    ComplexFunc dft = fft2d_c2c(c, R0, R1, -1, target, desc);
+
+    ComplexFunc half(prefix + "half");
+    half(args) = dft(args);
+    half.bound(args[0], 0, N0);
+    half.bound(args[1], 0, N1 / 2 + 1);
+    dft.compute_at(half, outer);
+
+    return half;
 }
 
 Func fft2d_c2r(ComplexFunc c,
                int N0, int N1,
                const Target& target,
                const Fft2dDesc& desc) {
-    return fft2d_c2r(c, radix_factor(N0), radix_factor(N1), target, desc);
+    vector<int> R0 = radix_factor(N0);
+    vector<int> R1 = radix_factor(N1);
+    if (N0 % 2 == 0 && N1 % 2 == 0 && !needs_bluestein(R0) && !needs_bluestein(R1)) {
+        return fft2d_c2r(c, R0, R1, target, desc);
+    }
+
+    // As in fft2d_r2c, fall back to a complex FFT. Reconstruct the redundant
+    // half of the input via conjugate symmetry, and keep the real part of the
+    // result.
+    string prefix = desc.name.empty() ? "c2r_" : desc.name + "_";
+
+    vector<Var> args = c.args();
+    Var n0(args[0]), n1(args[1]);
+    args.erase(args.begin());
+    args.erase(args.begin());
+    Var outer = args.empty() ? Var::outermost() : args.front();
+
+    ComplexFunc full(prefix + "full"); {
+        ComplexExpr X = c(A({n0, min(n1, N1 / 2)}, args));
+        ComplexExpr X_sym = conj(c(A({(N0 - n0) % N0, clamp(N1 - n1, 0, N1 / 2)}, args)));
+        full(A({n0, n1}, args)) = select(n1 <= N1 / 2, X, X_sym);
+    }
+    ComplexFunc dft = fft2d_c2c(full, R0, R1, 1, target, desc);
+
+    Func real(prefix + "real");
+    real(A({n0, n1}, args)) = re(dft(A({n0, n1}, args)));
+    real.bound(n0, 0, N0);
+    real.bound(n1, 0, N1);
+    dft.compute_at(real, outer);
+
+    return real;
+}
+
+ComplexFunc fft1d_c2c(ComplexFunc x,
+                      int N,
+                      int sign,
+                      const Target& target,
+                      const Fft2dDesc& desc) {
+    string prefix = desc.name.empty() ? "c2c1d_" : desc.name + "_";
+    return fft1d(x, N, sign, desc.gain, desc.parallel, prefix, target);
 }
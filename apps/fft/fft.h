@@ -38,6 +38,12 @@ struct Fft2dDesc {
     std::string name = "";
 };
 
+// The transforms below accept any size. Sizes that factor into small radices
+// are computed directly with radix passes. Sizes with large prime factors use
+// Bluestein's algorithm, which costs about 3x more than a power of 2 FFT of
+// twice the size. The real transforms fall back to a complex transform for
+// such sizes, and for odd sizes.
+
 // Compute the N0 x N1 2D complex DFT of the first 2 dimensions of a complex
 // valued function x. The first 2 dimensions of x should be defined on at least
 // [0, N0) and [0, N1) for dimensions 0, 1, respectively. sign = -1 indicates a
@@ -66,4 +72,13 @@ Halide::Func fft2d_c2r(ComplexFunc c, int N0, int N1,
                        const Halide::Target& target,
                        const Fft2dDesc& desc = Fft2dDesc());
 
+// Compute the N point 1D complex DFT of the first dimension of a complex valued
+// function x, which should be defined on at least [0, N). Large transforms are
+// decomposed into two passes of DFTs of about sqrt(N) points (the four-step
+// algorithm), which keeps the working set of each pass small. If desc.parallel
+// is set, the passes are parallelized across their columns.
+ComplexFunc fft1d_c2c(ComplexFunc x, int N, int sign,
+                      const Halide::Target& target,
+                      const Fft2dDesc& desc = Fft2dDesc());
+
 #endif
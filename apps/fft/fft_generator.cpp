@@ -64,7 +64,7 @@ public:
 
     // Size of first dimension, required to be greater than zero.
     GeneratorParam<int32_t> size0{"size0", 1};
-    // Size of second dimension, may be zero for 1D FFT.
+    // Size of second dimension, may be zero for a 1D FFT of each row.
     GeneratorParam<int32_t> size1{"size1", 0};
     // TODO(zalman): Add support for 3D and maybe 4D FFTs
 
@@ -90,6 +90,7 @@ public:
 
         desc.gain = gain;
         desc.vector_width = vector_width;
+        desc.parallel = parallel;
 
         // The logic below calls the specialized r2c or c2r version if
         // applicable to take advantage of better scheduling. It is
@@ -98,7 +99,18 @@ public:
 
         const int sign = (direction == FFTDirection::SamplesToFrequency) ? -1 : 1;
 
-        if (input_number_type == FFTNumberType::Real) {
+        if (size1 == 0) {
+            // A 1D FFT of each row of the input. Unlike the 2D case, real
+            // inputs produce the full (conjugate symmetric) DFT.
+            ComplexFunc in;
+            if (input_number_type == FFTNumberType::Real) {
+                in(x, y) = ComplexExpr(input(x, y, 0), 0);
+            } else {
+                in(x, y) = ComplexExpr(input(x, y, 0), input(x, y, 1));
+            }
+
+            complex_result = fft1d_c2c(in, size0, sign, target, desc);
+        } else if (input_number_type == FFTNumberType::Real) {
             if (direction == FFTDirection::SamplesToFrequency) {
                 // TODO: Not sure why this is necessary as ImageParam
                 // -> Func conversion should happen, It may not work
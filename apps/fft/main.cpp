@@ -5,6 +5,8 @@
 
 #include "Halide.h"
 #include <cstdio>
+#include <cstdlib>
+#include <string>
 #include <vector>
 #include <cmath>  // for log2
 
@@ -34,6 +36,17 @@ ComplexFunc make_complex(const Buffer<T> &re) {
     return ret;
 }
 
+// Returns true if the FFT of size n is computed directly with small radices,
+// rather than with Bluestein's algorithm.
+bool has_small_radices(int n) {
+    for (int r : {2, 3, 5, 7, 11, 13}) {
+        while (n % r == 0) {
+            n /= r;
+        }
+    }
+    return n == 1;
+}
+
 int main(int argc, char **argv) {
     int W = 32;
     int H = 32;
@@ -45,6 +58,12 @@ int main(int argc, char **argv) {
     if (argc >= 4) {
         output_dir = argv[3];
     }
+    // If given, sweep the number of threads from 1 to max_threads for the
+    // parallel schedules.
+    int max_threads = 0;
+    if (argc >= 5) {
+        max_threads = atoi(argv[4]);
+    }
 
     // Generate a random image to convolve with.
     Buffer<float> in(W, H);
@@ -107,8 +126,41 @@ int main(int argc, char **argv) {
         filtered_r2c = fft2d_c2r(dft_filtered, W, H, target, inv_desc);
     }
 
+    // Convolve the input, viewed as one long 1D signal, with a 1D box filter.
+    const int N = W * H;
+    Func filtered_1d;
+    {
+        Func in_1d, kernel_1d;
+        in_1d(x) = in(x % W, x / W);
+        kernel_1d(x) = select(x <= box/2 || x >= N - box/2, 1.0f/box, 0.0f);
+
+        ComplexFunc c_in, c_kernel;
+        c_in(x) = ComplexExpr(in_1d(x), 0.0f);
+        c_kernel(x) = ComplexExpr(kernel_1d(x), 0.0f);
+
+        Fft2dDesc inv_desc_1d;
+        inv_desc_1d.gain = 1.0f/N;
+
+        ComplexFunc dft_in = fft1d_c2c(c_in, N, -1, target, fwd_desc);
+        ComplexFunc dft_kernel = fft1d_c2c(c_kernel, N, -1, target, fwd_desc);
+        dft_in.compute_root();
+        dft_kernel.compute_root();
+
+        ComplexFunc dft_filtered("dft_filtered_1d");
+        dft_filtered(x) = dft_in(x) * dft_kernel(x);
+
+        ComplexFunc dft_out = fft1d_c2c(dft_filtered, N, 1, target, inv_desc_1d);
+        dft_out.compute_root();
+
+        filtered_1d(x) = re(dft_out(x));
+    }
+
     Buffer<float> result_c2c = filtered_c2c.realize(W, H, target);
     Buffer<float> result_r2c = filtered_r2c.realize(W, H, target);
+    Buffer<float> result_1d = filtered_1d.realize(N, target);
+
+    // Bluestein's algorithm is a bit less accurate than the radix passes.
+    const float tolerance = has_small_radices(W) && has_small_radices(H) ? 1e-6f : 1e-4f;
 
     for (int y = 0; y < H; y++) {
         for (int x = 0; x < W; x++) {
@@ -119,24 +171,39 @@ int main(int argc, char **argv) {
                 }
             }
             correct /= box*box;
-            if (fabs(result_c2c(x, y) - correct) > 1e-6f) {
+            if (fabs(result_c2c(x, y) - correct) > tolerance) {
                 printf("result_c2c(%d, %d) = %f instead of %f\n", x, y, result_c2c(x, y), correct);
                 return -1;
             }
-            if (fabs(result_r2c(x, y) - correct) > 1e-6f) {
+            if (fabs(result_r2c(x, y) - correct) > tolerance) {
                 printf("result_r2c(%d, %d) = %f instead of %f\n", x, y, result_r2c(x, y), correct);
                 return -1;
             }
         }
     }
 
+    const float tolerance_1d = has_small_radices(N) ? 1e-5f : 1e-4f;
+    for (int i = 0; i < N; i++) {
+        float correct = 0;
+        for (int j = -box/2; j <= box/2; j++) {
+            int k = (i + j + N) % N;
+            correct += in(k % W, k / W);
+        }
+        correct /= box;
+        if (fabs(result_1d(i) - correct) > tolerance_1d) {
+            printf("result_1d(%d) = %f instead of %f\n", i, result_1d(i), correct);
+            return -1;
+        }
+    }
+
     // For a description of the methodology used here, see
     // http://www.fftw.org/speed/method.html
 
     // Take the minimum time over many of iterations to minimize
     // noise.
     const int samples = 100;
-    const int reps = 1000;
+    // Large FFTs need fewer reps, and would need too much memory otherwise.
+    const int reps = std::max(1, std::min(1000, (1 << 22) / (W * H)));
 
     Var rep("rep");
 
@@ -230,11 +297,77 @@ int main(int argc, char **argv) {
            2.5*W*H*(log2(W) + log2(H))/fftw_t,
            fftw_t / halide_t);
 
+    Buffer<float> re_in_1d = lambda(x, 0.0f).realize(N);
+    Buffer<float> im_in_1d = lambda(x, 0.0f).realize(N);
+
+    ComplexFunc c2c_1d_in;
+    // All reps read from the same input. See notes on c2c_in.
+    c2c_1d_in(x, rep) = {re_in_1d(x), im_in_1d(x)};
+    Func bench_c2c_1d = fft1d_c2c(c2c_1d_in, N, -1, target, fwd_desc);
+    bench_c2c_1d.compile_to_lowered_stmt(output_dir + "c2c_1d.html", bench_c2c_1d.infer_arguments(), HTML);
+    Realization R_c2c_1d = bench_c2c_1d.realize(N, reps, target);
+    // Write all reps to the same place in memory. See notes on R_c2c.
+    R_c2c_1d[0].raw_buffer()->dim[1].stride = 0;
+    R_c2c_1d[1].raw_buffer()->dim[1].stride = 0;
+
+    halide_t = benchmark(samples, 1, [&]() { bench_c2c_1d.realize(R_c2c_1d); })*1e6/reps;
+#ifdef WITH_FFTW
+    fftwf_plan c2c_1d_plan = fftwf_plan_dft_1d(N, (fftwf_complex*)&fftw_c1[0], (fftwf_complex*)&fftw_c2[0], FFTW_FORWARD, FFTW_EXHAUSTIVE);
+    fftw_t = benchmark(samples, reps, [&]() { fftwf_execute(c2c_1d_plan); })*1e6;
+#else
+    fftw_t = 0;
+#endif
+    printf("%12s %10.3f %10.2f %10.3f %10.2f %10.3g\n",
+           "c2c 1D",
+           halide_t,
+           5*N*log2(N)/halide_t,
+           fftw_t,
+           5*N*log2(N)/fftw_t,
+           fftw_t / halide_t);
+
 #ifdef WITH_FFTW
     fftwf_destroy_plan(c2c_plan);
     fftwf_destroy_plan(r2c_plan);
     fftwf_destroy_plan(c2r_plan);
+    fftwf_destroy_plan(c2c_1d_plan);
 #endif
 
+    if (max_threads > 0) {
+        // Benchmark single large FFTs, parallelized within the FFT, with an
+        // increasing number of threads.
+        Fft2dDesc parallel_desc = fwd_desc;
+        parallel_desc.parallel = true;
+
+        printf("\n%12s %10s %10s %10s %10s\n", "Threads", "c2c (us)", "Speedup", "1D (us)", "Speedup");
+        double c2c_t1 = 0, c2c_1d_t1 = 0;
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            setenv("HL_NUM_THREADS", std::to_string(threads).c_str(), 1);
+            Halide::Internal::JITSharedRuntime::release_all();
+
+            ComplexFunc parallel_in;
+            parallel_in(x, y) = {re_in(x, y), im_in(x, y)};
+            Func parallel_c2c = fft2d_c2c(parallel_in, W, H, -1, target, parallel_desc);
+            Realization R_parallel = parallel_c2c.realize(W, H, target);
+            double c2c_t = benchmark(samples, 1, [&]() { parallel_c2c.realize(R_parallel); })*1e6;
+
+            ComplexFunc parallel_1d_in;
+            parallel_1d_in(x) = {re_in_1d(x), im_in_1d(x)};
+            Func parallel_c2c_1d = fft1d_c2c(parallel_1d_in, N, -1, target, parallel_desc);
+            Realization R_parallel_1d = parallel_c2c_1d.realize(N, target);
+            double c2c_1d_t = benchmark(samples, 1, [&]() { parallel_c2c_1d.realize(R_parallel_1d); })*1e6;
+
+            if (threads == 1) {
+                c2c_t1 = c2c_t;
+                c2c_1d_t1 = c2c_1d_t;
+            }
+            printf("%12d %10.3f %10.3g %10.3f %10.3g\n",
+                   threads,
+                   c2c_t,
+                   c2c_t1 / c2c_t,
+                   c2c_1d_t,
+                   c2c_1d_t1 / c2c_1d_t);
+        }
+    }
+
     return 0;
 }
@@ -212,7 +212,7 @@ int main(int argc, char **argv) {
     input.set(in_png);
 
     std::cout << "Running... " << std::endl;
-    double best = benchmark(20, 1, [&]() { normalize.realize(out); });
+    double best = benchmark([&]() { normalize.realize(out); });
     std::cout << " took " << best * 1e3 << " msec." << std::endl;
 
     vector<Argument> args;
@@ -1,8 +1,13 @@
 // USAGE: halide_benchmarks <subroutine> <size>
+//        halide_benchmarks <subroutine> <size> <batch>
+//        halide_benchmarks <subroutine> <M> <N> <K>
 //
 // Benchmarks BLAS subroutines using Halide's implementation. Will
 // construct random size x size matrices and/or size x 1 vectors
-// to test the subroutine with.
+// to test the subroutine with. The second form benchmarks gemm_batched
+// on batch size x size matrices, as a loop of gemm calls. The third
+// form benchmarks gemm_notrans with an M x K matrix A and a K x N
+// matrix B.
 //
 // Accepted values for subroutine are:
 //    L1: scal, copy, axpy, dot, nrm2
@@ -57,13 +62,21 @@ struct BenchmarksBase {
     }
 
     Matrix random_matrix(int N) {
-        Matrix buff(N * N);
-        for (int i=0; i<N*N; ++i) {
+        return random_matrix(N, N);
+    }
+
+    Matrix random_matrix(int M, int N) {
+        Matrix buff(M * N);
+        for (int i=0; i<M*N; ++i) {
             buff[i] = random_scalar();
         }
         return buff;
     }
 
+    Matrix random_matrix_batch(int N, int batch) {
+        return random_matrix(N, N * batch);
+    }
+
     BenchmarksBase(std::string n) : name(n) {}
 
     void run(std::string benchmark, int size) {
@@ -94,6 +107,18 @@ struct BenchmarksBase {
         }
     }
 
+    void run(std::string benchmark, int N, int batch) {
+        if (benchmark == "gemm_batched") {
+            this->bench_gemm_batched(N, batch);
+        }
+    }
+
+    void run(std::string benchmark, int M, int N, int K) {
+        if (benchmark == "gemm_notrans") {
+            this->bench_gemm_notrans(M, N, K);
+        }
+    }
+
     virtual void bench_copy(int N) =0;
     virtual void bench_scal(int N) =0;
     virtual void bench_axpy(int N) =0;
@@ -106,6 +131,8 @@ struct BenchmarksBase {
     virtual void bench_gemm_transA(int N) =0;
     virtual void bench_gemm_transB(int N) =0;
     virtual void bench_gemm_transAB(int N) =0;
+    virtual void bench_gemm_notrans(int M, int N, int K) =0;
+    virtual void bench_gemm_batched(int N, int batch) =0;
 };
 
 struct BenchmarksFloat : public BenchmarksBase<float> {
@@ -147,6 +174,17 @@ struct BenchmarksFloat : public BenchmarksBase<float> {
     L3Benchmark(gemm_transAB, "s", cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N,
                                                alpha, &(A[0]), N, &(B[0]), N,
                                                beta, &(C[0]), N))
+
+    L3ShapeBenchmark(gemm_notrans, "s", cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, N, K,
+                                                    alpha, &(A[0]), M, &(B[0]), K,
+                                                    beta, &(C[0]), M))
+
+    L3BatchedBenchmark(gemm_batched, "s",
+                       for (int b = 0; b < batch; b++) {
+                           cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N,
+                                       alpha, &(A[b*N*N]), N, &(B[b*N*N]), N,
+                                       beta, &(C[b*N*N]), N);
+                       })
 };
 
 struct BenchmarksDouble : public BenchmarksBase<double> {
@@ -188,19 +226,51 @@ struct BenchmarksDouble : public BenchmarksBase<double> {
     L3Benchmark(gemm_transAB, "d", cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N,
                                                alpha, &(A[0]), N, &(B[0]), N,
                                                beta, &(C[0]), N))
+
+    L3ShapeBenchmark(gemm_notrans, "d", cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, M, N, K,
+                                                    alpha, &(A[0]), M, &(B[0]), K,
+                                                    beta, &(C[0]), M))
+
+    L3BatchedBenchmark(gemm_batched, "d",
+                       for (int b = 0; b < batch; b++) {
+                           cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N,
+                                       alpha, &(A[b*N*N]), N, &(B[b*N*N]), N,
+                                       beta, &(C[b*N*N]), N);
+                       })
 };
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cout << "USAGE: cblas_benchmarks <subroutine> <size>\n";
+    if (argc < 3 || argc > 5) {
+        std::cout << "USAGE: cblas_benchmarks <subroutine> <size>\n"
+                  << "       cblas_benchmarks <subroutine> <size> <batch>\n"
+                  << "       cblas_benchmarks <subroutine> <M> <N> <K>\n";
         return 0;
     }
 
     std::string subroutine = argv[1];
     char type = subroutine[0];
-    int  size = std::stoi(argv[2]);
 
     subroutine = subroutine.substr(1);
+    if (argc == 4) {
+        int N = std::stoi(argv[2]), batch = std::stoi(argv[3]);
+        if (type == 's') {
+            BenchmarksFloat (BLAS_NAME).run(subroutine, N, batch);
+        } else if (type == 'd') {
+            BenchmarksDouble(BLAS_NAME).run(subroutine, N, batch);
+        }
+        return 0;
+    }
+    if (argc == 5) {
+        int M = std::stoi(argv[2]), N = std::stoi(argv[3]), K = std::stoi(argv[4]);
+        if (type == 's') {
+            BenchmarksFloat (BLAS_NAME).run(subroutine, M, N, K);
+        } else if (type == 'd') {
+            BenchmarksDouble(BLAS_NAME).run(subroutine, M, N, K);
+        }
+        return 0;
+    }
+
+    int  size = std::stoi(argv[2]);
     if (type == 's') {
         BenchmarksFloat (BLAS_NAME).run(subroutine, size);
     } else if (type == 'd') {
@@ -1,8 +1,10 @@
 // USAGE: eigen_benchmarks <subroutine> <size>
+//        eigen_benchmarks <subroutine> <M> <N> <K>
 //
 // Benchmarks BLAS subroutines using Eigen's implementation. Will
 // construct random size x size matrices and/or size x 1 vectors
-// to test the subroutine with.
+// to test the subroutine with. The second form benchmarks gemm_notrans
+// with an M x K matrix A and a K x N matrix B.
 //
 // Accepted values for subroutine are:
 //    L1: scal, copy, axpy, dot, nrm2
@@ -45,7 +47,11 @@ struct Benchmarks {
     }
 
     Matrix random_matrix(int N) {
-        Matrix A(N, N);
+        return random_matrix(N, N);
+    }
+
+    Matrix random_matrix(int M, int N) {
+        Matrix A(M, N);
         A.setRandom();
         return A;
     }
@@ -80,6 +86,12 @@ struct Benchmarks {
         }
     }
 
+    void run(std::string benchmark, int M, int N, int K) {
+        if (benchmark == "gemm_notrans") {
+            bench_gemm_notrans(M, N, K);
+        }
+    }
+
     Scalar result;
 
     L1Benchmark(copy, type_name<T>(), y = x);
@@ -97,21 +109,34 @@ struct Benchmarks {
     L3Benchmark(gemm_transB, type_name<T>(), C = alpha * A * B.transpose() + beta * C);
     L3Benchmark(gemm_transAB, type_name<T>(), C = alpha * A.transpose() * B.transpose() + beta * C);
 
+    L3ShapeBenchmark(gemm_notrans, type_name<T>(), C = alpha * A * B + beta * C);
+
   private:
     std::string name;
 };
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cout << "USAGE: eigen_benchmarks <subroutine> <size>\n";
+    if (argc != 3 && argc != 5) {
+        std::cout << "USAGE: eigen_benchmarks <subroutine> <size>\n"
+                  << "       eigen_benchmarks <subroutine> <M> <N> <K>\n";
         return 0;
     }
 
     std::string subroutine = argv[1];
     char type = subroutine[0];
-    int  size = std::stoi(argv[2]);
 
     subroutine = subroutine.substr(1);
+    if (argc == 5) {
+        int M = std::stoi(argv[2]), N = std::stoi(argv[3]), K = std::stoi(argv[4]);
+        if (type == 's') {
+            Benchmarks<float> ("Eigen").run(subroutine, M, N, K);
+        } else if (type == 'd') {
+            Benchmarks<double>("Eigen").run(subroutine, M, N, K);
+        }
+        return 0;
+    }
+
+    int  size = std::stoi(argv[2]);
     if (type == 's') {
         Benchmarks<float> ("Eigen").run(subroutine, size);
     } else if (type == 'd') {
@@ -1,8 +1,12 @@
 // USAGE: halide_benchmarks <subroutine> <size>
+//        halide_benchmarks <subroutine> <size> <batch>
+//        halide_benchmarks <subroutine> <M> <N> <K>
 //
 // Benchmarks BLAS subroutines using Halide's implementation. Will
 // construct random size x size matrices and/or size x 1 vectors
-// to test the subroutine with.
+// to test the subroutine with. The second form benchmarks gemm_batched
+// on batch size x size matrices. The third form benchmarks
+// gemm_notrans with an M x K matrix A and a K x N matrix B.
 //
 // Accepted values for subroutine are:
 //    L1: scal, copy, axpy, dot, nrm2
@@ -46,9 +50,22 @@ struct BenchmarksBase {
     }
 
     Matrix random_matrix(int N) {
-        Matrix buff(N, N);
+        return random_matrix(N, N);
+    }
+
+    Matrix random_matrix(int M, int N) {
+        Matrix buff(M, N);
+        Scalar *A = (Scalar*)buff.data();
+        for (int i=0; i<M*N; ++i) {
+            A[i] = random_scalar();
+        }
+        return buff;
+    }
+
+    Matrix random_matrix_batch(int N, int batch) {
+        Matrix buff(N, N, batch);
         Scalar *A = (Scalar*)buff.data();
-        for (int i=0; i<N*N; ++i) {
+        for (int i=0; i<N*N*batch; ++i) {
             A[i] = random_scalar();
         }
         return buff;
@@ -84,6 +101,18 @@ struct BenchmarksBase {
         }
     }
 
+    void run(std::string benchmark, int N, int batch) {
+        if (benchmark == "gemm_batched") {
+            bench_gemm_batched(N, batch);
+        }
+    }
+
+    void run(std::string benchmark, int M, int N, int K) {
+        if (benchmark == "gemm_notrans") {
+            bench_gemm_notrans(M, N, K);
+        }
+    }
+
     virtual void bench_copy(int N) =0;
     virtual void bench_scal(int N) =0;
     virtual void bench_axpy(int N) =0;
@@ -96,6 +125,8 @@ struct BenchmarksBase {
     virtual void bench_gemm_transA(int N) =0;
     virtual void bench_gemm_transB(int N) =0;
     virtual void bench_gemm_transAB(int N) =0;
+    virtual void bench_gemm_notrans(int M, int N, int K) =0;
+    virtual void bench_gemm_batched(int N, int batch) =0;
 };
 
 struct BenchmarksFloat : public BenchmarksBase<float> {
@@ -131,6 +162,12 @@ struct BenchmarksFloat : public BenchmarksBase<float> {
 
     L3Benchmark(gemm_transAB, "s", halide_sgemm(true, true, alpha, A.raw_buffer(),
                                                 B.raw_buffer(), beta, C.raw_buffer()))
+
+    L3ShapeBenchmark(gemm_notrans, "s", halide_sgemm(false, false, alpha, A.raw_buffer(),
+                                                     B.raw_buffer(), beta, C.raw_buffer()))
+
+    L3BatchedBenchmark(gemm_batched, "s", halide_sgemm_batched(false, false, alpha, A.raw_buffer(),
+                                                               B.raw_buffer(), beta, C.raw_buffer()))
 };
 
 struct BenchmarksDouble : public BenchmarksBase<double> {
@@ -166,19 +203,46 @@ struct BenchmarksDouble : public BenchmarksBase<double> {
 
     L3Benchmark(gemm_transAB, "d", halide_dgemm(true, true, alpha, A.raw_buffer(),
                                                 B.raw_buffer(), beta, C.raw_buffer()))
+
+    L3ShapeBenchmark(gemm_notrans, "d", halide_dgemm(false, false, alpha, A.raw_buffer(),
+                                                     B.raw_buffer(), beta, C.raw_buffer()))
+
+    L3BatchedBenchmark(gemm_batched, "d", halide_dgemm_batched(false, false, alpha, A.raw_buffer(),
+                                                               B.raw_buffer(), beta, C.raw_buffer()))
 };
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cout << "USAGE: halide_benchmarks <subroutine> <size>\n";
+    if (argc < 3 || argc > 5) {
+        std::cout << "USAGE: halide_benchmarks <subroutine> <size>\n"
+                  << "       halide_benchmarks <subroutine> <size> <batch>\n"
+                  << "       halide_benchmarks <subroutine> <M> <N> <K>\n";
         return 0;
     }
 
     std::string subroutine = argv[1];
     char type = subroutine[0];
-    int  size = std::stoi(argv[2]);
 
     subroutine = subroutine.substr(1);
+    if (argc == 4) {
+        int N = std::stoi(argv[2]), batch = std::stoi(argv[3]);
+        if (type == 's') {
+            BenchmarksFloat ("Halide").run(subroutine, N, batch);
+        } else if (type == 'd') {
+            BenchmarksDouble("Halide").run(subroutine, N, batch);
+        }
+        return 0;
+    }
+    if (argc == 5) {
+        int M = std::stoi(argv[2]), N = std::stoi(argv[3]), K = std::stoi(argv[4]);
+        if (type == 's') {
+            BenchmarksFloat ("Halide").run(subroutine, M, N, K);
+        } else if (type == 'd') {
+            BenchmarksDouble("Halide").run(subroutine, M, N, K);
+        }
+        return 0;
+    }
+
+    int  size = std::stoi(argv[2]);
     if (type == 's') {
         BenchmarksFloat ("Halide").run(subroutine, size);
     } else if (type == 'd') {
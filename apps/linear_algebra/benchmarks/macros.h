@@ -68,3 +68,44 @@
                   << std::setw(20) << L3GFLOPS(N)                       \
                   << std::endl;                                         \
     }
+
+#define L3ShapeGFLOPS(M, N, K) (3.0 + K) * M * N * 1e-3 / elapsed
+#define L3ShapeBenchmark(benchmark, type, code)                         \
+    virtual void bench_##benchmark(int M, int N, int K) {               \
+        Scalar alpha = random_scalar();                                 \
+        Scalar beta = random_scalar();                                  \
+        Matrix A(random_matrix(M, K));                                  \
+        Matrix B(random_matrix(K, N));                                  \
+        Matrix C(random_matrix(M, N));                                  \
+                                                                        \
+        time_it(code)                                                   \
+                                                                        \
+        std::cout << std::setw(8) << name                               \
+                  << std::setw(15) << type << #benchmark                \
+                  << std::setw(16) << (std::to_string(M) + "x" +        \
+                                       std::to_string(N) + "x" +        \
+                                       std::to_string(K))               \
+                  << std::setw(20) << std::to_string(elapsed)           \
+                  << std::setw(20) << L3ShapeGFLOPS(M, N, K)            \
+                  << std::endl;                                         \
+    }
+
+#define L3BatchedGFLOPS(N, batch) (3.0 + N) * N * N * batch * 1e-3 / elapsed
+#define L3BatchedBenchmark(benchmark, type, code)                       \
+    virtual void bench_##benchmark(int N, int batch) {                  \
+        Scalar alpha = random_scalar();                                 \
+        Scalar beta = random_scalar();                                  \
+        Matrix A(random_matrix_batch(N, batch));                        \
+        Matrix B(random_matrix_batch(N, batch));                        \
+        Matrix C(random_matrix_batch(N, batch));                        \
+                                                                        \
+        time_it(code)                                                   \
+                                                                        \
+        std::cout << std::setw(8) << name                               \
+                  << std::setw(15) << type << #benchmark                \
+                  << std::setw(16) << (std::to_string(N) + "x" +        \
+                                       std::to_string(batch))           \
+                  << std::setw(20) << std::to_string(elapsed)           \
+                  << std::setw(20) << L3BatchedGFLOPS(N, batch)         \
+                  << std::endl;                                         \
+    }
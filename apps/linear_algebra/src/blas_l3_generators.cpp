@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 #include "Halide.h"
 
@@ -18,6 +19,13 @@ class GEMMGenerator :
     GeneratorParam<bool> transpose_A_ = {"transpose_A", false};
     GeneratorParam<bool> transpose_B_ = {"transpose_B", false};
 
+    // The data cache sizes of the target, in bytes, used to pick the
+    // sizes of the packed panels. The defaults are typical of recent
+    // x86 and ARM cores.
+    GeneratorParam<int> l1_cache_size_ = {"l1_cache_size", 32 * 1024};
+    GeneratorParam<int> l2_cache_size_ = {"l2_cache_size", 256 * 1024};
+    GeneratorParam<int> l3_cache_size_ = {"l3_cache_size", 2 * 1024 * 1024};
+
     // Standard ordering of parameters in GEMM functions.
     Param<T>   a_ = {"a", 1.0};
     ImageParam A_ = {type_of<T>(), 2, "A"};
@@ -29,132 +37,225 @@ class GEMMGenerator :
         // Matrices are interpreted as column-major by default. The
         // transpose GeneratorParams are used to handle cases where
         // one or both is actually row major.
-        const Expr num_rows = A_.width();
-        const Expr num_cols = B_.height();
-        const Expr sum_size = A_.height();
-
+        const Expr num_rows = C_.width();
+        const Expr num_cols = C_.height();
+        const Expr sum_size = (bool)transpose_A_ ? A_.width() : A_.height();
+
+        // This follows the structure of Goto's algorithm. The
+        // micro-kernel keeps an mr x nr tile of the result in
+        // registers, as nr pairs of vectors, and needs a few more
+        // registers for the operands.
+        const Target t = get_target();
+        const bool many_registers =
+            t.has_feature(Target::AVX512) ||
+            t.has_feature(Target::AVX512_KNL) ||
+            t.has_feature(Target::AVX512_Skylake) ||
+            t.has_feature(Target::AVX512_Cannonlake) ||
+            (t.arch == Target::ARM && t.bits == 64);
+        const int num_registers = many_registers ? 32 : 16;
         const int vec = natural_vector_size(a_.type());
-        const int s = vec * 2;
-
-        ImageParam A_in, B_in;
-
-        // If they're both transposed, then reverse the order and transpose the result instead.
-        bool transpose_AB = false;
-        if ((bool)transpose_A_ && (bool)transpose_B_) {
-            A_in = B_;
-            B_in = A_;
-            transpose_A_.set(false);
-            transpose_B_.set(false);
-            transpose_AB = true;
-        } else {
-            A_in = A_;
-            B_in = B_;
-        }
+        const int mr = 2 * vec;
+        const int nr = std::min(8, (num_registers - 4) / 2);
+
+        // A kc x nr micro-panel of B and an mr x kc micro-panel of A
+        // share half of L1, an mc x kc block of A takes half of L2,
+        // and a kc x nc block of B takes half of L3.
+        const int elem_size = sizeof(T);
+        const int l1 = l1_cache_size_, l2 = l2_cache_size_, l3 = l3_cache_size_;
+        const int kc = std::max(vec, (l1 / 2) / ((mr + nr) * elem_size) / vec * vec);
+        const int mc = std::max(mr, (l2 / 2) / (kc * elem_size) / mr * mr);
+        const int nc = std::max(nr, (l3 / 2) / (kc * elem_size) / nr * nr);
+
+        Var i("i"), j("j"), k("k"), x("x"), panel("panel");
+        Var io("io"), jo("jo"), ir("ir"), jr("jr"), ko("ko"), ki("ki");
+
+        // Zero-pad the inputs, so that the packed panels can always
+        // be full-sized.
+        Func A_ext = BoundaryConditions::constant_exterior(A_, cast<T>(0));
+        Func B_ext = BoundaryConditions::constant_exterior(B_, cast<T>(0));
+
+        // Pack A into micro-panels of mr rows, stored so that the
+        // micro-kernel reads them contiguously. The scale factor is
+        // folded in here.
+        Func A_packed("A_packed");
+        Expr a_row = panel * mr + x;
+        A_packed(x, k, panel) = a_ * ((bool)transpose_A_ ? A_ext(k, a_row) : A_ext(a_row, k));
+
+        // Pack B into micro-panels of nr columns, likewise.
+        Func B_packed("B_packed");
+        Expr b_col = panel * nr + x;
+        B_packed(x, k, panel) = (bool)transpose_B_ ? B_ext(b_col, k) : B_ext(k, b_col);
+
+        // The micro-kernel computes the product of a micro-panel of A
+        // and a micro-panel of B over one block of the sum.
+        Func AB("AB");
+        RDom p(0, kc);
+        Expr kk = ko * kc + p;
+        AB(i, j, ko) = cast<T>(0);
+        AB(i, j, ko) += A_packed(i % mr, kk, i / mr) * B_packed(j % nr, kk, j / nr);
 
-        Var i, j, ii, ji, jii, iii, io, jo, t;
-        Var ti[3], tj[3];
+        // Do the part that makes it a 'general' matrix multiply, and
+        // accumulate the blocks of the sum into it.
         Func result("result");
+        RDom rk(0, (sum_size + kc - 1) / kc);
+        result(i, j) = b_ * C_(i, j);
+        result(i, j) += AB(i, j, rk);
+
+        result
+            .vectorize(i, vec, TailStrategy::GuardWithIf)
+            .parallel(j);
+
+        // Loop over nc-wide blocks of B, then kc-deep blocks of the
+        // sum, then mc-tall blocks of A, then the micro-tiles. Each
+        // task packs its own block of A, and the threads share the
+        // packed block of B.
+        result.update()
+            .tile(i, j, io, jo, i, j, mc, nc, TailStrategy::GuardWithIf)
+            .tile(i, j, ir, jr, i, j, mr, nr, TailStrategy::GuardWithIf)
+            .reorder(i, j, ir, jr, io, rk, jo)
+            .parallel(io);
+
+        result.bound(i, 0, num_rows).bound(j, 0, num_cols);
 
-        // Swizzle A for better memory order in the inner loop.
-        Func A("A"), B("B"), Btmp("Btmp"), As("As"), Atmp("Atmp");
-        Atmp(i, j) = BoundaryConditions::constant_exterior(A_in, cast<T>(0))(i, j);
+        AB.compute_at(result, ir)
+            .bound_extent(i, mr).vectorize(i)
+            .bound_extent(j, nr).unroll(j)
+            .update()
+            .reorder(i, j, p).vectorize(i).unroll(j).unroll(p, 2);
 
+        A_packed.compute_at(result, io)
+            .bound(x, 0, mr);
         if (transpose_A_) {
-            As(i, j, io) = Atmp(j, io*s + i);
+            // Read down the columns of the transposed matrix, and let
+            // the unrolled strided stores be combined into dense ones.
+            A_packed.split(k, ko, ki, vec).reorder(ki, x, ko, panel)
+                .vectorize(ki).unroll(x);
         } else {
-            As(i, j, io) = Atmp(io*s + i, j);
+            A_packed.vectorize(x);
         }
 
-        A(i, j) = As(i % s, j, i / s);
-
-        Btmp(i, j) = B_in(i, j);
+        B_packed.compute_at(result, rk)
+            .bound(x, 0, nr)
+            .parallel(panel);
         if (transpose_B_) {
-            B(i, j) = Btmp(j, i);
+            B_packed.vectorize(x);
         } else {
-            B(i, j) = Btmp(i, j);
+            B_packed.split(k, ko, ki, vec).reorder(ki, x, ko, panel)
+                .vectorize(ki).unroll(x);
         }
 
-        Var k("k");
-        Func prod;
-        // Express all the products we need to do a matrix multiply as a 3D Func.
-        prod(k, i, j) = A(i, k) * B(k, j);
-
-        // Reduce the products along k.
-        Func AB("AB");
-        RDom rv(0, sum_size);
-        AB(i, j) += prod(rv, i, j);
-
-        Func ABt("ABt");
-        if (transpose_AB) {
-            // Transpose A*B if necessary.
-            ABt(i, j) = AB(j, i);
+        // The inputs are read through boundary conditions, so bounds
+        // inference won't catch a mismatch in their shapes. Require
+        // them to agree with C and with each other explicitly.
+        if (transpose_A_) {
+            A_.set_min(0, 0).set_bounds(1, 0, num_rows);
         } else {
-            ABt(i, j) = AB(i, j);
+            A_.set_bounds(0, 0, num_rows).set_min(1, 0);
         }
-
-        // Do the part that makes it a 'general' matrix multiply.
-        result(i, j) = (a_ * ABt(i, j) + b_ * C_(i, j));
-
-        result.tile(i, j, ti[1], tj[1], i, j, 2*s, 2*s, TailStrategy::GuardWithIf);
-        if (transpose_AB) {
-            result
-                .tile(i, j, ii, ji, 4, s)
-                .tile(i, j, ti[0], tj[0], i, j, s/4, 1);
-
+        if (transpose_B_) {
+            B_.set_bounds(0, 0, num_cols).set_bounds(1, 0, sum_size);
         } else {
-            result
-                .tile(i, j, ii, ji, s, 4)
-                .tile(i, j, ti[0], tj[0], i, j, 1, s/4);
+            B_.set_bounds(0, 0, sum_size).set_bounds(1, 0, num_cols);
         }
+        C_.set_min(0, 0).set_min(1, 0);
+        result.output_buffer().set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
 
-        // If we have enough work per task, parallelize over these tiles.
-        result.specialize(num_rows >= 512 && num_cols >= 512)
-            .fuse(tj[1], ti[1], t).parallel(t);
+        return result;
+    }
+};
 
-        // Otherwise tile one more time before parallelizing, or don't
-        // parallelize at all.
-        result.specialize(num_rows >= 128 && num_cols >= 128)
-            .tile(ti[1], tj[1], ti[2], tj[2], ti[1], tj[1], 2, 2)
-            .fuse(tj[2], ti[2], t).parallel(t);
+// Generator class for batched gemm operations, which do many
+// independent matrix multiplies of the same size in one call. Each
+// input is a stack of matrices, with the batch index as the third
+// dimension.
+template<class T>
+class BatchedGEMMGenerator :
+        public Generator<BatchedGEMMGenerator<T>> {
+  public:
+    typedef Generator<BatchedGEMMGenerator<T>> Base;
+    using Base::target;
+    using Base::get_target;
+    using Base::natural_vector_size;
 
-        result.rename(tj[0], t);
+    GeneratorParam<bool> transpose_A_ = {"transpose_A", false};
+    GeneratorParam<bool> transpose_B_ = {"transpose_B", false};
 
-        result.bound(i, 0, num_rows).bound(j, 0, num_cols);
+    // Matrices with both dimensions at most this size are treated as
+    // small, and skip the tiling.
+    GeneratorParam<int> small_size_ = {"small_size", 16};
+
+    // Standard ordering of parameters in GEMM functions.
+    Param<T>   a_ = {"a", 1.0};
+    ImageParam A_ = {type_of<T>(), 3, "A"};
+    ImageParam B_ = {type_of<T>(), 3, "B"};
+    Param<T>   b_ = {"b", 1.0};
+    ImageParam C_ = {type_of<T>(), 3, "C"};
+
+    Func build() {
+        const Expr num_rows = C_.width();
+        const Expr num_cols = C_.height();
+        const Expr batch_size = C_.channels();
+        const Expr sum_size = (bool)transpose_A_ ? A_.width() : A_.height();
 
-        As.compute_root()
-            .split(j, jo, ji, s).reorder(i, ji, io, jo)
-            .unroll(i).vectorize(ji)
-            .specialize(A_.width() >= 256 && A_.height() >= 256).parallel(jo, 4);
+        const int vec = natural_vector_size(a_.type());
+        const int mr = 2 * vec;
+        const int nr = 4;
 
-        Atmp.compute_at(As, io)
-            .vectorize(i).unroll(j);
+        Var i("i"), j("j"), n("n"), io("io"), jo("jo"), ji("ji"), nb("nb"), t("t");
 
+        Func A("A"), B("B");
+        RDom k(0, sum_size);
+        if (transpose_A_) {
+            A(i, j, n) = A_(j, i, n);
+        } else {
+            A(i, j, n) = A_(i, j, n);
+        }
         if (transpose_B_) {
-            B.compute_at(result, t)
-                .tile(i, j, ii, ji, 8, 8)
-                .vectorize(ii).unroll(ji);
-            Btmp.reorder_storage(j, i)
-                .compute_at(B, i)
-                .vectorize(i)
-                .unroll(j);
+            B(i, j, n) = B_(j, i, n);
+        } else {
+            B(i, j, n) = B_(i, j, n);
         }
 
+        Func AB("AB");
+        AB(i, j, n) += A(i, k, n) * B(k, j, n);
 
-        AB.compute_at(result, i)
-            .bound_extent(j, 4).unroll(j)
-            .bound_extent(i, s).vectorize(i)
+        Func result("result");
+        result(i, j, n) = a_ * AB(i, j, n) + b_ * C_(i, j, n);
+
+        // Small matrices are done whole, a few per task. The batch
+        // loop is named io here, so that AB can be computed per
+        // matrix in this path and per tile in the other.
+        const int small_size = small_size_;
+        result.specialize(num_rows <= small_size && num_cols <= small_size)
+            .split(n, nb, io, 8, TailStrategy::GuardWithIf)
+            .vectorize(i, vec, TailStrategy::GuardWithIf)
+            .parallel(nb);
+
+        // Otherwise tile each matrix into micro-tiles, and parallelize
+        // over columns of tiles across the whole batch.
+        result
+            .tile(i, j, io, jo, i, j, mr, nr, TailStrategy::GuardWithIf)
+            .reorder(i, j, io, jo, n)
+            .fuse(jo, n, t).parallel(t)
+            .vectorize(i, vec, TailStrategy::GuardWithIf);
+
+        result.bound(i, 0, num_rows).bound(j, 0, num_cols).bound(n, 0, batch_size);
+
+        AB.compute_at(result, io)
+            .vectorize(i, vec, TailStrategy::GuardWithIf)
             .update()
-            .reorder(i, j, rv).unroll(j).unroll(rv, 2).vectorize(i);
-        if (transpose_AB) {
-            ABt.compute_at(result, i)
-                .bound_extent(i, 4).unroll(i)
-                .bound_extent(j, s).vectorize(j);
-        }
-
-        A_.set_min(0, 0).set_min(1, 0);
-        B_.set_bounds(0, 0, sum_size).set_min(1, 0);
-        C_.set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
-        result.output_buffer().set_bounds(0, 0, num_rows).set_bounds(1, 0, num_cols);
+            .reorder(i, j, k)
+            .split(j, jo, ji, nr, TailStrategy::GuardWithIf)
+            .vectorize(i, vec, TailStrategy::GuardWithIf)
+            .unroll(ji);
+
+        A_.set_min(0, 0).set_min(1, 0).set_min(2, 0);
+        B_.set_min(0, 0).set_min(1, 0).set_min(2, 0);
+        C_.set_min(0, 0).set_min(1, 0).set_min(2, 0);
+        result.output_buffer()
+            .set_bounds(0, 0, num_rows)
+            .set_bounds(1, 0, num_cols)
+            .set_bounds(2, 0, batch_size);
 
         return result;
     }
@@ -162,5 +263,7 @@ class GEMMGenerator :
 
 RegisterGenerator<GEMMGenerator<float>>    register_sgemm("sgemm");
 RegisterGenerator<GEMMGenerator<double>>   register_dgemm("dgemm");
+RegisterGenerator<BatchedGEMMGenerator<float>>    register_sgemm_batched("sgemm_batched");
+RegisterGenerator<BatchedGEMMGenerator<double>>   register_dgemm_batched("dgemm_batched");
 
 }  // namespace
@@ -1,3 +1,5 @@
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <iostream>
 #include "halide_blas.h"
@@ -29,6 +31,45 @@ Buffer<T> init_matrix_buffer(const int M, const int N, T *A, const int lda) {
     return Buffer<T>(A, 2, shape);
 }
 
+template<typename T>
+Buffer<T> init_batched_matrix_buffer(const int M, const int N, const int batch_count,
+                                     T *A, const int lda, const int stride) {
+    halide_dimension_t shape[] = {{0, M, 1}, {0, N, lda}, {0, batch_count, stride}};
+    return Buffer<T>(A, 3, shape);
+}
+
+// Check whether an array of pointers is evenly spaced, and if so, get
+// the spacing in elements.
+template<typename T>
+bool get_batch_stride(T *const ptrs[], const int batch_count, int *stride) {
+    *stride = 0;
+    if (batch_count > 1) {
+        ptrdiff_t d = ptrs[1] - ptrs[0];
+        if ((int)d != d) {
+            return false;
+        }
+        *stride = (int)d;
+    }
+    for (int i = 2; i < batch_count; i++) {
+        if (ptrs[i] - ptrs[0] != (ptrdiff_t)i * (*stride)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check whether evenly spaced M x N output matrices are far enough
+// apart not to overlap, so that they can safely be written in parallel.
+bool batch_outputs_disjoint(const int M, const int N, const int ldc,
+                            const int stride, const int batch_count) {
+    if (batch_count <= 1) {
+        return true;
+    }
+    const int64_t footprint = (int64_t)ldc * (N - 1) + M;
+    const int64_t distance = stride < 0 ? -(int64_t)stride : stride;
+    return distance >= footprint;
+}
+
 }
 
 #ifdef __cplusplus
@@ -279,6 +320,93 @@ void hblas_dgemm(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA
     assert_no_error(halide_dgemm(tA, tB, alpha, buff_A, buff_B, beta, buff_C));
 }
 
+void hblas_sgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const float alpha, const float *A,
+                                 const int lda, const int strideA, const float *B, const int ldb,
+                                 const int strideB, const float beta, float *C, const int ldc,
+                                 const int strideC, const int batch_count) {
+    bool tA = TransA != HblasNoTrans;
+    bool tB = TransB != HblasNoTrans;
+
+    auto buff_A = init_batched_matrix_buffer(tA ? K : M, tA ? M : K, batch_count, A, lda, strideA);
+    auto buff_B = init_batched_matrix_buffer(tB ? N : K, tB ? K : N, batch_count, B, ldb, strideB);
+    auto buff_C = init_batched_matrix_buffer(M, N, batch_count, C, ldc, strideC);
+
+    assert_no_error(halide_sgemm_batched(tA, tB, alpha, buff_A, buff_B, beta, buff_C));
+}
+
+void hblas_sgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const float alpha, const float *const A[],
+                         const int lda, const float *const B[], const int ldb,
+                         const float beta, float *const C[], const int ldc,
+                         const int batch_count) {
+    if (batch_count <= 0) {
+        return;
+    }
+
+    // Evenly spaced matrices can be done in one call, as long as the
+    // outputs don't overlap. Otherwise do them one at a time, in order.
+    int strideA, strideB, strideC;
+    if (get_batch_stride(A, batch_count, &strideA) &&
+        get_batch_stride(B, batch_count, &strideB) &&
+        get_batch_stride(C, batch_count, &strideC) &&
+        batch_outputs_disjoint(M, N, ldc, strideC, batch_count)) {
+        hblas_sgemm_strided_batched(Order, TransA, TransB, M, N, K, alpha,
+                                    A[0], lda, strideA, B[0], ldb, strideB,
+                                    beta, C[0], ldc, strideC, batch_count);
+        return;
+    }
+
+    for (int i = 0; i < batch_count; i++) {
+        hblas_sgemm(Order, TransA, TransB, M, N, K, alpha, A[i], lda, B[i], ldb, beta, C[i], ldc);
+    }
+}
+
+void hblas_dgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const double alpha, const double *A,
+                                 const int lda, const int strideA, const double *B, const int ldb,
+                                 const int strideB, const double beta, double *C, const int ldc,
+                                 const int strideC, const int batch_count) {
+    bool tA = TransA != HblasNoTrans;
+    bool tB = TransB != HblasNoTrans;
+
+    auto buff_A = init_batched_matrix_buffer(tA ? K : M, tA ? M : K, batch_count, A, lda, strideA);
+    auto buff_B = init_batched_matrix_buffer(tB ? N : K, tB ? K : N, batch_count, B, ldb, strideB);
+    auto buff_C = init_batched_matrix_buffer(M, N, batch_count, C, ldc, strideC);
+
+    assert_no_error(halide_dgemm_batched(tA, tB, alpha, buff_A, buff_B, beta, buff_C));
+}
+
+void hblas_dgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const double alpha, const double *const A[],
+                         const int lda, const double *const B[], const int ldb,
+                         const double beta, double *const C[], const int ldc,
+                         const int batch_count) {
+    if (batch_count <= 0) {
+        return;
+    }
+
+    // Evenly spaced matrices can be done in one call, as long as the
+    // outputs don't overlap. Otherwise do them one at a time, in order.
+    int strideA, strideB, strideC;
+    if (get_batch_stride(A, batch_count, &strideA) &&
+        get_batch_stride(B, batch_count, &strideB) &&
+        get_batch_stride(C, batch_count, &strideC) &&
+        batch_outputs_disjoint(M, N, ldc, strideC, batch_count)) {
+        hblas_dgemm_strided_batched(Order, TransA, TransB, M, N, K, alpha,
+                                    A[0], lda, strideA, B[0], ldb, strideB,
+                                    beta, C[0], ldc, strideC, batch_count);
+        return;
+    }
+
+    for (int i = 0; i < batch_count; i++) {
+        hblas_dgemm(Order, TransA, TransB, M, N, K, alpha, A[i], lda, B[i], ldb, beta, C[i], ldc);
+    }
+}
 
 #ifdef __cplusplus
 }
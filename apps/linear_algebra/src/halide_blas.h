@@ -28,6 +28,14 @@
 #include "halide_dgemm_transB.h"
 #include "halide_sgemm_transAB.h"
 #include "halide_dgemm_transAB.h"
+#include "halide_sgemm_batched_notrans.h"
+#include "halide_dgemm_batched_notrans.h"
+#include "halide_sgemm_batched_transA.h"
+#include "halide_dgemm_batched_transA.h"
+#include "halide_sgemm_batched_transB.h"
+#include "halide_dgemm_batched_transB.h"
+#include "halide_sgemm_batched_transAB.h"
+#include "halide_dgemm_batched_transAB.h"
 
 inline int halide_scopy(halide_buffer_t *x, halide_buffer_t *y) {
     return halide_scopy_impl(0, x, nullptr, y);
@@ -90,6 +98,19 @@ inline int halide_sgemm(bool transA, bool transB, float a, halide_buffer_t *A, h
     return -1;
 }
 
+inline int halide_sgemm_batched(bool transA, bool transB, float a, halide_buffer_t *A, halide_buffer_t *B, float b, halide_buffer_t *C) {
+    if (transA && transB) {
+        return halide_sgemm_batched_transAB(a, A, B, b, C, C);
+    } else if (transA) {
+        return halide_sgemm_batched_transA(a, A, B, b, C, C);
+    } else if (transB) {
+        return halide_sgemm_batched_transB(a, A, B, b, C, C);
+    } else {
+        return halide_sgemm_batched_notrans(a, A, B, b, C, C);
+    }
+    return -1;
+}
+
 inline int halide_dgemm(bool transA, bool transB, double a, halide_buffer_t *A, halide_buffer_t *B, double b, halide_buffer_t *C) {
     if (transA && transB) {
         return halide_dgemm_transAB(a, A, B, b, C, C);
@@ -103,6 +124,19 @@ inline int halide_dgemm(bool transA, bool transB, double a, halide_buffer_t *A,
     return -1;
 }
 
+inline int halide_dgemm_batched(bool transA, bool transB, double a, halide_buffer_t *A, halide_buffer_t *B, double b, halide_buffer_t *C) {
+    if (transA && transB) {
+        return halide_dgemm_batched_transAB(a, A, B, b, C, C);
+    } else if (transA) {
+        return halide_dgemm_batched_transA(a, A, B, b, C, C);
+    } else if (transB) {
+        return halide_dgemm_batched_transB(a, A, B, b, C, C);
+    } else {
+        return halide_dgemm_batched_notrans(a, A, B, b, C, C);
+    }
+    return -1;
+}
+
 enum HBLAS_ORDER {HblasRowMajor=101, HblasColMajor=102};
 enum HBLAS_TRANSPOSE {HblasNoTrans=111, HblasTrans=112, HblasConjTrans=113};
 enum HBLAS_UPLO {HblasUpper=121, HblasLower=122};
@@ -244,6 +278,42 @@ void hblas_dgemm(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA
                  const int lda, const double *B, const int ldb,
                  const double beta, double *C, const int ldc);
 
+/*
+ * Batched versions of gemm, which do batch_count independent matrix
+ * multiplies of the same size in a single call. In the strided
+ * versions, the i'th matrices start at A + i*strideA, B + i*strideB
+ * and C + i*strideC. In the others, they are given by arrays of
+ * pointers; if these are evenly spaced they are handled as by the
+ * strided versions, and otherwise each multiply is done separately.
+ */
+void hblas_sgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const float alpha, const float *A,
+                                 const int lda, const int strideA, const float *B, const int ldb,
+                                 const int strideB, const float beta, float *C, const int ldc,
+                                 const int strideC, const int batch_count);
+
+void hblas_dgemm_strided_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                                 const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                                 const int K, const double alpha, const double *A,
+                                 const int lda, const int strideA, const double *B, const int ldb,
+                                 const int strideB, const double beta, double *C, const int ldc,
+                                 const int strideC, const int batch_count);
+
+void hblas_sgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const float alpha, const float *const A[],
+                         const int lda, const float *const B[], const int ldb,
+                         const float beta, float *const C[], const int ldc,
+                         const int batch_count);
+
+void hblas_dgemm_batched(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                         const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                         const int K, const double alpha, const double *const A[],
+                         const int lda, const double *const B[], const int ldb,
+                         const double beta, double *const C[], const int ldc,
+                         const int batch_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
@@ -112,6 +113,146 @@
         return compareMatrices(N, eC, aC);      \
     }
 
+// Runs gemm over all combinations of transposes, on non-square
+// shapes. Some are larger than, but not multiples of, the block sizes
+// the generator packs its inputs in.
+#define L3_SHAPES_TEST(method, cblas_code, hblas_code)                  \
+    bool test_##method(int size) {                                      \
+        const int shapes[][3] = {                                       \
+            {size + 3, std::max(1, size - 1), size / 2 + 5},            \
+            {193, 67, 389},                                             \
+            {37, 1, 200},                                               \
+            {1, 17, 3},                                                 \
+        };                                                              \
+        for (const auto &shape : shapes) {                              \
+            for (int t = 0; t < 4; t++) {                               \
+                const int M = shape[0], N = shape[1], K = shape[2];     \
+                const bool tA = t & 1, tB = t & 2;                      \
+                const int lda = tA ? K : M, ldb = tB ? N : K, ldc = M;  \
+                Scalar alpha = random_scalar();                         \
+                Scalar beta = random_scalar();                          \
+                Matrix eA(random_vector(M*K));                          \
+                Matrix eB(random_vector(K*N));                          \
+                Matrix eC(random_vector(M*N));                          \
+                Matrix aA(eA), aB(eB), aC(eC);                          \
+                                                                        \
+                {                                                       \
+                    Scalar *A = &(eA[0]);                               \
+                    Scalar *B = &(eB[0]);                               \
+                    Scalar *C = &(eC[0]);                               \
+                    cblas_code;                                         \
+                }                                                       \
+                                                                        \
+                {                                                       \
+                    Scalar *A = &(aA[0]);                               \
+                    Scalar *B = &(aB[0]);                               \
+                    Scalar *C = &(aC[0]);                               \
+                    hblas_code;                                         \
+                }                                                       \
+                                                                        \
+                if (!compareVectors(M*N, eC, aC)) {                     \
+                    std::cerr << "M = " << M << ", N = " << N           \
+                              << ", K = " << K << ", transA = " << tA   \
+                              << ", transB = " << tB << "\n";           \
+                    return false;                                       \
+                }                                                       \
+            }                                                           \
+        }                                                               \
+        return true;                                                    \
+    }
+
+// Runs a batched gemm at the given size, and at sizes small enough
+// for the generator to do each matrix whole.
+#define L3_BATCHED_TEST(method, cblas_code, hblas_code)                 \
+    bool test_##method(int size) {                                      \
+        for (int N : {size, 16, 5}) {                                   \
+            const int batch = 7;                                        \
+            Scalar alpha = random_scalar();                             \
+            Scalar beta = random_scalar();                              \
+            Matrix eA(random_vector(N*N*batch));                        \
+            Matrix eB(random_vector(N*N*batch));                        \
+            Matrix eC(random_vector(N*N*batch));                        \
+            Matrix aA(eA), aB(eB), aC(eC);                              \
+                                                                        \
+            for (int b = 0; b < batch; b++) {                           \
+                Scalar *A = &(eA[b*N*N]);                               \
+                Scalar *B = &(eB[b*N*N]);                               \
+                Scalar *C = &(eC[b*N*N]);                               \
+                cblas_code;                                             \
+            }                                                           \
+                                                                        \
+            {                                                           \
+                Scalar *A = &(aA[0]);                                   \
+                Scalar *B = &(aB[0]);                                   \
+                Scalar *C = &(aC[0]);                                   \
+                std::vector<const Scalar *> As, Bs;                     \
+                std::vector<Scalar *> Cs;                               \
+                for (int b = 0; b < batch; b++) {                       \
+                    As.push_back(A + b*N*N);                            \
+                    Bs.push_back(B + b*N*N);                            \
+                    Cs.push_back(C + b*N*N);                            \
+                }                                                       \
+                hblas_code;                                             \
+            }                                                           \
+                                                                        \
+            if (!compareVectors(N*N*batch, eC, aC)) {                   \
+                std::cerr << "N = " << N << "\n";                       \
+                return false;                                           \
+            }                                                           \
+        }                                                               \
+        return true;                                                    \
+    }
+
+// Runs a batched gemm on small matrices, with arrays of pointers that
+// aren't evenly spaced, and with evenly spaced ones whose outputs
+// overlap. Both must behave as if the matrices were multiplied one at
+// a time, in order.
+#define L3_BATCHED_LAYOUT_TEST(method, cblas_code, hblas_code)          \
+    bool test_##method(int) {                                           \
+        for (int N : {16, 5}) {                                         \
+            for (bool overlapping : {false, true}) {                    \
+                const int batch = 7;                                    \
+                std::vector<int> offsets;                               \
+                for (int b = 0; b < batch; b++) {                       \
+                    offsets.push_back(overlapping ? b*N                 \
+                                      : b*N*N + b*(b+1)/2);     \
+                }                                                       \
+                const int total = offsets.back() + N*N;                 \
+                Scalar alpha = random_scalar();                         \
+                Scalar beta = random_scalar();                          \
+                Matrix eA(random_vector(total));                        \
+                Matrix eB(random_vector(total));                        \
+                Matrix eC(random_vector(total));                        \
+                Matrix aA(eA), aB(eB), aC(eC);                          \
+                                                                        \
+                for (int b = 0; b < batch; b++) {                       \
+                    Scalar *A = &(eA[offsets[b]]);                      \
+                    Scalar *B = &(eB[offsets[b]]);                      \
+                    Scalar *C = &(eC[offsets[b]]);                      \
+                    cblas_code;                                         \
+                }                                                       \
+                                                                        \
+                {                                                       \
+                    std::vector<const Scalar *> As, Bs;                 \
+                    std::vector<Scalar *> Cs;                           \
+                    for (int b = 0; b < batch; b++) {                   \
+                        As.push_back(&(aA[offsets[b]]));                \
+                        Bs.push_back(&(aB[offsets[b]]));                \
+                        Cs.push_back(&(aC[offsets[b]]));                \
+                    }                                                   \
+                    hblas_code;                                         \
+                }                                                       \
+                                                                        \
+                if (!compareVectors(total, eC, aC)) {                   \
+                    std::cerr << "N = " << N << ", overlapping = "      \
+                              << overlapping << "\n";                   \
+                    return false;                                       \
+                }                                                       \
+            }                                                           \
+        }                                                               \
+        return true;                                                    \
+    }
+
 
 template<class T>
 struct BLASTestBase {
@@ -211,6 +352,10 @@ struct BLASFloatTests : public BLASTestBase<float> {
         RUN_TEST(sgemm_transA);
         RUN_TEST(sgemm_transB);
         RUN_TEST(sgemm_transAB);
+        RUN_TEST(sgemm_shapes);
+        RUN_TEST(sgemm_strided_batched);
+        RUN_TEST(sgemm_batched);
+        RUN_TEST(sgemm_batched_layouts);
     }
 
     L1_VECTOR_TEST(scopy, scopy(N, x, 1, y, 1))
@@ -242,6 +387,24 @@ struct BLASFloatTests : public BLASTestBase<float> {
     L3_TEST(sgemm_transAB,
             cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_sgemm(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
+    L3_SHAPES_TEST(sgemm_shapes,
+            cblas_sgemm(CblasColMajor, tA ? CblasTrans : CblasNoTrans, tB ? CblasTrans : CblasNoTrans,
+                        M, N, K, alpha, A, lda, B, ldb, beta, C, ldc),
+            hblas_sgemm(HblasColMajor, tA ? HblasTrans : HblasNoTrans, tB ? HblasTrans : HblasNoTrans,
+                        M, N, K, alpha, A, lda, B, ldb, beta, C, ldc));
+
+    L3_BATCHED_TEST(sgemm_strided_batched,
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_sgemm_strided_batched(HblasColMajor, HblasNoTrans, HblasTrans, N, N, N, alpha,
+                                        A, N, N*N, B, N, N*N, beta, C, N, N*N, batch));
+    L3_BATCHED_TEST(sgemm_batched,
+            cblas_sgemm(CblasColMajor, CblasTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_sgemm_batched(HblasColMajor, HblasTrans, HblasNoTrans, N, N, N, alpha,
+                                As.data(), N, Bs.data(), N, beta, Cs.data(), N, batch));
+    L3_BATCHED_LAYOUT_TEST(sgemm_batched_layouts,
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_sgemm_batched(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha,
+                                As.data(), N, Bs.data(), N, beta, Cs.data(), N, batch));
 };
 
 struct BLASDoubleTests : public BLASTestBase<double> {
@@ -258,6 +421,10 @@ struct BLASDoubleTests : public BLASTestBase<double> {
         RUN_TEST(dgemm_transA);
         RUN_TEST(dgemm_transB);
         RUN_TEST(dgemm_transAB);
+        RUN_TEST(dgemm_shapes);
+        RUN_TEST(dgemm_strided_batched);
+        RUN_TEST(dgemm_batched);
+        RUN_TEST(dgemm_batched_layouts);
     }
 
     L1_VECTOR_TEST(dcopy, dcopy(N, x, 1, y, 1))
@@ -289,6 +456,24 @@ struct BLASDoubleTests : public BLASTestBase<double> {
     L3_TEST(dgemm_transAB,
             cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_dgemm(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
+    L3_SHAPES_TEST(dgemm_shapes,
+            cblas_dgemm(CblasColMajor, tA ? CblasTrans : CblasNoTrans, tB ? CblasTrans : CblasNoTrans,
+                        M, N, K, alpha, A, lda, B, ldb, beta, C, ldc),
+            hblas_dgemm(HblasColMajor, tA ? HblasTrans : HblasNoTrans, tB ? HblasTrans : HblasNoTrans,
+                        M, N, K, alpha, A, lda, B, ldb, beta, C, ldc));
+
+    L3_BATCHED_TEST(dgemm_strided_batched,
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_dgemm_strided_batched(HblasColMajor, HblasNoTrans, HblasTrans, N, N, N, alpha,
+                                        A, N, N*N, B, N, N*N, beta, C, N, N*N, batch));
+    L3_BATCHED_TEST(dgemm_batched,
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_dgemm_batched(HblasColMajor, HblasTrans, HblasNoTrans, N, N, N, alpha,
+                                As.data(), N, Bs.data(), N, beta, Cs.data(), N, batch));
+    L3_BATCHED_LAYOUT_TEST(dgemm_batched_layouts,
+            cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+            hblas_dgemm_batched(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha,
+                                As.data(), N, Bs.data(), N, beta, Cs.data(), N, batch));
 };
 
 int main(int argc, char *argv[]) {
@@ -0,0 +1,130 @@
+// Benchmark the runtime and the memory use of the default and the low
+// memory schedules of local laplacian. Peak RSS covers the whole
+// process, so each run measures a single schedule:
+//
+//   ./local_laplacian_bench default|low_memory [width height]
+//
+// or "check" to compare the outputs of the two schedules.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/resource.h>
+
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+#include "halide_benchmark.h"
+
+#include "local_laplacian.h"
+#include "local_laplacian_low_memory.h"
+
+using namespace Halide::Runtime;
+using namespace Halide::Tools;
+
+namespace {
+
+std::atomic<size_t> heap_current(0), heap_peak(0);
+
+// Allocations from the pipeline, tracked to find the peak. As with
+// the default halide_malloc, the result is aligned to 128 bytes, and
+// the original pointer is stored just before it (with the size before
+// that).
+void *tracking_malloc(void *user_context, size_t size) {
+    const size_t header = 2 * sizeof(size_t);
+    void *orig = malloc(size + header + 127);
+    if (!orig) {
+        return nullptr;
+    }
+    size_t *ptr = (size_t *)(((uintptr_t)orig + header + 127) & ~(uintptr_t)127);
+    ptr[-1] = (size_t)orig;
+    ptr[-2] = size;
+    size_t current = heap_current += size;
+    size_t peak = heap_peak;
+    while (current > peak && !heap_peak.compare_exchange_weak(peak, current)) {
+    }
+    return ptr;
+}
+
+void tracking_free(void *user_context, void *ptr) {
+    heap_current -= ((size_t *)ptr)[-2];
+    free((void *)((size_t *)ptr)[-1]);
+}
+
+// Peak RSS of the process so far, in MB.
+double peak_rss_mb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+typedef int (*pipeline_t)(halide_buffer_t *, int, float, float, halide_buffer_t *);
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 2 && argc != 4) {
+        printf("Usage: %s default|low_memory|check [width height]\n", argv[0]);
+        return -1;
+    }
+    const int width = argc == 4 ? atoi(argv[2]) : 3840;
+    const int height = argc == 4 ? atoi(argv[3]) : 2160;
+    const int levels = 8;
+    const float alpha = 1.0f / (levels - 1), beta = 1.0f;
+
+    Buffer<uint16_t> input(width, height, 3), output(width, height, 3);
+    input.for_each_element([&](int x, int y, int c) {
+        input(x, y, c) = (uint16_t)(((x * 7 + y * 3 + c * 4096) % 65536) ^ (rand() & 0xfff));
+    });
+
+    if (strcmp(argv[1], "check") == 0) {
+        Buffer<uint16_t> low_memory_output(width, height, 3);
+        local_laplacian(input, levels, alpha, beta, output);
+        local_laplacian_low_memory(input, levels, alpha, beta, low_memory_output);
+        for (int c = 0; c < 3; c++) {
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    if (std::abs(output(x, y, c) - low_memory_output(x, y, c)) > 1) {
+                        printf("low_memory_output(%d, %d, %d) = %d instead of %d\n",
+                               x, y, c, low_memory_output(x, y, c), output(x, y, c));
+                        return -1;
+                    }
+                }
+            }
+        }
+        printf("Success!\n");
+        return 0;
+    }
+
+    pipeline_t pipeline;
+    if (strcmp(argv[1], "default") == 0) {
+        pipeline = local_laplacian;
+    } else if (strcmp(argv[1], "low_memory") == 0) {
+        pipeline = local_laplacian_low_memory;
+    } else {
+        printf("Unknown schedule %s\n", argv[1]);
+        return -1;
+    }
+
+    halide_set_custom_malloc(tracking_malloc);
+    halide_set_custom_free(tracking_free);
+
+    const double rss_before = peak_rss_mb();
+    BenchmarkResult r = benchmark([&]() {
+        pipeline(input, levels, alpha, beta, output);
+    });
+    const double rss_after = peak_rss_mb();
+    report_benchmark(std::string("local_laplacian_") + argv[1], r);
+
+    printf("%s (%dx%d): %.2f ms (median %.2f ms, p90 %.2f ms), "
+           "peak pipeline heap %.1f MB, peak RSS %.1f MB (%.1f MB above the input and output)\n",
+           argv[1], width, height, r.min * 1e3, r.median * 1e3, r.p90 * 1e3,
+           heap_peak / (1024.0 * 1024.0), rss_after, rss_after - rss_before);
+    return 0;
+}
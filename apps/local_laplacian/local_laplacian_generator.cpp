@@ -4,10 +4,17 @@ namespace {
 
 constexpr int maxJ = 20;
 
+namespace Pyramid = Halide::Pyramid;
+using Pyramid::LevelPolicy;
+
 class LocalLaplacian : public Halide::Generator<LocalLaplacian> {
 public:
 
     GeneratorParam<int>   pyramid_levels{"pyramid_levels", 8, 1, maxJ};
+    // If true, no fine level of any pyramid is computed over the
+    // whole image at once, at the cost of computing the fine levels
+    // of the Gaussian pyramids twice, and the luminance at every use.
+    GeneratorParam<bool>  minimize_memory{"minimize_memory", false};
 
     ImageParam            input{UInt(16), 3, "input"};
     Param<int>            levels{"levels"};
@@ -35,32 +42,32 @@ public:
         gray(x, y) = 0.299f * floating(x, y, 0) + 0.587f * floating(x, y, 1) + 0.114f * floating(x, y, 2);
 
         // Make the processed Gaussian pyramid.
-        Func gPyramid[maxJ];
+        Func gPyramid0("gPyramid_0");
         // Do a lookup into a lut with 256 entires per intensity level
         Expr level = k * (1.0f / (levels - 1));
         Expr idx = gray(x, y)*cast<float>(levels-1)*256.0f;
         idx = clamp(cast<int>(idx), 0, (levels-1)*256);
-        gPyramid[0](x, y, k) = beta*(gray(x, y) - level) + level + remap(idx - 256*k);
-        for (int j = 1; j < J; j++) {
-            gPyramid[j](x, y, k) = downsample(gPyramid[j-1])(x, y, k);
+        gPyramid0(x, y, k) = beta*(gray(x, y) - level) + level + remap(idx - 256*k);
+
+        // The finest levels are fused into the output. In the low
+        // memory schedule the Gaussian pyramids' fine levels are too,
+        // and the coarse levels are computed from a separate copy of
+        // them.
+        const int fine_levels = std::min(J, 5);
+        std::vector<Func> gPyramid, gFeeder, inGPyramid, inGFeeder;
+        if (minimize_memory) {
+            gPyramid = Pyramid::gaussian_low_memory(gPyramid0, J, fine_levels, &gFeeder, "gPyramid");
+            inGPyramid = Pyramid::gaussian_low_memory(gray, J, fine_levels, &inGFeeder, "inGPyramid");
+        } else {
+            gPyramid = Pyramid::gaussian(gPyramid0, J, "gPyramid");
+            inGPyramid = Pyramid::gaussian(gray, J, "inGPyramid");
         }
 
         // Get its laplacian pyramid
-        Func lPyramid[maxJ];
-        lPyramid[J-1](x, y, k) = gPyramid[J-1](x, y, k);
-        for (int j = J-2; j >= 0; j--) {
-            lPyramid[j](x, y, k) = gPyramid[j](x, y, k) - upsample(gPyramid[j+1])(x, y, k);
-        }
-
-        // Make the Gaussian pyramid of the input
-        Func inGPyramid[maxJ];
-        inGPyramid[0](x, y) = gray(x, y);
-        for (int j = 1; j < J; j++) {
-            inGPyramid[j](x, y) = downsample(inGPyramid[j-1])(x, y);
-        }
+        std::vector<Func> lPyramid = Pyramid::laplacian(gPyramid, "lPyramid");
 
         // Make the laplacian pyramid of the output
-        Func outLPyramid[maxJ];
+        std::vector<Func> outLPyramid(J);
         for (int j = 0; j < J; j++) {
             // Split input pyramid value into integer and floating parts
             Expr level = inGPyramid[j](x, y) * cast<float>(levels-1);
@@ -71,11 +78,7 @@ public:
         }
 
         // Make the Gaussian pyramid of the output
-        Func outGPyramid[maxJ];
-        outGPyramid[J-1](x, y) = outLPyramid[J-1](x, y);
-        for (int j = J-2; j >= 0; j--) {
-            outGPyramid[j](x, y) = upsample(outGPyramid[j+1])(x, y) + outLPyramid[j](x, y);
-        }
+        std::vector<Func> outGPyramid = Pyramid::collapse(outLPyramid, "outGPyramid");
 
         // Reintroduce color (Connelly: use eps to avoid scaling up noise w/ apollo3.png input)
         Func color;
@@ -102,32 +105,89 @@ public:
                     blockh = 2;
                 }
                 if (j > 0) {
-                    inGPyramid[j].compute_root().gpu_tile(x, y, xi, yi, blockw, blockh);
-                    gPyramid[j].compute_root().reorder(k, x, y).gpu_tile(x, y, xi, yi, blockw, blockh);
+                    std::vector<Var> in_args = inGPyramid[j].args(), g_args = gPyramid[j].args();
+                    inGPyramid[j].compute_root().gpu_tile(in_args[0], in_args[1], xi, yi, blockw, blockh);
+                    gPyramid[j].compute_root().reorder(g_args[2], g_args[0], g_args[1])
+                        .gpu_tile(g_args[0], g_args[1], xi, yi, blockw, blockh);
                 }
-                outGPyramid[j].compute_root().gpu_tile(x, y, xi, yi, blockw, blockh);
+                std::vector<Var> out_args = outGPyramid[j].args();
+                outGPyramid[j].compute_root().gpu_tile(out_args[0], out_args[1], xi, yi, blockw, blockh);
             }
         } else {
             // cpu schedule
             Var yo;
             output.reorder(c, x, y).split(y, yo, y, 64).parallel(yo).vectorize(x, 8);
-            gray.compute_root().parallel(y, 32).vectorize(x, 8);
-            for (int j = 1; j < 5; j++) {
-                inGPyramid[j]
-                    .compute_root().parallel(y, 32).vectorize(x, 8);
-                gPyramid[j]
-                    .compute_root().reorder_storage(x, k, y)
-                    .reorder(k, y).parallel(y, 8).vectorize(x, 8);
-                outGPyramid[j]
-                    .store_at(output, yo).compute_at(output, y)
-                    .vectorize(x, 8);
+
+            // The fine levels of the processed pyramid are stored
+            // with k inside y, and computed a row of every k at a time.
+            auto reorder_k = [](Func f) {
+                std::vector<Var> args = f.args();
+                f.reorder_storage(args[0], args[2], args[1]).reorder(args[2], args[1]);
+            };
+
+            // The fine levels of the output pyramid are streamed
+            // through strips of the output.
+            Pyramid::ScheduleOptions strips;
+            strips.store_level = LoopLevel(output, yo);
+            strips.compute_level = LoopLevel(output, y);
+            const std::vector<LevelPolicy> streaming =
+                Pyramid::policies(J, fine_levels, LevelPolicy::Streaming, LevelPolicy::Inline);
+            Pyramid::schedule(outGPyramid, streaming, strips);
+            Pyramid::schedule(outGPyramid[0], LevelPolicy::Fused, strips);
+
+            // The coarse levels of every pyramid are small, and are
+            // computed serially at root.
+            Pyramid::ScheduleOptions serial;
+            serial.vector_width = 0;
+            serial.parallel_task_size = 0;
+            for (int j = fine_levels; j < J; j++) {
+                Pyramid::schedule(inGPyramid[j], LevelPolicy::Root, serial);
+                Pyramid::schedule(outGPyramid[j], LevelPolicy::Root, serial);
+                Pyramid::schedule(gPyramid[j], LevelPolicy::Root, serial);
+                gPyramid[j].parallel(gPyramid[j].args()[2]);
+            }
+
+            for (int j = 1; j < fine_levels; j++) {
+                reorder_k(gPyramid[j]);
             }
-            outGPyramid[0]
-                .compute_at(output, y).vectorize(x, 8);
-            for (int j = 5; j < J; j++) {
-                inGPyramid[j].compute_root();
-                gPyramid[j].compute_root().parallel(k);
-                outGPyramid[j].compute_root();
+            if (!minimize_memory) {
+                // The fine levels of the input pyramids are computed
+                // at root, and stay resident until the output is done.
+                gray.compute_root().parallel(y, 32).vectorize(x, 8);
+                Pyramid::ScheduleOptions root, root_gray;
+                root_gray.parallel_task_size = 32;
+                const std::vector<LevelPolicy> fine_root =
+                    Pyramid::policies(J, fine_levels, LevelPolicy::Root, LevelPolicy::Inline);
+                Pyramid::schedule(inGPyramid, fine_root, root_gray);
+                Pyramid::schedule(gPyramid, fine_root, root);
+            } else {
+                // The luminance is read both by strips of the output
+                // and by the feeders below, so it's cheapest to inline
+                // it rather than keep a whole plane of it.
+
+                // The fine levels of the input pyramids are streamed
+                // through strips of the output too...
+                Pyramid::schedule(inGPyramid, streaming, strips);
+                Pyramid::schedule(gPyramid, streaming, strips);
+
+                // ...and the copies of them that the coarse levels are
+                // computed from are streamed through strips of the
+                // first coarse level, in parallel.
+                if (fine_levels < J) {
+                    auto stream_into = [&](const std::vector<Func> &feeder, Func coarse) {
+                        Var cy = coarse.args()[1], cyo;
+                        coarse.split(cy, cyo, cy, 16).parallel(cyo);
+                        Pyramid::ScheduleOptions options;
+                        options.store_level = LoopLevel(coarse, cyo);
+                        options.compute_level = LoopLevel(coarse, cy);
+                        Pyramid::schedule(feeder, Pyramid::policies(fine_levels, fine_levels, LevelPolicy::Streaming), options);
+                    };
+                    for (int j = 1; j < fine_levels; j++) {
+                        reorder_k(gFeeder[j]);
+                    }
+                    stream_into(gFeeder, gPyramid[fine_levels]);
+                    stream_into(inGFeeder, inGPyramid[fine_levels]);
+                }
             }
         }
 
@@ -135,26 +195,6 @@ public:
     }
 private:
     Var x, y, c, k;
-
-    // Downsample with a 1 3 3 1 filter
-    Func downsample(Func f) {
-        using Halide::_;
-        Func downx, downy;
-        downx(x, y, _) = (f(2*x-1, y, _) + 3.0f * (f(2*x, y, _) + f(2*x+1, y, _)) + f(2*x+2, y, _)) / 8.0f;
-        downy(x, y, _) = (downx(x, 2*y-1, _) + 3.0f * (downx(x, 2*y, _) + downx(x, 2*y+1, _)) + downx(x, 2*y+2, _)) / 8.0f;
-        return downy;
-    }
-
-    // Upsample using bilinear interpolation
-    Func upsample(Func f) {
-        using Halide::_;
-        Func upx, upy;
-        upx(x, y, _) = 0.25f * f((x/2) - 1 + 2*(x % 2), y, _) + 0.75f * f(x/2, y, _);
-        upy(x, y, _) = 0.25f * upx(x, (y/2) - 1 + 2*(y % 2), _) + 0.75f * upx(x, y/2, _);
-        return upy;
-    }
-
-
 };
 
 Halide::RegisterGenerator<LocalLaplacian> register_me{"local_laplacian"};
@@ -24,10 +24,13 @@ int main(int argc, char **argv) {
     int timing = atoi(argv[5]);
 
     // Timing code
-    double best = benchmark(timing, 1, [&]() {
+    BenchmarkConfig config;
+    config.min_samples = timing;
+    BenchmarkResult best = benchmark([&]() {
         local_laplacian(input, levels, alpha/(levels-1), beta, output);
-    });
-    printf("%gus\n", best * 1e6);
+    }, config);
+    report_benchmark("local_laplacian", best);
+    printf("%gus (median %gus, p90 %gus)\n", best.min * 1e6, best.median * 1e6, best.p90 * 1e6);
 
 
     local_laplacian(input, levels, alpha/(levels-1), beta, output);
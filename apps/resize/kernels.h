@@ -0,0 +1,62 @@
+#ifndef RESIZE_KERNELS_H
+#define RESIZE_KERNELS_H
+
+#include "Halide.h"
+
+// The interpolation kernels used by resize.cpp and the resample generator.
+
+enum InterpolationType {
+    BOX, LINEAR, CUBIC, LANCZOS
+};
+
+inline Halide::Expr kernel_box(Halide::Expr x) {
+    using namespace Halide;
+    Expr xx = abs(x);
+    return select(xx <= 0.5f, 1.0f, 0.0f);
+}
+
+inline Halide::Expr kernel_linear(Halide::Expr x) {
+    using namespace Halide;
+    Expr xx = abs(x);
+    return select(xx < 1.0f, 1.0f - xx, 0.0f);
+}
+
+inline Halide::Expr kernel_cubic(Halide::Expr x) {
+    using namespace Halide;
+    Expr xx = abs(x);
+    Expr xx2 = xx * xx;
+    Expr xx3 = xx2 * xx;
+    float a = -0.5f;
+
+    return select(xx < 1.0f, (a + 2.0f) * xx3 - (a + 3.0f) * xx2 + 1,
+                  select (xx < 2.0f, a * xx3 - 5 * a * xx2 + 8 * a * xx - 4.0f * a,
+                          0.0f));
+}
+
+inline Halide::Expr sinc(Halide::Expr x) {
+    using namespace Halide;
+    return sin(float(M_PI) * x) / x;
+}
+
+inline Halide::Expr kernel_lanczos(Halide::Expr x) {
+    using namespace Halide;
+    Expr value = sinc(x) * sinc(x/3);
+    value = select(x == 0.0f, 1.0f, value); // Take care of singularity at zero
+    value = select(x > 3 || x < -3, 0.0f, value); // Clamp to zero out of bounds
+    return value;
+}
+
+struct KernelInfo {
+    const char *name;
+    float size;
+    Halide::Expr (*kernel)(Halide::Expr);
+};
+
+static KernelInfo kernelInfo[] = {
+    { "box", 0.5f, kernel_box },
+    { "linear", 1.0f, kernel_linear },
+    { "cubic", 2.0f, kernel_cubic },
+    { "lanczos", 3.0f, kernel_lanczos }
+};
+
+#endif
@@ -0,0 +1,100 @@
+// Benchmark the polyphase resampling generators over a range of
+// arbitrary ratios, and check that the fixed point versions agree with
+// the floating point version.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "HalideBuffer.h"
+#include "halide_benchmark.h"
+
+#include "resample_u8.h"
+#include "resample_u16.h"
+#include "resample_f32.h"
+
+using namespace Halide::Runtime;
+using namespace Halide::Tools;
+
+int main(int argc, char **argv) {
+    int width = 1920, height = 1080;
+    if (argc == 3) {
+        width = atoi(argv[1]);
+        height = atoi(argv[2]);
+    } else if (argc != 1) {
+        printf("Usage: %s [width height]\n", argv[0]);
+        return -1;
+    }
+    const int channels = 3;
+
+    // A smooth gradient with some noise, so both the interpolation and
+    // the lowpass filtering do some work.
+    Buffer<uint8_t> in_u8(width, height, channels);
+    Buffer<uint16_t> in_u16(width, height, channels);
+    Buffer<float> in_f32(width, height, channels);
+    for (int c = 0; c < channels; c++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int v = (x * 3 + y * 5 + c * 64) % 224 + rand() % 32;
+                in_u8(x, y, c) = (uint8_t)v;
+                in_u16(x, y, c) = (uint16_t)(v * 257);
+                in_f32(x, y, c) = v / 255.0f;
+            }
+        }
+    }
+
+    const float ratios[] = {0.25f, 0.33f, 0.5f, 0.75f, 1.5f, 2.0f, 3.7f};
+
+    printf("%dx%d input\n", width, height);
+    printf("%8s %12s %12s %12s %12s %12s\n",
+           "ratio", "output", "u8 (ms)", "u16 (ms)", "f32 (ms)", "u8 MPix/s");
+
+    for (float ratio : ratios) {
+        const int out_width = std::max(1, (int)std::lround(width * ratio));
+        const int out_height = std::max(1, (int)std::lround(height * ratio));
+        const float scale_x = (float)out_width / width;
+        const float scale_y = (float)out_height / height;
+
+        Buffer<uint8_t> out_u8(out_width, out_height, channels);
+        Buffer<uint16_t> out_u16(out_width, out_height, channels);
+        Buffer<float> out_f32(out_width, out_height, channels);
+
+        double t_u8 = benchmark([&]() {
+            resample_u8(in_u8, scale_x, scale_y, out_u8);
+        });
+        double t_u16 = benchmark([&]() {
+            resample_u16(in_u16, scale_x, scale_y, out_u16);
+        });
+        double t_f32 = benchmark([&]() {
+            resample_f32(in_f32, scale_x, scale_y, out_f32);
+        });
+
+        const double mpix = (double)out_width * out_height / 1e6;
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", out_width, out_height);
+        printf("%8.2f %12s %12.3f %12.3f %12.3f %12.1f\n",
+               ratio, size, t_u8 * 1e3, t_u16 * 1e3, t_f32 * 1e3, mpix / t_u8);
+
+        // The fixed point results should be within rounding of the
+        // floating point result, once it has been clamped to the
+        // representable range.
+        for (int c = 0; c < channels; c++) {
+            for (int y = 0; y < out_height; y++) {
+                for (int x = 0; x < out_width; x++) {
+                    float f = std::min(std::max(out_f32(x, y, c), 0.0f), 1.0f);
+                    float e8 = std::abs(out_u8(x, y, c) - f * 255.0f);
+                    float e16 = std::abs(out_u16(x, y, c) - f * 65535.0f);
+                    if (e8 > 2.0f || e16 > 2.0f * 257) {
+                        printf("Mismatch at ratio %f, (%d, %d, %d): u8 %d, u16 %d, f32 %f\n",
+                               ratio, x, y, c, out_u8(x, y, c), out_u16(x, y, c), out_f32(x, y, c));
+                        return -1;
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
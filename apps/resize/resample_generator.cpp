@@ -0,0 +1,200 @@
+#include "Halide.h"
+
+#include "kernels.h"
+
+using namespace Halide;
+
+namespace {
+
+std::map<std::string, InterpolationType> interpolation_enum_map() {
+    return { { "box", BOX },
+             { "linear", LINEAR },
+             { "cubic", CUBIC },
+             { "lanczos", LANCZOS } };
+}
+
+// The arithmetic used for a given pixel type. Floating point images are
+// resampled in float. Integer images are resampled in fixed point, with
+// weights that have weight_bits fractional bits. The intermediate between
+// the two passes keeps intermediate_bits extra fractional bits.
+template<typename T>
+struct ResampleTraits {
+    static Type accumulator() { return Float(32); }
+    static Type intermediate() { return Float(32); }
+    static const int weight_bits = 0;
+    static const int intermediate_bits = 0;
+};
+
+template<>
+struct ResampleTraits<uint8_t> {
+    static Type accumulator() { return Int(32); }
+    static Type intermediate() { return Int(16); }
+    static const int weight_bits = 14;
+    static const int intermediate_bits = 6;
+};
+
+// For 16-bit images, the weights and intermediate have fewer bits, so that
+// the sums of products still fit in 32 bits.
+template<>
+struct ResampleTraits<uint16_t> {
+    static Type accumulator() { return Int(32); }
+    static Type intermediate() { return Int(32); }
+    static const int weight_bits = 12;
+    static const int intermediate_bits = 0;
+};
+
+// Separable resampling of a planar image by an arbitrary ratio. The ratio
+// is a runtime parameter, and the output size is the size of the output
+// buffer. The kernel is sampled at 'phases' subpixel offsets, and these
+// weights are normalized and computed once per ratio, rather than per
+// output pixel.
+template<typename T>
+class ResampleGenerator :
+        public Generator<ResampleGenerator<T>> {
+  public:
+    typedef Generator<ResampleGenerator<T>> Base;
+    using Base::get_target;
+    using Base::natural_vector_size;
+
+    GeneratorParam<InterpolationType> interpolation_{"interpolation", CUBIC, interpolation_enum_map()};
+
+    // The number of subpixel positions the kernel is sampled at. The
+    // position of each output pixel in the input is rounded to the nearest
+    // of these.
+    GeneratorParam<int> phases_{"phases", 64};
+
+    ImageParam input_{type_of<T>(), 3, "input"};
+
+    // The ratio of the output size to the input size in each dimension.
+    Param<float> scale_x_{"scale_x", 1.0f};
+    Param<float> scale_y_{"scale_y", 1.0f};
+
+    Func build() {
+        typedef ResampleTraits<T> Traits;
+        const bool is_float = type_of<T>().is_float();
+        const KernelInfo &info = kernelInfo[(InterpolationType)interpolation_];
+        const int phases = phases_;
+
+        Var x("x"), y("y"), c("c"), p("p"), k("k");
+
+        Func clamped = BoundaryConditions::repeat_edge(input_);
+
+        // The weights of each phase of the kernel, for a given scale. For
+        // downscaling, the kernel is widened to perform lowpass filtering.
+        // Tap k of phase p is at offset k - support + 1 - p/phases from the
+        // sample position, so 2*support taps cover the kernel for every
+        // phase.
+        auto define_weights = [&](Param<float> scale, const std::string &name,
+                                  Func *weights, Expr *support) {
+            Expr kernel_scaling = min(scale, 1.0f);
+            *support = cast<int>(ceil(info.size / kernel_scaling));
+            RDom taps(0, 2 * *support, name + "_taps");
+
+            Func unnormalized(name + "_unnormalized");
+            unnormalized(p, k) = info.kernel((k - *support + 1 - cast<float>(p) / phases) * kernel_scaling);
+            Func normalized(name + "_normalized");
+            normalized(p, k) = unnormalized(p, k) / sum(unnormalized(p, taps));
+
+            if (is_float) {
+                *weights = normalized;
+            } else {
+                // Quantize the weights. Put the rounding error on the tap
+                // nearest the sample position, so the weights of each
+                // phase sum to exactly 1.
+                const int one = 1 << Traits::weight_bits;
+                Func quantized(name + "_quantized");
+                quantized(p, k) = cast<int16_t>(round(normalized(p, k) * one));
+                Expr center = *support - 1 + select(p * 2 >= phases, 1, 0);
+                Func corrected(name + "_weights");
+                corrected(p, k) = quantized(p, k) +
+                    select(k == center, cast<int16_t>(one - sum(cast<int>(quantized(p, taps)))), cast<int16_t>(0));
+                *weights = corrected;
+            }
+            weights->compute_root().memoize();
+        };
+
+        Func weights_x, weights_y;
+        Expr support_x, support_y;
+        define_weights(scale_x_, "weights_x", &weights_x, &support_x);
+        define_weights(scale_y_, "weights_y", &weights_y, &support_y);
+
+        // The first input sample and the phase for each output coordinate.
+        auto source = [&](Expr v, Param<float> scale, Expr support, Expr *begin, Expr *phase) {
+            Expr s = (v + 0.5f) / scale - 0.5f;
+            Expr s_floor = floor(s);
+            *begin = cast<int>(s_floor) - support + 1;
+            *phase = clamp(cast<int>(round((s - s_floor) * phases)), 0, phases);
+        };
+        Expr begin_x, phase_x, begin_y, phase_y;
+        source(x, scale_x_, support_x, &begin_x, &phase_x);
+        source(y, scale_y_, support_y, &begin_y, &phase_y);
+
+        // Gather the weights for each output column and row, so the
+        // passes below load them densely.
+        Func kernel_x("kernel_x"), kernel_y("kernel_y");
+        kernel_x(x, k) = weights_x(phase_x, k);
+        kernel_y(y, k) = weights_y(phase_y, k);
+
+        const Type acc_type = Traits::accumulator();
+        const int shift_x = Traits::weight_bits - Traits::intermediate_bits;
+        const int shift_y = Traits::weight_bits + Traits::intermediate_bits;
+        auto rounding = [&](int shift) {
+            return shift > 0 ? cast(acc_type, 1 << (shift - 1)) : cast(acc_type, 0);
+        };
+
+        // The horizontal pass.
+        RDom rx(0, 2 * support_x, "rx");
+        Func resized_x("resized_x");
+        resized_x(x, y, c) = rounding(shift_x);
+        resized_x(x, y, c) += cast(acc_type, kernel_x(x, rx)) * cast(acc_type, clamped(begin_x + rx, y, c));
+
+        Func intermediate("intermediate");
+        if (is_float) {
+            intermediate(x, y, c) = resized_x(x, y, c);
+        } else {
+            intermediate(x, y, c) = cast(Traits::intermediate(), resized_x(x, y, c) >> shift_x);
+        }
+
+        // The vertical pass.
+        RDom ry(0, 2 * support_y, "ry");
+        Func resized_y("resized_y");
+        resized_y(x, y, c) = rounding(shift_y);
+        resized_y(x, y, c) += cast(acc_type, kernel_y(y, ry)) * cast(acc_type, intermediate(x, begin_y + ry, c));
+
+        Func output("output");
+        if (is_float) {
+            output(x, y, c) = resized_y(x, y, c);
+        } else {
+            Expr value = resized_y(x, y, c) >> shift_y;
+            output(x, y, c) = cast<T>(clamp(value, 0, cast<int>(type_of<T>().max())));
+        }
+
+        // Schedule. The weight tables are small, and computed once for
+        // each ratio. The intermediate is computed as a sliding window
+        // over strips of output rows, and both passes are vectorized
+        // across x, so the vertical pass loads whole vectors of the
+        // intermediate.
+        const int vector_size = natural_vector_size(acc_type);
+        kernel_x.compute_root().vectorize(x, vector_size, TailStrategy::GuardWithIf);
+        kernel_y.compute_root();
+
+        Var yo("yo"), yi("yi");
+        output.split(y, yo, yi, 32).parallel(yo)
+            .vectorize(x, vector_size);
+        resized_y.compute_at(output, x).vectorize(x);
+        resized_y.update().reorder(x, ry).vectorize(x);
+
+        intermediate.store_at(output, yo).compute_at(output, yi)
+            .vectorize(x, vector_size);
+        resized_x.compute_at(intermediate, x).vectorize(x);
+        resized_x.update().reorder(x, rx).vectorize(x);
+
+        return output;
+    }
+};
+
+RegisterGenerator<ResampleGenerator<uint8_t>>  register_resample_u8("resample_u8");
+RegisterGenerator<ResampleGenerator<uint16_t>> register_resample_u16("resample_u16");
+RegisterGenerator<ResampleGenerator<float>>    register_resample_f32("resample_f32");
+
+}  // namespace
@@ -8,55 +8,7 @@ using namespace Halide;
 #include "halide_image_io.h"
 #include "halide_benchmark.h"
 
-enum InterpolationType {
-    BOX, LINEAR, CUBIC, LANCZOS
-};
-
-Expr kernel_box(Expr x) {
-    Expr xx = abs(x);
-    return select(xx <= 0.5f, 1.0f, 0.0f);
-}
-
-Expr kernel_linear(Expr x) {
-    Expr xx = abs(x);
-    return select(xx < 1.0f, 1.0f - xx, 0.0f);
-}
-
-Expr kernel_cubic(Expr x) {
-    Expr xx = abs(x);
-    Expr xx2 = xx * xx;
-    Expr xx3 = xx2 * xx;
-    float a = -0.5f;
-
-    return select(xx < 1.0f, (a + 2.0f) * xx3 - (a + 3.0f) * xx2 + 1,
-                  select (xx < 2.0f, a * xx3 - 5 * a * xx2 + 8 * a * xx - 4.0f * a,
-                          0.0f));
-}
-
-Expr sinc(Expr x) {
-    return sin(float(M_PI) * x) / x;
-}
-
-Expr kernel_lanczos(Expr x) {
-    Expr value = sinc(x) * sinc(x/3);
-    value = select(x == 0.0f, 1.0f, value); // Take care of singularity at zero
-    value = select(x > 3 || x < -3, 0.0f, value); // Clamp to zero out of bounds
-    return value;
-}
-
-struct KernelInfo {
-    const char *name;
-    float size;
-    Expr (*kernel)(Expr);
-};
-
-static KernelInfo kernelInfo[] = {
-    { "box", 0.5f, kernel_box },
-    { "linear", 1.0f, kernel_linear },
-    { "cubic", 2.0f, kernel_cubic },
-    { "lanczos", 3.0f, kernel_lanczos }
-};
-
+#include "kernels.h"
 
 std::string infile, outfile;
 InterpolationType interpolationType = LINEAR;
@@ -188,7 +140,7 @@ int main(int argc, char **argv) {
            out_width, out_height,
            kernelInfo[interpolationType].name);
 
-    double min = Tools::benchmark(10, 1, [&]() { final.realize(out); });
+    double min = Tools::benchmark([&]() { final.realize(out); });
     std::cout << " took min=" << min * 1000 << " msec." << std::endl;
 
     Tools::save_image(out, outfile);
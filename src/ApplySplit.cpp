@@ -47,7 +47,8 @@ vector<ApplySplitResult> apply_split(const Split &split, bool is_update, string
         } else if (is_one(split.factor)) {
             // The split factor trivially divides the old extent,
             // but we know nothing new about the outer dimension.
-        } else if (tail == TailStrategy::GuardWithIf) {
+        } else if (tail == TailStrategy::GuardWithIf ||
+                   tail == TailStrategy::Predicate) {
             // It's an exact split but we failed to prove that the
             // extent divides the factor. Use predication.
 
@@ -66,6 +67,11 @@ vector<ApplySplitResult> apply_split(const Split &split, bool is_update, string
             // Tell Halide to optimize for the case in which this
             // condition is true by partitioning some outer loop.
             Expr cond = likely(rebased_var < old_extent);
+            if (tail == TailStrategy::Predicate) {
+                // Tag the guard, so that loop vectorization turns it
+                // into predicated loads and stores.
+                cond = Call::make(Bool(), Call::predicated_tail, {cond}, Call::PureIntrinsic);
+            }
             result.push_back(ApplySplitResult(cond));
             result.push_back(ApplySplitResult(rebased_var_name, rebased, ApplySplitResult::LetStmt));
 
@@ -0,0 +1,181 @@
+#include "BatchEntryPoint.h"
+#include "IROperator.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Make a call and return the result upwards immediately if it's
+// non-zero.
+Stmt make_checked_call(Expr call) {
+    internal_assert(call.type() == Int(32));
+    string result_var_name = unique_name('t');
+    Expr result_var = Variable::make(Int(32), result_var_name);
+    Stmt s = AssertStmt::make(result_var == 0, result_var);
+    s = LetStmt::make(result_var_name, call, s);
+    return s;
+}
+
+Expr buffer_field(const string &field, Expr buf, int d) {
+    return Call::make(Int(32), field, {buf, d}, Call::Extern);
+}
+
+// Call the pipeline called 'name' on the item of the batch at
+// 'index'. Each buffer argument is cropped to the item in the batch
+// dimension, and then reinitialized in place with that dimension
+// removed.
+Stmt call_on_item(const string &name, Call::CallType call_type,
+                  const vector<LoweredArgument> &args, Expr index) {
+    vector<Expr> call_args;
+    vector<std::pair<string, Expr>> lets;
+    for (const LoweredArgument &arg : args) {
+        if (!arg.is_buffer()) {
+            call_args.push_back(Variable::make(arg.type, arg.name));
+            continue;
+        }
+
+        const int d = arg.dimensions;
+        Expr batch = Variable::make(type_of<struct halide_buffer_t *>(), arg.name + ".buffer");
+
+        vector<Expr> mins, extents;
+        for (int i = 0; i < d; i++) {
+            mins.push_back(buffer_field(Call::buffer_get_min, batch, i));
+            extents.push_back(buffer_field(Call::buffer_get_extent, batch, i));
+        }
+        mins.push_back(buffer_field(Call::buffer_get_min, batch, d) + index);
+        extents.push_back(1);
+
+        Expr alloca_size = Call::make(Int(32), Call::size_of_halide_buffer_t, {}, Call::Intrinsic);
+        Expr crop = Call::make(type_of<struct halide_buffer_t *>(), Call::buffer_crop,
+                               {Call::make(type_of<struct halide_buffer_t *>(), Call::alloca,
+                                           {alloca_size}, Call::Intrinsic),
+                                Call::make(type_of<struct halide_dimension_t *>(), Call::alloca,
+                                           {(int)sizeof(halide_dimension_t) * (d + 1)}, Call::Intrinsic),
+                                batch,
+                                Call::make(Handle(), Call::make_struct, mins, Call::Intrinsic),
+                                Call::make(Handle(), Call::make_struct, extents, Call::Intrinsic)},
+                               Call::Extern);
+        string crop_name = arg.name + ".batch_crop";
+        Expr crop_var = Variable::make(type_of<struct halide_buffer_t *>(), crop_name);
+        lets.push_back({crop_name, crop});
+
+        BufferBuilder builder;
+        builder.buffer_memory = crop_var;
+        builder.shape_memory = Call::make(type_of<struct halide_dimension_t *>(),
+                                          Call::buffer_get_shape, {crop_var}, Call::Extern);
+        builder.host = Call::make(Handle(), Call::buffer_get_host, {crop_var}, Call::Extern);
+        builder.type = arg.type;
+        builder.dimensions = d;
+        for (int i = 0; i < d; i++) {
+            builder.mins.push_back(mins[i]);
+            builder.extents.push_back(extents[i]);
+            builder.strides.push_back(buffer_field(Call::buffer_get_stride, batch, i));
+        }
+        string item_name = arg.name + ".batch_item";
+        lets.push_back({item_name, builder.build()});
+        call_args.push_back(Variable::make(type_of<struct halide_buffer_t *>(), item_name));
+    }
+
+    Stmt s = make_checked_call(Call::make(Int(32), name, call_args, call_type));
+    while (!lets.empty()) {
+        s = LetStmt::make(lets.back().first, lets.back().second, s);
+        lets.pop_back();
+    }
+    return s;
+}
+
+}  // namespace
+
+void add_batch_entry_point(Module module, const LoweredFunc &fn,
+                           const string &unchecked_name,
+                           const string &batch_name,
+                           const std::map<string, int> &host_alignments) {
+    vector<LoweredArgument> args;
+    const LoweredArgument *first_output = nullptr;
+    for (const LoweredArgument &arg : fn.args) {
+        args.push_back(arg);
+        if (arg.is_buffer()) {
+            args.back().dimensions = arg.dimensions + 1;
+            if (!first_output && arg.is_output()) {
+                first_output = &arg;
+            }
+        }
+    }
+    internal_assert(first_output) << "Pipeline " << fn.name << " has no outputs\n";
+
+    // The batch size is the extent of the batch dimension of the first output.
+    string size_name = batch_name + ".batch_size";
+    Expr size = Variable::make(Int(32), size_name);
+    Expr output_buffer = Variable::make(type_of<struct halide_buffer_t *>(), first_output->name + ".buffer");
+    Expr size_value = buffer_field(Call::buffer_get_extent, output_buffer, first_output->dimensions);
+
+    // Check the batch buffers before looking inside them. Bounds
+    // queries aren't supported, so the buffers of a non-empty batch
+    // must all be allocated. The per-item checks happen in the call on
+    // the first item, except for host alignment: the other items are
+    // offset from the first by multiples of the batch stride.
+    vector<Stmt> null_checks, size_checks, host_checks, set_dirty;
+    for (const LoweredArgument &arg : args) {
+        if (!arg.is_buffer()) continue;
+        const int d = arg.dimensions - 1;
+        Expr buf = Variable::make(type_of<struct halide_buffer_t *>(), arg.name + ".buffer");
+        Expr null_error = Call::make(Int(32), "halide_error_buffer_argument_is_null",
+                                     {arg.name}, Call::Extern);
+        null_checks.push_back(AssertStmt::make(reinterpret<uint64_t>(buf) != 0, null_error));
+        Expr host = Call::make(Handle(), Call::buffer_get_host, {buf}, Call::Extern);
+        host_checks.push_back(AssertStmt::make(reinterpret<uint64_t>(host) != 0, null_error));
+        auto alignment = host_alignments.find(arg.name);
+        if (alignment != host_alignments.end() && alignment->second > arg.type.bytes()) {
+            Expr stride_bytes = cast<int64_t>(buffer_field(Call::buffer_get_stride, buf, d)) * arg.type.bytes();
+            Expr align_error = Call::make(Int(32), "halide_error_unaligned_host_ptr",
+                                          {arg.name, alignment->second}, Call::Extern);
+            host_checks.push_back(AssertStmt::make(stride_bytes % alignment->second == 0, align_error));
+        }
+        if (arg.name != first_output->name) {
+            Expr extent = buffer_field(Call::buffer_get_extent, buf, d);
+            Expr size_error = Call::make(Int(32), "halide_error_constraint_violated",
+                                         {arg.name + ".extent." + std::to_string(d), extent,
+                                          first_output->name + ".extent." + std::to_string(first_output->dimensions), size},
+                                         Call::Extern);
+            size_checks.push_back(AssertStmt::make(extent == size, size_error));
+        }
+        // The items write the batch outputs through their own buffer
+        // structs, so mark the batch outputs as dirty here.
+        if (arg.is_output()) {
+            set_dirty.push_back(Evaluate::make(Call::make(Int(32), Call::buffer_set_host_dirty,
+                                                          {buf, const_true()}, Call::Extern)));
+        }
+    }
+
+    // Run the first item through the checked entry point, and the
+    // rest in parallel through the unchecked one.
+    Call::CallType call_type = Call::Extern;
+    if (fn.name_mangling == NameMangling::CPlusPlus ||
+        (fn.name_mangling == NameMangling::Default &&
+         module.target().has_feature(Target::CPlusPlusMangling))) {
+        call_type = Call::ExternCPlusPlus;
+    }
+    Stmt first = call_on_item(fn.name, call_type, fn.args, 0);
+    string index_name = batch_name + ".batch_index";
+    Stmt rest = call_on_item(unchecked_name, Call::Extern, fn.args, Variable::make(Int(32), index_name));
+    rest = For::make(index_name, 1, size - 1, ForType::Parallel, DeviceAPI::None, rest);
+
+    Stmt body = Block::make({Block::make(host_checks), first, rest, Block::make(set_dirty)});
+    body = IfThenElse::make(size > 0, body);
+    if (!size_checks.empty()) {
+        body = Block::make(Block::make(size_checks), body);
+    }
+    body = LetStmt::make(size_name, size_value, body);
+    body = Block::make(Block::make(null_checks), body);
+
+    debug(2) << "Added batch entry point for " << fn.name << ":\n" << body << "\n\n";
+    module.append(LoweredFunc(batch_name, args, body, LoweredFunc::External, fn.name_mangling));
+}
+
+}
+}
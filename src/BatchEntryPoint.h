@@ -0,0 +1,44 @@
+#ifndef HALIDE_BATCH_ENTRY_POINT_H
+#define HALIDE_BATCH_ENTRY_POINT_H
+
+/** \file
+ *
+ * Defines a pass over a Module that adds an entry point that runs a
+ * pipeline over a batch of same-shaped arguments.
+ */
+
+#include <map>
+#include <string>
+
+#include "Module.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Add a LoweredFunc called batch_name to the module, which runs the
+ * pipeline fn over a batch of arguments. Each buffer argument of the
+ * batch entry point has one more dimension than the corresponding
+ * argument of fn. The outermost dimension indexes the batch, and must
+ * have the same extent for every buffer. Scalar arguments are shared
+ * by the whole batch.
+ *
+ * The first item is passed to fn, which checks the arguments as
+ * usual. The remaining items have the same shape and strides, so they
+ * are passed to unchecked_name, a version of the same pipeline
+ * compiled without assertions, in a single parallel loop over the
+ * batch. The unchecked version must already be in the module, with
+ * internal linkage and the same arguments as fn.
+ *
+ * host_alignments gives the host alignment in bytes declared for each
+ * buffer argument, by name. The unchecked version assumes it, so the
+ * batch stride of those buffers is checked to keep every item as
+ * aligned as the first. */
+void add_batch_entry_point(Module module, const LoweredFunc &fn,
+                           const std::string &unchecked_name,
+                           const std::string &batch_name,
+                           const std::map<std::string, int> &host_alignments);
+
+}
+}
+
+#endif
@@ -0,0 +1,147 @@
+#include "CPUDispatch.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Substitute.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+vector<CPUDispatchVersion> cpu_dispatch_versions(const Target &t) {
+    vector<CPUDispatchVersion> result;
+    if (t.arch != Target::X86 || !t.has_feature(Target::CPUDispatch)) {
+        return result;
+    }
+
+    struct {
+        const char *name;
+        vector<Target::Feature> features;
+    } ladder[] = {
+        {"avx512", {Target::SSE41, Target::AVX, Target::AVX2, Target::FMA, Target::F16C,
+                    Target::AVX512, Target::AVX512_Skylake}},
+        {"avx2", {Target::SSE41, Target::AVX, Target::AVX2, Target::FMA, Target::F16C}},
+        {"sse41", {Target::SSE41}}
+    };
+
+    for (const auto &l : ladder) {
+        Target version = t.without_feature(Target::CPUDispatch);
+        uint64_t mask = 0;
+        for (Target::Feature f : l.features) {
+            version.set_feature(f);
+            mask |= ((uint64_t) 1) << f;
+        }
+        if (version == t.without_feature(Target::CPUDispatch)) {
+            // The target can already do everything this version
+            // could.
+            continue;
+        }
+        CPUDispatchVersion v;
+        v.suffix = string(".cpu_dispatch_") + l.name;
+        v.target = version;
+        v.condition_name = string("cpu_dispatch.can_use_") + l.name;
+        v.feature_mask = mask;
+        result.push_back(v);
+    }
+    return result;
+}
+
+namespace {
+
+// Does a loop contain vector code, and nothing that would stop us
+// compiling it as a function of its own for a different target?
+class WorthVersioning : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Ramp *op) {
+        has_vectors = true;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Broadcast *op) {
+        has_vectors = true;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const For *op) {
+        if (op->for_type != ForType::Serial ||
+            (op->device_api != DeviceAPI::None &&
+             op->device_api != DeviceAPI::Host)) {
+            has_other_loops = true;
+        } else {
+            IRVisitor::visit(op);
+        }
+    }
+
+public:
+    bool has_vectors = false;
+    bool has_other_loops = false;
+};
+
+class MultiVersionLoops : public IRMutator {
+    const vector<CPUDispatchVersion> &versions;
+
+    using IRMutator::visit;
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            stmt = op;
+            return;
+        }
+
+        WorthVersioning w;
+        op->accept(&w);
+        if (!w.has_vectors || w.has_other_loops) {
+            // Look for loops worth versioning inside this one.
+            IRMutator::visit(op);
+            return;
+        }
+
+        // Select between the versions, best first, falling back to
+        // the original loop.
+        Stmt result = op;
+        for (size_t i = versions.size(); i > 0; i--) {
+            const CPUDispatchVersion &v = versions[i - 1];
+            string name = op->name + v.suffix;
+            Stmt body = substitute(op->name, Variable::make(Int(32), name), op->body);
+            Stmt version = For::make(name, op->min, op->extent, op->for_type, op->device_api, body);
+            result = IfThenElse::make(Variable::make(Bool(), v.condition_name), version, result);
+        }
+        stmt = result;
+        versioned = true;
+    }
+
+public:
+    bool versioned = false;
+
+    MultiVersionLoops(const vector<CPUDispatchVersion> &v) : versions(v) {}
+};
+
+}  // namespace
+
+Stmt multi_version_loops(Stmt s, const Target &t) {
+    vector<CPUDispatchVersion> versions = cpu_dispatch_versions(t);
+    if (versions.empty()) {
+        return s;
+    }
+
+    MultiVersionLoops m(versions);
+    s = m.mutate(s);
+
+    if (m.versioned) {
+        // Ask the runtime which versions the CPU can run once, up
+        // front. The answers are cached by the runtime anyway.
+        for (const CPUDispatchVersion &v : versions) {
+            Expr can_use = Call::make(Int(32), "halide_can_use_target_features",
+                                      {UIntImm::make(UInt(64), v.feature_mask)},
+                                      Call::Extern);
+            s = LetStmt::make(v.condition_name, can_use != 0, s);
+        }
+    }
+    return s;
+}
+
+}
+}
@@ -0,0 +1,54 @@
+#ifndef HALIDE_CPU_DISPATCH_H
+#define HALIDE_CPU_DISPATCH_H
+
+/** \file
+ * Defines the lowering pass that multi-versions vectorized loops for
+ * Target::CPUDispatch.
+ */
+
+#include <string>
+#include <vector>
+
+#include "IR.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** An extra version of a vectorized loop compiled with
+ * Target::CPUDispatch. */
+struct CPUDispatchVersion {
+    /** The suffix given to the name of the loop variable of this
+     * version of a loop. Codegen uses it to recognize the loop. */
+    std::string suffix;
+
+    /** The target to compile this version of the loop for. */
+    Target target;
+
+    /** The name of the boolean variable that says whether the CPU
+     * we're running on can run this version. */
+    std::string condition_name;
+
+    /** The features to pass to halide_can_use_target_features to
+     * compute that condition. */
+    uint64_t feature_mask;
+};
+
+/** The extra versions of each vectorized loop to compile for the
+ * given target, best first. Only versions that use features beyond
+ * those of the target are included, so this is empty unless the
+ * target is x86 with the CPUDispatch feature. */
+EXPORT std::vector<CPUDispatchVersion> cpu_dispatch_versions(const Target &t);
+
+/** Replace the outermost serial loops that contain vector code (and
+ * no parallel or device loops) with a chain of if statements that
+ * selects between the versions given by cpu_dispatch_versions and
+ * the original loop, according to what the CPU supports. The checks
+ * are done once, at the top of the pipeline. Everything outside
+ * these loops is shared between the versions. */
+EXPORT Stmt multi_version_loops(Stmt s, const Target &t);
+
+}
+}
+
+#endif
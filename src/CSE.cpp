@@ -1,4 +1,5 @@
 #include <map>
+#include <unordered_map>
 
 #include "CSE.h"
 #include "IRMutator.h"
@@ -61,6 +62,22 @@ bool should_extract(Expr e) {
     return true;
 }
 
+// Hashing and equality by identity, for maps that are looked up with
+// the very same Exprs that were inserted.
+struct ExprIdentityHash {
+    size_t operator()(const Expr &e) const {
+        return std::hash<const IRNode *>()(e.get());
+    }
+};
+
+struct ExprIdentityEqual {
+    bool operator()(const Expr &a, const Expr &b) const {
+        return a.same_as(b);
+    }
+};
+
+typedef std::unordered_map<Expr, Expr, ExprIdentityHash, ExprIdentityEqual> ExprReplacements;
+
 // A global-value-numbering of expressions. Returns canonical form of
 // the Expr and writes out a global value numbering as a side-effect.
 class GVN : public IRMutator {
@@ -71,31 +88,30 @@ public:
     };
     vector<Entry> entries;
 
-    typedef map<ExprWithCompareCache, int> CacheType;
+    IRCompareCache cache;
+
+    // Numbering by value. Lookups compare the cached structural
+    // hashes first, so only Exprs that are very likely equal get
+    // compared deeply.
+    typedef std::unordered_map<Expr, int, ExprHash, ExprEqual> CacheType;
     CacheType numbering;
 
-    map<Expr, int, ExprCompare> shallow_numbering;
+    std::unordered_map<Expr, int, ExprIdentityHash, ExprIdentityEqual> shallow_numbering;
 
     Scope<int> let_substitutions;
     int number;
 
-    IRCompareCache cache;
-
-    GVN() : number(0), cache(8) {}
+    GVN() : cache(8), numbering(64, ExprHash(), ExprEqual(&cache)), number(0) {}
 
     Stmt mutate(Stmt s) {
         internal_error << "Can't call GVN on a Stmt: " << s << "\n";
         return Stmt();
     }
 
-    ExprWithCompareCache with_cache(Expr e) {
-        return ExprWithCompareCache(e, &cache);
-    }
-
     Expr mutate(Expr e) {
         // Early out if we've already seen this exact Expr.
         {
-            map<Expr, int, ExprCompare>::iterator iter = shallow_numbering.find(e);
+            auto iter = shallow_numbering.find(e);
             if (iter != shallow_numbering.end()) {
                 number = iter->second;
                 internal_assert(entries[number].expr.type() == e.type());
@@ -113,7 +129,7 @@ public:
         }
 
         // If e already has an entry, return that.
-        CacheType::iterator iter = numbering.find(with_cache(e));
+        CacheType::iterator iter = numbering.find(e);
         if (iter != numbering.end()) {
             number = iter->second;
             shallow_numbering[e] = number;
@@ -127,7 +143,7 @@ public:
 
         // See if it's there in another form after being rebuilt
         // (e.g. because it was a let variable).
-        iter = numbering.find(with_cache(e));
+        iter = numbering.find(e);
         if (iter != numbering.end()) {
             number = iter->second;
             shallow_numbering[old_e] = number;
@@ -138,7 +154,7 @@ public:
         // Add it to the numbering.
         Entry entry = {e, 0};
         number = (int)entries.size();
-        numbering[with_cache(e)] = number;
+        numbering[e] = number;
         shallow_numbering[e] = number;
         entries.push_back(entry);
         internal_assert(e.type() == old_e.type());
@@ -214,7 +230,7 @@ public:
         }
 
         // Find this thing's number.
-        map<Expr, int, ExprCompare>::iterator iter = gvn.shallow_numbering.find(e);
+        auto iter = gvn.shallow_numbering.find(e);
         if (iter != gvn.shallow_numbering.end()) {
             GVN::Entry &entry = gvn.entries[iter->second];
             entry.use_count++;
@@ -231,13 +247,13 @@ public:
 /** Rebuild an expression using a map of replacements. Works on graphs without exploding. */
 class Replacer : public IRMutator {
 public:
-    map<Expr, Expr, ExprCompare> replacements;
-    Replacer(const map<Expr, Expr, ExprCompare> &r) : replacements(r) {}
+    ExprReplacements replacements;
+    Replacer(const ExprReplacements &r) : replacements(r) {}
 
     using IRMutator::mutate;
 
     Expr mutate(Expr e) {
-        map<Expr, Expr, ExprCompare>::iterator iter = replacements.find(e);
+        ExprReplacements::iterator iter = replacements.find(e);
 
         if (iter != replacements.end()) {
             return iter->second;
@@ -281,7 +297,7 @@ Expr common_subexpression_elimination(Expr e) {
     // Figure out which ones we'll pull out as lets and variables.
     vector<pair<string, Expr>> lets;
     vector<Expr> new_version(gvn.entries.size());
-    map<Expr, Expr, ExprCompare> replacements;
+    ExprReplacements replacements;
     for (size_t i = 0; i < gvn.entries.size(); i++) {
         const GVN::Entry &e = gvn.entries[i];
         Expr old = e.expr;
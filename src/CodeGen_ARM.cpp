@@ -1,5 +1,6 @@
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 #include "CodeGen_ARM.h"
 #include "ConciseCasts.h"
@@ -971,6 +972,48 @@ void CodeGen_ARM::visit(const Call *op) {
     CodeGen_Posix::visit(op);
 }
 
+Value *CodeGen_ARM::codegen_dynamic_shuffle(Value *lut, Value *indices, int max_index) {
+    if (!lut->getType()->getVectorElementType()->isIntegerTy(8) ||
+        neon_intrinsics_disabled()) {
+        return CodeGen_Posix::codegen_dynamic_shuffle(lut, indices, max_index);
+    }
+
+    // tbl (or vtbl on 32-bit arm) looks up indices in a table of up
+    // to four registers, and returns zero for indices past the
+    // end. Larger tables are looked up four registers at a time, and
+    // the results selected according to the high bits of the index.
+    int reg_lanes = target.bits == 64 ? 16 : 8;
+    int group_lanes = reg_lanes * 4;
+    llvm::Type *reg_type = target.bits == 64 ? i8x16 : i8x8;
+    int lanes = indices->getType()->getVectorNumElements();
+    vector<Value *> result;
+    for (int i = 0; i < lanes; i += reg_lanes) {
+        Value *idx = slice_vector(indices, i, reg_lanes);
+        Value *slice = nullptr;
+        for (int g = 0; g * group_lanes <= max_index; g++) {
+            int regs = std::min(4, (max_index - g * group_lanes) / reg_lanes + 1);
+            Value *group_start = ConstantVector::getSplat(reg_lanes, ConstantInt::get(i8_t, g * group_lanes));
+            vector<Value *> args;
+            for (int r = 0; r < regs; r++) {
+                args.push_back(slice_vector(lut, g * group_lanes + r * reg_lanes, reg_lanes));
+            }
+            args.push_back(g == 0 ? idx : builder->CreateSub(idx, group_start));
+            string intrin = (target.bits == 64 ?
+                             "llvm.aarch64.neon.tbl" + std::to_string(regs) + ".v16i8" :
+                             "llvm.arm.neon.vtbl" + std::to_string(regs));
+            Value *looked_up = call_intrin(reg_type, reg_lanes, intrin, args);
+            if (g == 0) {
+                slice = looked_up;
+            } else {
+                Value *in_group = builder->CreateICmpUGE(idx, group_start);
+                slice = builder->CreateSelect(in_group, looked_up, slice);
+            }
+        }
+        result.push_back(slice);
+    }
+    return slice_vector(concat_vectors(result), 0, lanes);
+}
+
 string CodeGen_ARM::mcpu() const {
     if (target.bits == 32) {
         if (target.has_feature(Target::ARMv7s)) {
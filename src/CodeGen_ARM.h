@@ -20,6 +20,10 @@ protected:
 
     Expr sorted_avg(Expr a, Expr b);
 
+    /** Use tbl (vtbl on 32-bit arm) for lookups in tables of 8-bit
+     * values. */
+    llvm::Value *codegen_dynamic_shuffle(llvm::Value *lut, llvm::Value *indices, int max_index);
+
     using CodeGen_Posix::visit;
 
     /** Nodes for which we want to emit specific neon intrinsics */
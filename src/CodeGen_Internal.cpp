@@ -142,6 +142,7 @@ bool function_takes_user_context(const std::string &name) {
         "halide_copy_to_device",
         "halide_current_time_ns",
         "halide_debug_to_file",
+        "halide_debug_to_file_flush",
         "halide_device_free",
         "halide_device_host_nop_free",
         "halide_device_free_as_destructor",
@@ -160,6 +161,7 @@ bool function_takes_user_context(const std::string &name) {
         "halide_profiler_memory_free",
         "halide_profiler_pipeline_start",
         "halide_profiler_pipeline_end",
+        "halide_profiler_record_args",
         "halide_profiler_stack_peak_update",
         "halide_spawn_thread",
         "halide_device_release",
@@ -439,6 +441,11 @@ void clone_target_options(const llvm::Module &from, llvm::Module &to) {
     if (get_md_string(from.getModuleFlag("halide_mattrs"), mattrs)) {
         to.addModuleFlag(llvm::Module::Warning, "halide_mattrs", llvm::MDString::get(context, mattrs));
     }
+
+    bool fast_compile = false;
+    if (get_md_bool(from.getModuleFlag("halide_fast_compile"), fast_compile)) {
+        to.addModuleFlag(llvm::Module::Warning, "halide_fast_compile", fast_compile ? 1 : 0);
+    }
 }
 
 std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &module) {
@@ -461,7 +468,13 @@ std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &mod
                                                 options,
                                                 llvm::Reloc::PIC_,
                                                 llvm::CodeModel::Default,
-                                                llvm::CodeGenOpt::Aggressive));
+                                                get_codegen_opt_level(module)));
+}
+
+llvm::CodeGenOpt::Level get_codegen_opt_level(const llvm::Module &module) {
+    bool fast_compile = false;
+    get_md_bool(module.getModuleFlag("halide_fast_compile"), fast_compile);
+    return fast_compile ? llvm::CodeGenOpt::Less : llvm::CodeGenOpt::Aggressive;
 }
 
 void set_function_attributes_for_target(llvm::Function *fn, Target t) {
@@ -75,6 +75,11 @@ void clone_target_options(const llvm::Module &from, llvm::Module &to);
 /** Given an llvm::Module, get or create an llvm:TargetMachine */
 std::unique_ptr<llvm::TargetMachine> make_target_machine(const llvm::Module &module);
 
+/** Given an llvm::Module, get the optimization level to use when
+ * generating machine code for it. This is lower for modules compiled
+ * with Target::FastCompile. */
+llvm::CodeGenOpt::Level get_codegen_opt_level(const llvm::Module &module);
+
 /** Set the appropriate llvm Function attributes given a Target. */
 void set_function_attributes_for_target(llvm::Function *, Target);
 
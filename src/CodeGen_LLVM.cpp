@@ -5,7 +5,9 @@
 
 #include "IRPrinter.h"
 #include "CodeGen_LLVM.h"
+#include "CompileTiming.h"
 #include "CPlusPlusMangle.h"
+#include "CPUDispatch.h"
 #include "IROperator.h"
 #include "Debug.h"
 #include "Deinterleave.h"
@@ -483,7 +485,10 @@ MangledNames get_mangled_names(const LoweredFunc &f, const Target &target) {
 std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
     input_module = &input;
 
+    CompileTimer timer(input.name(), "llvm");
+
     init_module();
+    timer.mark("linking runtime modules");
 
     debug(1) << "Target triple of initial module: " << module->getTargetTriple() << "\n";
 
@@ -493,6 +498,7 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
     module->addModuleFlag(llvm::Module::Warning, "halide_use_soft_float_abi", use_soft_float_abi() ? 1 : 0);
     module->addModuleFlag(llvm::Module::Warning, "halide_mcpu", MDString::get(*context, mcpu()));
     module->addModuleFlag(llvm::Module::Warning, "halide_mattrs", MDString::get(*context, mattrs()));
+    module->addModuleFlag(llvm::Module::Warning, "halide_fast_compile", target.has_feature(Target::FastCompile) ? 1 : 0);
 
     internal_assert(module && context && builder)
         << "The CodeGen_LLVM subclass should have made an initial module before calling CodeGen_LLVM::compile\n";
@@ -548,9 +554,11 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
     // Verify the module is ok
     verifyModule(*module);
     debug(2) << "Done generating llvm bitcode\n";
+    timer.mark("generating llvm ir");
 
     // Optimize
     CodeGen_LLVM::optimize_module();
+    timer.mark("optimizing llvm ir");
 
     input_module = nullptr;
 
@@ -1021,15 +1029,20 @@ void CodeGen_LLVM::optimize_module() {
     module_pass_manager.add(createTargetTransformInfoWrapperPass(TM ? TM->getTargetIRAnalysis() : TargetIRAnalysis()));
     function_pass_manager.add(createTargetTransformInfoWrapperPass(TM ? TM->getTargetIRAnalysis() : TargetIRAnalysis()));
 
+    // Halide has already done the loop-level optimizations that
+    // matter. When compiling for speed, do just enough cleanup that
+    // the runtime wrappers get inlined and the IR is reasonable.
+    const bool fast_compile = target.has_feature(Target::FastCompile);
+
     PassManagerBuilder b;
-    b.OptLevel = 3;
+    b.OptLevel = fast_compile ? 1 : 3;
 #if LLVM_VERSION >= 50
     b.Inliner = createFunctionInliningPass(b.OptLevel, 0, false);
 #else
     b.Inliner = createFunctionInliningPass(b.OptLevel, 0);
 #endif
-    b.LoopVectorize = true;
-    b.SLPVectorize = true;
+    b.LoopVectorize = !fast_compile;
+    b.SLPVectorize = !fast_compile;
     b.populateFunctionPassManager(function_pass_manager);
     b.populateModulePassManager(module_pass_manager);
 
@@ -1732,21 +1745,84 @@ void CodeGen_LLVM::visit(const Load *op) {
             value = vec;
         } else {
             // General gathers
-            Value *index = codegen(op->index);
-            Value *vec = UndefValue::get(llvm_type_of(op->type));
-            for (int i = 0; i < op->type.lanes(); i++) {
-                Value *idx = builder->CreateExtractElement(index, ConstantInt::get(i32_t, i));
-                Value *ptr = codegen_buffer_pointer(op->name, op->type.element_of(), idx);
-                LoadInst *val = builder->CreateLoad(ptr);
-                add_tbaa_metadata(val, op->name, op->index);
-                vec = builder->CreateInsertElement(vec, val, ConstantInt::get(i32_t, i));
-            }
-            value = vec;
+            value = codegen_gather(op, codegen(op->index));
         }
     }
 
 }
 
+Value *CodeGen_LLVM::codegen_gather(const Load *op, Value *index) {
+    Value *vec = UndefValue::get(llvm_type_of(op->type));
+    for (int i = 0; i < op->type.lanes(); i++) {
+        Value *idx = builder->CreateExtractElement(index, ConstantInt::get(i32_t, i));
+        Value *ptr = codegen_buffer_pointer(op->name, op->type.element_of(), idx);
+        LoadInst *val = builder->CreateLoad(ptr);
+        add_tbaa_metadata(val, op->name, op->index);
+        vec = builder->CreateInsertElement(vec, val, ConstantInt::get(i32_t, i));
+    }
+    return vec;
+}
+
+void CodeGen_LLVM::codegen_scatter(const Store *op, Value *val, Value *index) {
+    for (int i = 0; i < op->value.type().lanes(); i++) {
+        Value *lane = ConstantInt::get(i32_t, i);
+        Value *idx = builder->CreateExtractElement(index, lane);
+        Value *v = builder->CreateExtractElement(val, lane);
+        Value *ptr = codegen_buffer_pointer(op->name, op->value.type().element_of(), idx);
+        StoreInst *store = builder->CreateStore(v, ptr);
+        add_tbaa_metadata(store, op->name, op->index);
+    }
+}
+
+Value *CodeGen_LLVM::codegen_dynamic_shuffle(Value *lut, Value *indices, int max_index) {
+    // Look up each lane separately. LLVM can extract elements at
+    // non-constant indices.
+    int lanes = indices->getType()->getVectorNumElements();
+    Value *result = UndefValue::get(VectorType::get(lut->getType()->getVectorElementType(), lanes));
+    for (int i = 0; i < lanes; i++) {
+        Value *lane = ConstantInt::get(i32_t, i);
+        Value *idx = builder->CreateZExt(builder->CreateExtractElement(indices, lane), i32_t);
+        result = builder->CreateInsertElement(result, builder->CreateExtractElement(lut, idx), lane);
+    }
+    return result;
+}
+
+Value *CodeGen_LLVM::codegen_vector_of_pointers(const string &buffer, Halide::Type type, Value *index) {
+    Value *base_address = symbol_table.get(buffer);
+    unsigned address_space = base_address->getType()->getPointerAddressSpace();
+    base_address = builder->CreatePointerCast(base_address, llvm_type_of(type.element_of())->getPointerTo(address_space));
+
+    llvm::DataLayout d(module.get());
+    if (d.getPointerSize() == 8) {
+        index = builder->CreateIntCast(index, VectorType::get(i64_t, type.lanes()), true);
+    }
+
+    // A GEP with a scalar base and a vector of indices produces a
+    // vector of pointers.
+    return builder->CreateInBoundsGEP(base_address, index);
+}
+
+Value *CodeGen_LLVM::codegen_masked_gather(const Load *op, Value *index) {
+    #if LLVM_VERSION >= 38
+    Value *ptrs = codegen_vector_of_pointers(op->name, op->type, index);
+    Instruction *gather = builder->CreateMaskedGather(ptrs, op->type.bytes());
+    add_tbaa_metadata(gather, op->name, op->index);
+    return gather;
+    #else
+    return CodeGen_LLVM::codegen_gather(op, index);
+    #endif
+}
+
+void CodeGen_LLVM::codegen_masked_scatter(const Store *op, Value *val, Value *index) {
+    #if LLVM_VERSION >= 38
+    Value *ptrs = codegen_vector_of_pointers(op->name, op->value.type(), index);
+    Instruction *scatter = builder->CreateMaskedScatter(val, ptrs, op->value.type().bytes());
+    add_tbaa_metadata(scatter, op->name, op->index);
+    #else
+    CodeGen_LLVM::codegen_scatter(op, val, index);
+    #endif
+}
+
 void CodeGen_LLVM::visit(const Ramp *op) {
     if (is_const(op->stride) && !is_const(op->base)) {
         // If the stride is const and the base is not (e.g. ramp(x, 1,
@@ -2236,6 +2312,11 @@ void CodeGen_LLVM::visit(const Call *op) {
     } else if (op->is_intrinsic(Call::lerp)) {
         internal_assert(op->args.size() == 3);
         value = codegen(lower_lerp(op->args[0], op->args[1], op->args[2]));
+    } else if (op->is_intrinsic("dynamic_shuffle")) {
+        internal_assert(op->args.size() == 4);
+        const int64_t *max_index = as_const_int(op->args[3]);
+        internal_assert(max_index);
+        value = codegen_dynamic_shuffle(codegen(op->args[0]), codegen(op->args[1]), (int)(*max_index));
     } else if (op->is_intrinsic(Call::popcount)) {
         internal_assert(op->args.size() == 1);
         std::vector<llvm::Type*> arg_type(1);
@@ -2933,6 +3014,15 @@ void CodeGen_LLVM::visit(const ProducerConsumer *op) {
 }
 
 void CodeGen_LLVM::visit(const For *op) {
+    if (target.has_feature(Target::CPUDispatch)) {
+        for (const CPUDispatchVersion &v : cpu_dispatch_versions(target)) {
+            if (ends_with(op->name, v.suffix)) {
+                codegen_loop_for_target(op, v.target);
+                return;
+            }
+        }
+    }
+
     Value *min = codegen(op->min);
     Value *extent = codegen(op->extent);
 
@@ -3072,6 +3162,75 @@ void CodeGen_LLVM::visit(const For *op) {
     }
 }
 
+void CodeGen_LLVM::codegen_loop_for_target(const For *op, const Target &t) {
+    debug(3) << "Compiling loop over " << op->name << " for target " << t.to_string() << "\n";
+
+    // Find every symbol that the loop refers to and dump it into a
+    // closure, as for parallel loops.
+    Closure closure(op, "");
+    StructType *closure_t = build_closure_type(closure, buffer_t_type, context);
+    Value *ptr = create_alloca_at_entry(closure_t, 1);
+    pack_closure(closure_t, ptr, closure, symbol_table, buffer_t_type, builder);
+
+    Value *user_context = get_user_context();
+
+    // Make a new function that runs the whole loop, and compile it
+    // for the other target.
+    llvm::Type *voidPointerType = (llvm::Type *)(i8_t->getPointerTo());
+    llvm::Type *args_t[] = {voidPointerType, voidPointerType};
+    FunctionType *func_t = FunctionType::get(i32_t, args_t, false);
+    llvm::Function *containing_function = function;
+    function = llvm::Function::Create(func_t, llvm::Function::InternalLinkage,
+                                      "loop_" + function->getName() + "_" + op->name, module.get());
+
+    Target containing_target = target;
+    target = t;
+    set_function_attributes_for_target(function, target);
+    function->addFnAttr("target-cpu", mcpu());
+    function->addFnAttr("target-features", mattrs());
+
+    IRBuilderBase::InsertPoint call_site = builder->saveIP();
+    BasicBlock *block = BasicBlock::Create(*context, "entry", function);
+    builder->SetInsertPoint(block);
+
+    BasicBlock *parent_destructor_block = destructor_block;
+    destructor_block = nullptr;
+
+    Scope<Value *> saved_symbol_table;
+    symbol_table.swap(saved_symbol_table);
+
+    // The arguments are the user context and the closure.
+    llvm::Function::arg_iterator iter = function->arg_begin();
+    sym_push("__user_context", iterator_to_pointer(iter));
+    ++iter;
+    iter->setName("closure");
+    Value *closure_handle = builder->CreatePointerCast(iterator_to_pointer(iter),
+                                                       closure_t->getPointerTo());
+    unpack_closure(closure, symbol_table, closure_t, closure_handle, builder);
+
+    // The loop's name no longer matches a version now the target has
+    // changed, so this emits an ordinary loop.
+    codegen(Stmt(op));
+
+    return_with_error_code(ConstantInt::get(i32_t, 0));
+
+    // Move the builder back to the main function and call the loop.
+    builder->restoreIP(call_site);
+    symbol_table.swap(saved_symbol_table);
+    destructor_block = parent_destructor_block;
+    target = containing_target;
+    llvm::Function *loop_function = function;
+    function = containing_function;
+
+    ptr = builder->CreatePointerCast(ptr, i8_t->getPointerTo());
+    Value *args[] = {user_context, ptr};
+    Value *result = builder->CreateCall(loop_function, args);
+
+    // Check for success
+    Value *did_succeed = builder->CreateICmpEQ(result, ConstantInt::get(i32_t, 0));
+    create_assertion(did_succeed, Expr(), result);
+}
+
 void CodeGen_LLVM::visit(const Store *op) {
     // Even on 32-bit systems, Handles are treated as 64-bit in
     // memory, so convert stores of handles to stores of uint64_ts.
@@ -3167,15 +3326,7 @@ void CodeGen_LLVM::visit(const Store *op) {
             }
         } else {
             // Scatter
-            Value *index = codegen(op->index);
-            for (int i = 0; i < value_type.lanes(); i++) {
-                Value *lane = ConstantInt::get(i32_t, i);
-                Value *idx = builder->CreateExtractElement(index, lane);
-                Value *v = builder->CreateExtractElement(val, lane);
-                Value *ptr = codegen_buffer_pointer(op->name, value_type.element_of(), idx);
-                StoreInst *store = builder->CreateStore(v, ptr);
-                add_tbaa_metadata(store, op->name, op->index);
-            }
+            codegen_scatter(op, val, codegen(op->index));
         }
     }
 
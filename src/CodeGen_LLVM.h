@@ -451,6 +451,29 @@ protected:
     /** Get the result of modulus-remainder analysis for a given expr. */
     ModulusRemainder get_alignment_info(Expr e);
 
+    /** Generate a vector load from arbitrary indices (a gather), or a
+     * vector store to them (a scatter). The default implementations
+     * scalarize. Backends with native gathers or scatters override
+     * these and decide when the native instructions are worth it. */
+    // @{
+    virtual llvm::Value *codegen_gather(const Load *op, llvm::Value *index);
+    virtual void codegen_scatter(const Store *op, llvm::Value *val, llvm::Value *index);
+    // @}
+
+    /** Generate a gather or scatter using llvm.masked.gather and
+     * llvm.masked.scatter, which LLVM lowers to native instructions
+     * where the target has them. */
+    // @{
+    llvm::Value *codegen_masked_gather(const Load *op, llvm::Value *index);
+    void codegen_masked_scatter(const Store *op, llvm::Value *val, llvm::Value *index);
+    // @}
+
+    /** Look up each of a vector of 8-bit unsigned indices in a vector
+     * holding a table of max_index + 1 elements. This implements the
+     * dynamic_shuffle intrinsic. The default implementation looks up
+     * each lane separately. */
+    virtual llvm::Value *codegen_dynamic_shuffle(llvm::Value *lut, llvm::Value *indices, int max_index);
+
 private:
 
     /** All the values in scope at the current code location during
@@ -486,6 +509,15 @@ private:
 
     virtual void codegen_predicated_vector_load(const Load *op);
     virtual void codegen_predicated_vector_store(const Store *op);
+
+    /** Compile a loop as a function of its own for a different
+     * target, and call it. Used for the extra versions of loops made
+     * by Target::CPUDispatch. */
+    void codegen_loop_for_target(const For *op, const Target &t);
+
+    /** Compute a vector of pointers into the named buffer from a
+     * vector of indices. */
+    llvm::Value *codegen_vector_of_pointers(const std::string &buffer, Type type, llvm::Value *index);
 };
 
 }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 
 #include "CodeGen_X86.h"
@@ -60,16 +61,147 @@ bool should_use_pmaddwd(Expr a, Expr b, vector<Expr> &result) {
     return true;
 }
 
+// Flatten a tree of Adds into a list of summands.
+void collect_summands(const Expr &e, vector<Expr> &terms) {
+    if (const Add *add = e.as<Add>()) {
+        collect_summands(add->a, terms);
+        collect_summands(add->b, terms);
+    } else {
+        terms.push_back(e);
+    }
+}
+
+// Match a multiply of something that fits in a u8 by something that
+// fits in an i8, in either order.
+bool match_u8_times_i8(const Expr &a, const Expr &b, Expr *u, Expr *s) {
+    Type ut = UInt(8, a.type().lanes()), st = Int(8, a.type().lanes());
+    for (int i = 0; i < 2; i++) {
+        Expr ua = lossless_cast(ut, i == 0 ? a : b);
+        Expr sb = lossless_cast(st, i == 0 ? b : a);
+        if (ua.defined() && sb.defined()) {
+            *u = ua;
+            *s = sb;
+            return true;
+        }
+    }
+    return false;
+}
+
+// pmaddubsw saturates the sum of each pair of products. Products of
+// a u8 and a constant i8 are only safe to pair up if the sum can't
+// overflow an i16.
+bool pmaddubsw_pair_cannot_overflow(const Expr &k1, const Expr &k2) {
+    const int64_t *c1 = as_const_int(k1);
+    const int64_t *c2 = as_const_int(k2);
+    if (!c1 || !c2) {
+        return false;
+    }
+    int64_t lo = 255 * (std::min<int64_t>(*c1, 0) + std::min<int64_t>(*c2, 0));
+    int64_t hi = 255 * (std::max<int64_t>(*c1, 0) + std::max<int64_t>(*c2, 0));
+    return lo >= -32768 && hi <= 32767;
 }
 
+}
+
+Value *CodeGen_X86::pmaddubsw(Type t, const vector<Expr> &args) {
+    internal_assert(args.size() == 4);
+    // The instruction multiplies adjacent pairs of unsigned and
+    // signed bytes, so interleave the two products' operands.
+    Value *u = interleave_vectors({codegen(args[0]), codegen(args[2])});
+    Value *s = interleave_vectors({codegen(args[1]), codegen(args[3])});
+    if (target.has_feature(Target::AVX2) && t.lanes() > 8) {
+        return call_intrin(llvm_type_of(t), 16, "llvm.x86.avx2.pmadd.ub.sw", {u, s});
+    } else {
+        return call_intrin(llvm_type_of(t), 8, "llvm.x86.ssse3.pmadd.ub.sw.128", {u, s});
+    }
+}
 
 void CodeGen_X86::visit(const Add *op) {
-    vector<Expr> matches;
-    if (should_use_pmaddwd(op->a, op->b, matches)) {
-        codegen(Call::make(op->type, "pmaddwd", matches, Call::Extern));
+    // Look for sums of widening multiplies (e.g. an unrolled
+    // convolution or dot product), and pair the products up into
+    // multiply-add instructions. Integer addition is associative, so
+    // we're free to reorder the sum.
+    //
+    // pmaddubsw is an SSSE3 instruction. There's no target feature for
+    // SSSE3, and targets without SSE41 are compiled for a CPU without
+    // it (see mcpu()), so it's gated on SSE41.
+    const int lanes = op->type.lanes();
+    const bool try_pmaddwd = op->type.is_int() && op->type.bits() == 32 && lanes >= 4;
+    const bool try_pmaddubsw = (op->type.is_int() && op->type.bits() == 16 && lanes >= 8 &&
+                                target.has_feature(Target::SSE41));
+    if (!try_pmaddwd && !try_pmaddubsw) {
+        CodeGen_Posix::visit(op);
+        return;
+    }
+
+    vector<Expr> terms;
+    collect_summands(op, terms);
+
+    vector<vector<Expr>> pairs;
+    vector<Expr> rest;
+    if (try_pmaddwd) {
+        Expr pending;
+        for (const Expr &t : terms) {
+            vector<Expr> matches;
+            if (!t.as<Mul>()) {
+                rest.push_back(t);
+            } else if (!pending.defined()) {
+                pending = t;
+            } else if (should_use_pmaddwd(pending, t, matches)) {
+                pairs.push_back(matches);
+                pending = Expr();
+            } else {
+                rest.push_back(pending);
+                pending = t;
+            }
+        }
+        if (pending.defined()) {
+            rest.push_back(pending);
+        }
     } else {
+        vector<vector<Expr>> products;
+        for (const Expr &t : terms) {
+            const Mul *mul = t.as<Mul>();
+            Expr u, s;
+            if (mul && match_u8_times_i8(mul->a, mul->b, &u, &s) && is_const(s)) {
+                products.push_back({u, s, t});
+            } else {
+                rest.push_back(t);
+            }
+        }
+        vector<bool> used(products.size(), false);
+        for (size_t i = 0; i < products.size(); i++) {
+            if (used[i]) continue;
+            for (size_t j = i + 1; j < products.size(); j++) {
+                if (!used[j] && pmaddubsw_pair_cannot_overflow(products[i][1], products[j][1])) {
+                    pairs.push_back({products[i][0], products[i][1], products[j][0], products[j][1]});
+                    used[i] = used[j] = true;
+                    break;
+                }
+            }
+            if (!used[i]) {
+                rest.push_back(products[i][2]);
+            }
+        }
+    }
+
+    if (pairs.empty()) {
         CodeGen_Posix::visit(op);
+        return;
+    }
+
+    Value *sum = nullptr;
+    for (const vector<Expr> &p : pairs) {
+        Value *v = (try_pmaddwd ?
+                    codegen(Call::make(op->type, "pmaddwd", p, Call::Extern)) :
+                    pmaddubsw(op->type, p));
+        sum = sum ? builder->CreateAdd(sum, v) : v;
     }
+    for (const Expr &e : rest) {
+        Value *v = codegen(e);
+        sum = builder->CreateAdd(sum, v);
+    }
+    value = sum;
 }
 
 
@@ -209,6 +341,20 @@ void CodeGen_X86::visit(const Cast *op) {
 
     vector<Expr> matches;
 
+    // A saturating sum of two products of unsigned and signed bytes
+    // is exactly pmaddubsw (which, as above, needs SSE41 for SSSE3).
+    static Expr pmaddubsw_pattern = i16_sat(wild_i32x_ * wild_i32x_ + wild_i32x_ * wild_i32x_);
+    if (op->type.is_int() && op->type.bits() == 16 && op->type.lanes() >= 8 &&
+        target.has_feature(Target::SSE41) &&
+        expr_match(pmaddubsw_pattern, op, matches)) {
+        vector<Expr> args(4);
+        if (match_u8_times_i8(matches[0], matches[1], &args[0], &args[1]) &&
+            match_u8_times_i8(matches[2], matches[3], &args[2], &args[3])) {
+            value = pmaddubsw(op->type, args);
+            return;
+        }
+    }
+
     struct Pattern {
         Target::Feature feature;
         bool wide_op;
@@ -409,6 +555,78 @@ void CodeGen_X86::visit(const Call *op) {
     }
 }
 
+namespace {
+
+// Decide whether a gather or scatter of the given type is worth
+// doing with the native instructions. These only exist for 32 and
+// 64-bit elements. AVX2 gathers are no faster than scalar loads
+// unless they fill a whole ymm register, and only AVX-512 has
+// scatters. Everything else gets scalarized.
+bool use_native_gather_scatter(const Target &target, Type t, bool scatter) {
+    if (t.is_handle() || (t.bits() != 32 && t.bits() != 64) || t.lanes() < 4) {
+        return false;
+    }
+    if (target.has_feature(Target::AVX512) ||
+        target.has_feature(Target::AVX512_KNL) ||
+        target.has_feature(Target::AVX512_Skylake) ||
+        target.has_feature(Target::AVX512_Cannonlake)) {
+        return true;
+    }
+    return (!scatter &&
+            target.has_feature(Target::AVX2) &&
+            t.bits() * t.lanes() >= 256);
+}
+
+}
+
+Value *CodeGen_X86::codegen_gather(const Load *op, Value *index) {
+    if (use_native_gather_scatter(target, op->type, false)) {
+        return codegen_masked_gather(op, index);
+    } else {
+        return CodeGen_Posix::codegen_gather(op, index);
+    }
+}
+
+void CodeGen_X86::codegen_scatter(const Store *op, Value *val, Value *index) {
+    if (use_native_gather_scatter(target, op->value.type(), true)) {
+        codegen_masked_scatter(op, val, index);
+    } else {
+        CodeGen_Posix::codegen_scatter(op, val, index);
+    }
+}
+
+Value *CodeGen_X86::codegen_dynamic_shuffle(Value *lut, Value *indices, int max_index) {
+    if (!lut->getType()->getVectorElementType()->isIntegerTy(8) ||
+        !target.has_feature(Target::SSE41)) {
+        return CodeGen_Posix::codegen_dynamic_shuffle(lut, indices, max_index);
+    }
+
+    // pshufb looks up 16 indices in a 16-byte table. Larger tables
+    // are looked up a 16-byte chunk at a time, and the results
+    // selected according to the high bits of the index.
+    int lanes = indices->getType()->getVectorNumElements();
+    int chunks = max_index / 16 + 1;
+    vector<Value *> result;
+    for (int i = 0; i < lanes; i += 16) {
+        Value *idx = slice_vector(indices, i, 16);
+        Value *slice = nullptr;
+        for (int j = 0; j < chunks; j++) {
+            Value *table = slice_vector(lut, j * 16, 16);
+            Value *chunk_start = ConstantVector::getSplat(16, ConstantInt::get(i8_t, j * 16));
+            Value *chunk_idx = j == 0 ? idx : builder->CreateSub(idx, chunk_start);
+            Value *looked_up = call_intrin(i8x16, 16, "llvm.x86.ssse3.pshuf.b.128", {table, chunk_idx});
+            if (j == 0) {
+                slice = looked_up;
+            } else {
+                Value *in_chunk = builder->CreateICmpUGE(idx, chunk_start);
+                slice = builder->CreateSelect(in_chunk, looked_up, slice);
+            }
+        }
+        result.push_back(slice);
+    }
+    return slice_vector(concat_vectors(result), 0, lanes);
+}
+
 string CodeGen_X86::mcpu() const {
     #if LLVM_VERSION >= 40
     if (target.has_feature(Target::AVX512_Cannonlake)) return "cannonlake";
@@ -31,6 +31,21 @@ protected:
 
     Expr mulhi_shr(Expr a, Expr b, int shr);
 
+    /** Emit pmaddubsw on the pairs of products args[0] * args[1] and
+     * args[2] * args[3], where args[0] and args[2] are u8 vectors and
+     * args[1] and args[3] are i8 vectors. The result is the i16
+     * saturating sum of each pair. */
+    llvm::Value *pmaddubsw(Type t, const std::vector<Expr> &args);
+
+    /** Use native gathers and scatters where they beat scalarizing. */
+    // @{
+    llvm::Value *codegen_gather(const Load *op, llvm::Value *index);
+    void codegen_scatter(const Store *op, llvm::Value *val, llvm::Value *index);
+    // @}
+
+    /** Use pshufb for lookups in tables of 8-bit values. */
+    llvm::Value *codegen_dynamic_shuffle(llvm::Value *lut, llvm::Value *indices, int max_index);
+
     using CodeGen_Posix::visit;
 
     /** Nodes for which we want to emit specific sse/avx intrinsics */
@@ -0,0 +1,113 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#include "CompileTiming.h"
+#include "Debug.h"
+#include "IRVisitor.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+
+namespace {
+
+const string &compile_timing_destination() {
+    static string destination = get_env_variable("HL_COMPILE_TIMING");
+    return destination;
+}
+
+double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class CountIRNodes : public IRGraphVisitor {
+public:
+    using IRGraphVisitor::include;
+    int64_t count() const {
+        return (int64_t)visited.size();
+    }
+};
+
+// Escape the characters that can't appear in a JSON string.
+string json_escape(const string &s) {
+    string result;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if ((unsigned char)c < 0x20) {
+            result += ' ';
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+void report(const string &module_name, const string &stage, const string &pass,
+            double seconds, int64_t ir_nodes) {
+    std::ostringstream line;
+    line.precision(6);
+    line << "{\"module\": \"" << json_escape(module_name) << "\""
+         << ", \"stage\": \"" << stage << "\""
+         << ", \"pass\": \"" << json_escape(pass) << "\""
+         << ", \"seconds\": " << std::fixed << seconds
+         << ", \"ir_nodes\": " << ir_nodes
+         << "}\n";
+
+    debug(1) << "  " << stage << ": " << pass << " took " << seconds << "s\n";
+
+    static std::mutex report_mutex;
+    std::lock_guard<std::mutex> lock(report_mutex);
+    const string &destination = compile_timing_destination();
+    if (destination == "stderr") {
+        std::cerr << line.str();
+    } else {
+        std::ofstream f(destination, std::ios::app);
+        f << line.str();
+    }
+}
+
+}  // namespace
+
+bool compile_timing_enabled() {
+    return !compile_timing_destination().empty();
+}
+
+int64_t count_ir_nodes(const Stmt &s) {
+    if (!s.defined()) return 0;
+    CountIRNodes counter;
+    counter.include(s);
+    return counter.count();
+}
+
+CompileTimer::CompileTimer(const string &module_name, const string &stage) :
+    module_name(module_name), stage(stage), start(0), enabled(compile_timing_enabled()) {
+    if (enabled) {
+        start = now();
+    }
+}
+
+void CompileTimer::mark(const string &pass, const Stmt &s) {
+    if (!enabled) return;
+    double seconds = now() - start;
+    // Counting the nodes takes time too, so don't charge it to the
+    // next pass.
+    report(module_name, stage, pass, seconds, count_ir_nodes(s));
+    start = now();
+}
+
+void CompileTimer::mark(const string &pass) {
+    if (!enabled) return;
+    double seconds = now() - start;
+    report(module_name, stage, pass, seconds, -1);
+    start = now();
+}
+
+}
+}
@@ -0,0 +1,63 @@
+#ifndef HALIDE_COMPILE_TIMING_H
+#define HALIDE_COMPILE_TIMING_H
+
+/** \file
+ * Defines tools for measuring how long each stage of compilation takes.
+ */
+
+#include <string>
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Returns true if compile-time instrumentation is on. It is turned on
+ * by setting the environment variable HL_COMPILE_TIMING to the name of
+ * a file, or to "stderr". Every timed stage of compilation then
+ * appends one line of JSON to that file, of the form:
+ *
+ \code
+ {"module": "f", "stage": "lower", "pass": "sliding window", "seconds": 0.0012, "ir_nodes": 345}
+ \endcode
+ *
+ * "ir_nodes" is the number of distinct IR nodes in the Stmt after the
+ * pass, or -1 for stages (such as LLVM passes) that don't operate on
+ * Halide IR. Lines from concurrent compilations may be interleaved,
+ * but each line is written atomically. */
+EXPORT bool compile_timing_enabled();
+
+/** Count the distinct IR nodes in a Stmt. Shared subexpressions are
+ * counted once. */
+EXPORT int64_t count_ir_nodes(const Stmt &s);
+
+/** Times a sequence of compilation passes. Each call to mark() records
+ * the time since the previous mark (or since construction), and
+ * restarts the clock. When compile timing is off, mark() does
+ * nothing, so it is cheap to leave in place:
+ *
+ \code
+ CompileTimer timer(pipeline_name, "lower");
+ s = sliding_window(s, env);
+ timer.mark("sliding window", s);
+ \endcode
+ */
+class CompileTimer {
+    std::string module_name, stage;
+    double start;
+    bool enabled;
+
+public:
+    EXPORT CompileTimer(const std::string &module_name, const std::string &stage);
+
+    /** Record the time taken by a pass that produced the Stmt s. */
+    EXPORT void mark(const std::string &pass, const Stmt &s);
+
+    /** Record the time taken by a pass that doesn't produce Halide IR. */
+    EXPORT void mark(const std::string &pass);
+};
+
+}
+}
+
+#endif
@@ -14,6 +14,51 @@ using std::map;
 using std::vector;
 using std::ostringstream;
 
+namespace {
+
+// The type codes understood by halide_debug_to_file.
+int debug_to_file_type_code(Type t) {
+    if (t == Float(32)) {
+        return 0;
+    } else if (t == Float(64)) {
+        return 1;
+    } else if (t == UInt(8) || t == UInt(1)) {
+        return 2;
+    } else if (t == Int(8)) {
+        return 3;
+    } else if (t == UInt(16)) {
+        return 4;
+    } else if (t == Int(16)) {
+        return 5;
+    } else if (t == UInt(32)) {
+        return 6;
+    } else if (t == Int(32)) {
+        return 7;
+    } else if (t == UInt(64)) {
+        return 8;
+    } else if (t == Int(64)) {
+        return 9;
+    } else {
+        user_error << "Type " << t << " not supported for debug_to_file\n";
+        return 0;
+    }
+}
+
+// The file that value 'idx' of a Tuple-valued Func is written
+// to. The index is inserted before the extension, so that the
+// format is still recognized: "foo.tiff" becomes "foo.1.tiff".
+string tuple_element_filename(const string &filename, int idx) {
+    size_t dot = filename.rfind('.');
+    size_t slash = filename.find_last_of("/\\");
+    string suffix = "." + std::to_string(idx);
+    if (dot == string::npos || (slash != string::npos && dot < slash)) {
+        return filename + suffix;
+    }
+    return filename.substr(0, dot) + suffix + filename.substr(dot);
+}
+
+}  // namespace
+
 class DebugToFile : public IRMutator {
     const map<string, Function> &env;
 
@@ -23,62 +68,39 @@ class DebugToFile : public IRMutator {
         map<string, Function>::const_iterator iter = env.find(op->name);
         if (iter != env.end() && !iter->second.debug_file().empty()) {
             Function f = iter->second;
-            vector<Expr> args;
-
-            user_assert(op->types.size() == 1)
-                << "debug_to_file doesn't handle functions with multiple values yet\n";
-
-            // The name of the file
-            args.push_back(f.debug_file());
-
-            // Inject loads to the corners of the function so that any
-            // passes doing further analysis of buffer use understand
-            // what we're doing (e.g. so we trigger a copy-back from a
-            // device pointer).
-            Expr num_elements = 1;
-            for (size_t i = 0; i < op->bounds.size(); i++) {
-                num_elements *= op->bounds[i].extent;
-            }
-
-            int type_code = 0;
-            Type t = op->types[0];
-            if (t == Float(32)) {
-                type_code = 0;
-            } else if (t == Float(64)) {
-                type_code = 1;
-            } else if (t == UInt(8) || t == UInt(1)) {
-                type_code = 2;
-            } else if (t == Int(8)) {
-                type_code = 3;
-            } else if (t == UInt(16)) {
-                type_code = 4;
-            } else if (t == Int(16)) {
-                type_code = 5;
-            } else if (t == UInt(32)) {
-                type_code = 6;
-            } else if (t == Int(32)) {
-                type_code = 7;
-            } else if (t == UInt(64)) {
-                type_code = 8;
-            } else if (t == Int(64)) {
-                type_code = 9;
-            } else {
-                user_error << "Type " << t << " not supported for debug_to_file\n";
+            found = true;
+
+            Stmt body = mutate(op->body);
+
+            // Tuple-valued Funcs have one buffer per value. Dump each
+            // to its own file.
+            for (size_t i = 0; i < op->types.size(); i++) {
+                string filename = f.debug_file();
+                string buffer_name = f.name();
+                if (op->types.size() > 1) {
+                    filename = tuple_element_filename(filename, (int)i);
+                    buffer_name += "." + std::to_string(i);
+                }
+
+                vector<Expr> args;
+
+                // The name of the file
+                args.push_back(filename);
+                args.push_back(debug_to_file_type_code(op->types[i]));
+
+                Expr buf = Variable::make(Handle(), buffer_name + ".buffer");
+                args.push_back(buf);
+
+                Expr call = Call::make(Int(32), Call::debug_to_file, args, Call::Intrinsic);
+                string call_result_name = unique_name("debug_to_file_result");
+                Expr call_result_var = Variable::make(Int(32), call_result_name);
+                Stmt dump = AssertStmt::make(call_result_var == 0,
+                                             Call::make(Int(32), "halide_error_debug_to_file_failed",
+                                                        {f.name(), filename, call_result_var},
+                                                        Call::Extern));
+                dump = LetStmt::make(call_result_name, call, dump);
+                body = Block::make(body, dump);
             }
-            args.push_back(type_code);
-
-            Expr buf = Variable::make(Handle(), f.name() + ".buffer");
-            args.push_back(buf);
-
-            Expr call = Call::make(Int(32), Call::debug_to_file, args, Call::Intrinsic);
-            string call_result_name = unique_name("debug_to_file_result");
-            Expr call_result_var = Variable::make(Int(32), call_result_name);
-            Stmt body = AssertStmt::make(call_result_var == 0,
-                                         Call::make(Int(32), "halide_error_debug_to_file_failed",
-                                                    {f.name(), f.debug_file(), call_result_var},
-                                                    Call::Extern));
-            body = LetStmt::make(call_result_name, call, body);
-            body = Block::make(mutate(op->body), body);
 
             stmt = Realize::make(op->name, op->types, op->bounds, op->condition, body);
 
@@ -88,6 +110,8 @@ class DebugToFile : public IRMutator {
     }
 
 public:
+    bool found = false;
+
     DebugToFile(const map<string, Function> &e) : env(e) {}
 };
 
@@ -122,7 +146,18 @@ Stmt debug_to_file(Stmt s, const vector<Function> &outputs, const map<string, Fu
         }
         s = Realize::make(out.name(), out.output_types(), output_bounds, const_true(), s);
     }
-    s = DebugToFile(env).mutate(s);
+    DebugToFile injector(env);
+    s = injector.mutate(s);
+
+    if (injector.found) {
+        // The runtime may write the files in the background. Make sure
+        // they are all complete before the pipeline returns.
+        Expr flush = Call::make(Int(32), "halide_debug_to_file_flush", {}, Call::Extern);
+        string flush_result_name = unique_name("debug_to_file_flush_result");
+        Expr flush_result_var = Variable::make(Int(32), flush_result_name);
+        Stmt check = AssertStmt::make(flush_result_var == 0, flush_result_var);
+        s = Block::make(s, LetStmt::make(flush_result_name, flush, check));
+    }
 
     // Remove the realize node we wrapped around the output
     s = RemoveDummyRealizations(outputs).mutate(s);
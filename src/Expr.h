@@ -74,7 +74,7 @@ struct IRNode {
      * visitors.
      */
     virtual void accept(IRVisitor *v) const = 0;
-    IRNode() {}
+    IRNode() : structural_hash(0) {}
     virtual ~IRNode() {}
 
     /** These classes are all managed with intrusive reference
@@ -83,6 +83,12 @@ struct IRNode {
        references to IR nodes. */
     mutable RefCount ref_count;
 
+    /** A hash of the value of this node and everything below it,
+     * filled in the first time it is asked for (see structural_hash
+     * in IREquality.h). Zero means it hasn't been computed yet. IR
+     * nodes are not modified once built, so it never goes stale. */
+    mutable std::atomic<uint64_t> structural_hash;
+
     /** Each IR node subclass should return some unique pointer. We
      * can compare these pointers to do runtime type
      * identification. We don't compile with rtti because that
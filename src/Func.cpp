@@ -2,6 +2,8 @@
 #include <iostream>
 #include <string.h>
 #include <fstream>
+#include <functional>
+#include <sstream>
 
 #ifdef _MSC_VER
 #include <intrin.h>
@@ -31,6 +33,7 @@
 #include "Associativity.h"
 #include "ApplySplit.h"
 #include "ImageParam.h"
+#include "InferArguments.h"
 
 namespace Halide {
 
@@ -903,6 +906,340 @@ Func Stage::rfactor(vector<pair<RVar, Var>> preserved) {
     return intm;
 }
 
+namespace {
+
+// Replace the self-references of a scan, which load from the previous
+// point of the scan, with loads from the point being stored to. This puts
+// the update definition in the form prove_associativity expects. Any
+// other self-reference means the definition is not a scan.
+class ReplaceScanRecurrence : public IRMutator {
+    using IRMutator::visit;
+
+    const string &func;
+    const vector<Expr> &prev_args, &store_args;
+
+    void visit(const Call *op) {
+        IRMutator::visit(op);
+        op = expr.as<Call>();
+        if (op && op->call_type == Call::Halide && op->name == func) {
+            bool is_prev = op->args.size() == prev_args.size();
+            for (size_t i = 0; is_prev && i < op->args.size(); i++) {
+                is_prev = can_prove(op->args[i] == prev_args[i]);
+            }
+            if (is_prev) {
+                expr = Call::make(op->type, op->name, store_args, op->call_type,
+                                  op->func, op->value_index, op->image, op->param);
+            } else {
+                is_scan = false;
+            }
+        }
+    }
+
+public:
+    bool is_scan = true;
+
+    ReplaceScanRecurrence(const string &func, const vector<Expr> &prev_args, const vector<Expr> &store_args)
+        : func(func), prev_args(prev_args), store_args(store_args) {}
+};
+
+// Decompose e as a*x + b, where neither a nor b depends on the
+// variable x. Returns false if e isn't of that form.
+bool affine_in_var(const Expr &e, const string &x, Expr &a, Expr &b) {
+    if (!expr_uses_var(e, x)) {
+        a = make_zero(e.type());
+        b = e;
+        return true;
+    } else if (e.as<Variable>()) {
+        a = make_one(e.type());
+        b = make_zero(e.type());
+        return true;
+    }
+
+    Expr a1, b1, a2, b2;
+    if (const Add *op = e.as<Add>()) {
+        if (affine_in_var(op->a, x, a1, b1) && affine_in_var(op->b, x, a2, b2)) {
+            a = a1 + a2;
+            b = b1 + b2;
+            return true;
+        }
+    } else if (const Sub *op = e.as<Sub>()) {
+        if (affine_in_var(op->a, x, a1, b1) && affine_in_var(op->b, x, a2, b2)) {
+            a = a1 - a2;
+            b = b1 - b2;
+            return true;
+        }
+    } else if (const Mul *op = e.as<Mul>()) {
+        if (!expr_uses_var(op->a, x) && affine_in_var(op->b, x, a2, b2)) {
+            a = op->a * a2;
+            b = op->a * b2;
+            return true;
+        } else if (!expr_uses_var(op->b, x) && affine_in_var(op->a, x, a1, b1)) {
+            a = a1 * op->b;
+            b = b1 * op->b;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+Func Stage::scan_parallel(RVar r, Expr block_size) {
+    user_assert(!definition.is_init()) << "scan_parallel() must be called on an update definition\n";
+
+    string func_name;
+    {
+        vector<std::string> tmp = split_string(stage_name, ".update(");
+        internal_assert(!tmp.empty() && !tmp[0].empty());
+        func_name = tmp[0];
+    }
+
+    vector<Expr> &args = definition.args();
+    vector<Expr> &values = definition.values();
+    const vector<ReductionVariable> &rvars = definition.schedule().rvars();
+
+    user_assert(rvars.size() == 1 && var_name_match(rvars[0].var, r.name()))
+        << "In schedule for " << stage_name
+        << ", can't perform scan_parallel() on " << r.name()
+        << " since it is not the only dimension of the reduction domain\n"
+        << dump_argument_list();
+    user_assert(definition.schedule().splits().empty())
+        << "In schedule for " << stage_name
+        << ", scan_parallel() must be called before any splits\n"
+        << dump_argument_list();
+    user_assert(!definition.predicate().defined() || is_one(definition.predicate()))
+        << "In schedule for " << stage_name
+        << ", can't perform scan_parallel() on a reduction domain with a predicate\n";
+
+    const string &r_name = rvars[0].var;
+    Expr r_min = rvars[0].min;
+    Expr r_extent = rvars[0].extent;
+
+    // Find the dimension the scan runs along. The other args must be the
+    // pure Vars of the Func.
+    int dim = -1;
+    for (size_t i = 0; i < args.size(); i++) {
+        const Variable *v = args[i].as<Variable>();
+        if (v && v->name == r_name) {
+            dim = i;
+        } else {
+            user_assert(v && v->name == dim_vars[i].name())
+                << "In schedule for " << stage_name
+                << ", can't perform scan_parallel() since argument " << i
+                << " is " << args[i] << " instead of the pure Var "
+                << dim_vars[i].name() << "\n";
+        }
+    }
+    user_assert(dim != -1)
+        << "In schedule for " << stage_name
+        << ", can't perform scan_parallel() since " << r.name()
+        << " is not one of the arguments\n";
+
+    // Args with the scan dimension replaced.
+    auto args_at = [&](const vector<Var> &vars, Expr x) {
+        vector<Expr> result(vars.begin(), vars.end());
+        result[dim] = x;
+        return result;
+    };
+
+    // The update definition must be a recurrence f(r) = op(f(r - 1), g(r))
+    // with an associative op.
+    vector<Expr> prev_args = args;
+    prev_args[dim] = args[dim] - 1;
+    ReplaceScanRecurrence replacer(func_name, prev_args, args);
+    vector<Expr> replaced(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        replaced[i] = replacer.mutate(values[i]);
+    }
+    user_assert(replacer.is_scan)
+        << "In schedule for " << stage_name
+        << ", can't perform scan_parallel() since the update refers to "
+        << func_name << " at points other than the previous point along "
+        << r.name() << "\n";
+
+    // The elements of the scan, as functions of r, the associative op
+    // that combines two (possibly Tuple) elements, and its identity.
+    vector<Expr> elements, identities;
+    std::function<vector<Expr>(const vector<Expr> &, const vector<Expr> &)> apply_op;
+
+    // A linear recurrence f(r) = a(r)*f(r - 1) + b(r) isn't an
+    // associative op on the values, but composing the affine maps
+    // x -> a*x + b is: applying (a1, b1) and then (a2, b2) gives
+    // (a1*a2, a2*b1 + b2). Such scans use the pairs as the elements,
+    // and apply the result to the value before the scan at the end.
+    bool linear = false;
+
+    const auto &prover_result = prove_associativity(func_name, args, replaced);
+    if (prover_result.associative()) {
+        internal_assert(prover_result.size() == values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            user_assert(!prover_result.xs[i].var.empty())
+                << "Failed to call scan_parallel() on " << stage_name
+                << " since it doesn't depend on the previous value\n";
+            elements.push_back(prover_result.ys[i].expr);
+            identities.push_back(prover_result.pattern.identities[i]);
+        }
+        apply_op = [&](const vector<Expr> &a, const vector<Expr> &b) {
+            map<string, Expr> replacement;
+            for (size_t i = 0; i < values.size(); i++) {
+                replacement.emplace(prover_result.xs[i].var, a[i]);
+                replacement.emplace(prover_result.ys[i].var, b[i]);
+            }
+            vector<Expr> result(values.size());
+            for (size_t i = 0; i < values.size(); i++) {
+                result[i] = substitute(replacement, prover_result.pattern.ops[i]);
+            }
+            return result;
+        };
+    } else {
+        Expr a, b;
+        if (values.size() == 1) {
+            Type t = values[0].type();
+            Expr prev = Variable::make(t, unique_name("prev"));
+            Expr e = substitute(Call::make(t, func_name, args, Call::Halide, nullptr, 0),
+                                prev, replaced[0]);
+            if (affine_in_var(e, prev.as<Variable>()->name, a, b)) {
+                a = simplify(a);
+                b = simplify(b);
+            } else {
+                a = Expr();
+            }
+        }
+        user_assert(a.defined())
+            << "Failed to call scan_parallel() on " << stage_name
+            << " since it can't prove associativity of the operator, and the update"
+            << " is not a linear recurrence\n";
+        user_assert(!is_zero(a))
+            << "Failed to call scan_parallel() on " << stage_name
+            << " since it doesn't depend on the previous value\n";
+        linear = true;
+        elements = {a, b};
+        identities = {make_one(a.type()), make_zero(a.type())};
+        apply_op = [](const vector<Expr> &x, const vector<Expr> &y) {
+            return vector<Expr>{x[0] * y[0], y[0] * x[1] + y[1]};
+        };
+    }
+    const size_t num_elements = elements.size();
+
+    auto call = [&](Function f, const vector<Expr> &call_args) {
+        vector<Expr> result(num_elements);
+        for (size_t i = 0; i < num_elements; i++) {
+            result[i] = Call::make(f, call_args, i);
+        }
+        return result;
+    };
+
+    Var ri(unique_name(r.name() + "_i"));
+    Var rb(unique_name(r.name() + "_b"));
+    Expr num_blocks = (r_extent + block_size - 1) / block_size;
+
+    // The up-sweep: scan each block of the domain independently. For
+    // example, if we have the following Func f:
+    //   f(x) = 0
+    //   f(r) = f(r - 1) + g(r)
+    // Calling f.update(0).scan_parallel(r, B) will generate:
+    //   f_scan(ri, rb) = 0
+    //   f_scan(s, rb) = f_scan(s - 1, rb) + g(r.min + rb*B + s)
+    // where s is in [0, B). The tail of the last block is clamped to the
+    // domain, and never used.
+    vector<Var> scan_args = dim_vars;
+    scan_args[dim] = ri;
+    scan_args.push_back(rb);
+
+    Func scan(func_name + "_scan");
+    scan(scan_args) = Tuple(identities);
+    RDom s(0, block_size, func_name + "_scan_r");
+    {
+        vector<Expr> update_args = args_at(dim_vars, s);
+        update_args.push_back(rb);
+        vector<Expr> load_args = args_at(dim_vars, s - 1);
+        load_args.push_back(rb);
+
+        Expr r_clamped = min(r_min + rb * block_size + s, r_min + r_extent - 1);
+        vector<Expr> ys(num_elements);
+        for (size_t i = 0; i < num_elements; i++) {
+            ys[i] = substitute(r_name, r_clamped, elements[i]);
+        }
+        scan(update_args) = Tuple(apply_op(call(scan.function(), load_args), ys));
+    }
+
+    // The down-sweep: the prefix of the block totals, which is the carry
+    // into each block:
+    //   f_carry(rb) = 0
+    //   f_carry(c) = f_carry(c - 1) + f_scan(B - 1, c - 1)
+    // where c is in [1, num_blocks).
+    Func carry(func_name + "_carry");
+    carry(args_at(dim_vars, rb)) = Tuple(identities);
+    RDom c(1, num_blocks - 1, func_name + "_carry_r");
+    {
+        vector<Expr> block_total_args = args_at(dim_vars, block_size - 1);
+        block_total_args.push_back(c - 1);
+        carry(args_at(dim_vars, c)) =
+            Tuple(apply_op(call(carry.function(), args_at(dim_vars, c - 1)),
+                           call(scan.function(), block_total_args)));
+    }
+
+    // Replace the update definition with one that combines the value
+    // before the scan, the carry into the block, and the scan within the
+    // block:
+    //   f(r) = f(r.min - 1) + (f_carry(rb) + f_scan(ri, rb))
+    // Unlike the original, this only loads from a point it doesn't store
+    // to, so it can be computed in parallel.
+    {
+        Expr offset = args[dim] - r_min;
+        Expr b = offset / block_size;
+        vector<Expr> scan_load_args = args_at(dim_vars, offset % block_size);
+        scan_load_args.push_back(b);
+
+        vector<Expr> before_args = args;
+        before_args[dim] = r_min - 1;
+        vector<Expr> before(values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            before[i] = Call::make(values[i].type(), func_name, before_args,
+                                   Call::CallType::Halide, nullptr, i);
+        }
+
+        vector<Expr> block = apply_op(call(carry.function(), args_at(dim_vars, b)),
+                                      call(scan.function(), scan_load_args));
+        vector<Expr> f_values;
+        if (linear) {
+            f_values = {block[0] * before[0] + block[1]};
+        } else {
+            f_values = apply_op(before, block);
+        }
+        values.swap(f_values);
+    }
+
+    // Schedule the up-sweep in parallel over blocks, and both sweeps with
+    // the other dimensions innermost.
+    vector<VarOrRVar> scan_order, carry_order, f_order;
+    for (size_t i = 0; i < dim_vars.size(); i++) {
+        if ((int)i != dim) {
+            scan_order.push_back(dim_vars[i]);
+            carry_order.push_back(dim_vars[i]);
+            f_order.push_back(dim_vars[i]);
+        }
+    }
+    scan.compute_root();
+    scan_order.push_back(s.x);
+    scan_order.push_back(rb);
+    scan.update(0).reorder(scan_order).parallel(rb);
+
+    carry.compute_root();
+    carry_order.push_back(c.x);
+    carry.update(0).reorder(carry_order);
+
+    RVar r_outer(r.name() + "_o"), r_inner(r.name() + "_i");
+    f_order.push_back(r_inner);
+    f_order.push_back(r_outer);
+    allow_race_conditions();
+    split(r, r_outer, r_inner, block_size, TailStrategy::GuardWithIf)
+        .reorder(f_order)
+        .parallel(r_outer);
+
+    return scan;
+}
+
 void Stage::split(const string &old, const string &outer, const string &inner, Expr factor, bool exact, TailStrategy tail) {
     debug(4) << "In schedule for " << stage_name << ", split " << old << " into "
              << outer << " and " << inner << " with factor of " << factor << "\n";
@@ -1003,9 +1340,9 @@ void Stage::split(const string &old, const string &outer, const string &inner, E
     }
 
     if (exact) {
-        user_assert(tail == TailStrategy::GuardWithIf)
+        user_assert(tail == TailStrategy::GuardWithIf || tail == TailStrategy::Predicate)
             << "When splitting Var " << old_name
-            << " the tail strategy must be GuardWithIf or Auto. "
+            << " the tail strategy must be GuardWithIf, Predicate, or Auto. "
             << "Anything else may change the meaning of the algorithm\n";
     }
 
@@ -1882,6 +2219,12 @@ Func &Func::memoize() {
     return *this;
 }
 
+Func &Func::lookup_strategy(LookupStrategy strategy) {
+    invalidate_cache();
+    func.schedule().lookup_strategy() = strategy;
+    return *this;
+}
+
 Stage Func::specialize(Expr c) {
     invalidate_cache();
     return Stage(func.definition(), name(), args(), func.schedule().storage_dims()).specialize(c);
@@ -1892,6 +2235,99 @@ void Func::specialize_fail(const std::string &message) {
     (void) Stage(func.definition(), name(), args(), func.schedule().storage_dims()).specialize_fail(message);
 }
 
+Stage Func::specialize_from_profile(const std::string &profile_file,
+                                    const std::string &pipeline_name,
+                                    float min_fraction) {
+    std::ifstream in(profile_file);
+    user_assert(in.is_open()) << "Could not open profile " << profile_file << "\n";
+
+    // The params this Func can specialize on.
+    map<string, Parameter> params;
+    for (const InferredArgument &arg : Internal::infer_arguments(Stmt(), {func})) {
+        if (arg.param.defined()) {
+            params[arg.param.name()] = arg.param;
+        }
+    }
+    for (Parameter p : func.output_buffers()) {
+        params[p.name()] = p;
+    }
+
+    Expr condition;
+    string line;
+    int num_pipelines = 0;
+    bool found = false;
+    int64_t runs = 0;
+    while (std::getline(in, line)) {
+        std::istringstream tokens(line);
+        string kind, arg_name;
+        tokens >> kind >> arg_name;
+        if (kind == "pipeline") {
+            num_pipelines++;
+            user_assert(!pipeline_name.empty() || num_pipelines == 1)
+                << "Profile " << profile_file << " contains several pipelines. "
+                << "Pass the name of the one to use to specialize_from_profile.\n";
+            bool selected = pipeline_name.empty() || arg_name == pipeline_name;
+            found = found || selected;
+            runs = 0;
+            if (selected) {
+                tokens >> runs;
+            }
+            continue;
+        }
+        if (kind != "arg" || runs <= 0) continue;
+
+        // Find the most frequent value.
+        int64_t value = 0;
+        uint64_t count = 0;
+        string entry;
+        while (tokens >> entry) {
+            size_t colon = entry.find(':');
+            user_assert(colon != string::npos)
+                << "Malformed line in profile " << profile_file << ": " << line << "\n";
+            uint64_t c = std::stoull(entry.substr(colon + 1));
+            if (c > count) {
+                count = c;
+                value = std::stoll(entry.substr(0, colon));
+            }
+        }
+        if (count < min_fraction * runs) continue;
+
+        // Scalar args are named after their param. Buffer fields are
+        // named <buffer>.min.<dim>, <buffer>.extent.<dim>, or
+        // <buffer>.stride.<dim>.
+        Expr var;
+        auto it = params.find(arg_name);
+        if (it != params.end() && !it->second.is_buffer()) {
+            var = Variable::make(it->second.type(), arg_name, it->second);
+        } else {
+            size_t dim_dot = arg_name.rfind('.');
+            size_t field_dot = dim_dot == string::npos ? string::npos : arg_name.rfind('.', dim_dot - 1);
+            if (field_dot != string::npos && field_dot > 0) {
+                it = params.find(arg_name.substr(0, field_dot));
+                if (it != params.end() && it->second.is_buffer()) {
+                    var = Variable::make(Int(32), arg_name, it->second);
+                }
+            }
+        }
+        if (!var.defined()) continue;
+
+        Expr c = (var == make_const(var.type(), value));
+        condition = condition.defined() ? (condition && c) : c;
+    }
+
+    user_assert(found)
+        << "Profile " << profile_file << " contains no pipeline"
+        << (pipeline_name.empty() ? "" : " named " + pipeline_name) << "\n";
+
+    if (!condition.defined()) {
+        user_warning << "Profile " << profile_file << " shows no dominant argument values for "
+                     << name() << ". Not specializing it.\n";
+        return Stage(func.definition(), name(), args(), func.schedule().storage_dims());
+    }
+    debug(1) << "Specializing " << name() << " from profile on " << condition << "\n";
+    return specialize(condition);
+}
+
 Func &Func::serial(VarOrRVar var) {
     invalidate_cache();
     Stage(func.definition(), name(), args(), func.schedule().storage_dims()).serial(var);
@@ -168,6 +168,47 @@ public:
     EXPORT Func rfactor(RVar r, Var v);
     // @}
 
+    /** Calling scan_parallel() on an update definition that is an associative
+     * recurrence along the RVar r, such as f(r) = f(r - 1) + g(r), rewrites it
+     * as a blocked parallel prefix scan. The domain of r is divided into
+     * blocks of block_size points, and the scan is computed in three passes:
+     * an intermediate Func holding the scan of each block, computed in
+     * parallel over blocks; a serial scan of the block totals, giving the
+     * carry into each block; and a new update definition that combines the
+     * carry with the scan within each block, computed in parallel over
+     * blocks of r. The reduction domain must have r as its only dimension,
+     * and the other args must be the pure Vars of the Func. The operator must
+     * be associative, but need not be commutative.
+     *
+     * Linear recurrences f(r) = a(r) * f(r - 1) + b(r), such as a first-order
+     * IIR filter, are also supported, even though the op isn't associative on
+     * the values. The intermediates then hold the pairs (a, b) of the affine
+     * maps from the value before each block, which compose associatively.
+     *
+     * For example, a column-wise summed-area table:
+     \code
+     f(x, y) = 0;
+     f(x, r) = f(x, r - 1) + in(x, r);
+     f.update(0).scan_parallel(r, 256);
+     \endcode
+     * is rewritten to:
+     \code
+     f_scan(x, ri, rb) = 0;
+     f_scan(x, s, rb) = f_scan(x, s - 1, rb) + in(x, min(rb*256 + s, r.extent - 1));
+     f_carry(x, rb) = 0;
+     f_carry(x, c) = f_carry(x, c - 1) + f_scan(x, 255, c - 1);
+     f(x, r) = f(x, -1) + (f_carry(x, r / 256) + f_scan(x, r % 256, r / 256));
+     \endcode
+     * where s is in [0, 256) and c is in [1, number of blocks). This does
+     * about twice the work of the serial scan, but scales across cores.
+     *
+     * Both intermediates are computed at root, with x innermost, and the
+     * update definition is split by block_size and parallelized. The
+     * returned Func is the scan of each block, which can be rescheduled,
+     * e.g. to vectorize across x.
+     */
+    EXPORT Func scan_parallel(RVar r, Expr block_size = 1024);
+
     /** Scheduling calls that control how the domain of this stage is
      * traversed. See the documentation for Func for the meanings. */
     // @{
@@ -859,8 +900,10 @@ public:
      * debugging.
      *
      * If filename ends in ".tif" or ".tiff" (case insensitive) the file
-     * is in TIFF format and can be read by standard tools. Oherwise, the
-     * file format is as follows:
+     * is in TIFF format and can be read by standard tools. If it ends
+     * in ".npy", the file is a numpy array, stored in Fortran order so
+     * that numpy.load(filename)[x, y] is the value at f(x, y).
+     * Oherwise, the file format is as follows:
      *
      * All data is in the byte-order of the target platform.  First, a
      * 20 byte-header containing four 32-bit ints, giving the extents
@@ -871,7 +914,16 @@ public:
      * 5, uint32_t = 6, int32_t = 7, uint64_t = 8, int64_t = 9. The
      * data follows the header, as a densely packed array of the given
      * size and the given type. If given the extension .tmp, this file
-     * format can be natively read by the program ImageStack. */
+     * format can be natively read by the program ImageStack.
+     *
+     * Tuple-valued Funcs write one file per value, with the index of
+     * the value inserted before the extension: "f.tiff" becomes
+     * "f.0.tiff", "f.1.tiff", etc.
+     *
+     * If the environment variable HL_DEBUG_TO_FILE_ASYNC is set to 1
+     * when the pipeline runs, each realization is copied to a staging
+     * buffer and written on a background thread. All writes are
+     * complete by the time the pipeline returns. */
     EXPORT void debug_to_file(const std::string &filename);
 
     /** The name of this function, either given during construction,
@@ -1451,6 +1503,28 @@ public:
      */
     EXPORT void specialize_fail(const std::string &message);
 
+    /** Specialize a Func for the argument values it was most often
+     * run with, as recorded by a previous run of the pipeline with
+     * the -profile target flag and the environment variable
+     * HL_PROFILE_ARGS_FILE set to profile_file. For each integer
+     * scalar param and each buffer min, extent, and stride, if a
+     * single value was seen in at least min_fraction of the runs,
+     * the specialization condition requires it to take that
+     * value. For example, a profile showing that an input always had
+     * a unit stride and was usually 1920 wide would be equivalent to:
+     \code
+     f.specialize(im.dim(0).stride() == 1 && im.dim(0).extent() == 1920);
+     \endcode
+     * The unspecialized definition is kept as the fallback. If the
+     * profile contains several pipelines, pipeline_name selects
+     * one. If no value was dominant, a warning is printed and no
+     * specialization is made, and the Stage returned refers to the
+     * unspecialized definition. Profiles of arguments that aren't
+     * used by this Func are ignored. */
+    EXPORT Stage specialize_from_profile(const std::string &profile_file,
+                                         const std::string &pipeline_name = "",
+                                         float min_fraction = 0.5f);
+
     /** Tell Halide that the following dimensions correspond to GPU
      * thread indices. This is useful if you compute a producer
      * function within the block indices of a consumer function, and
@@ -1801,6 +1875,17 @@ public:
      */
     EXPORT Func &memoize();
 
+    /** Control how vectorized loads from this function at
+     * data-dependent indices are generated. If this function is a
+     * small lookup table, e.g. a gamma curve over 4-bit or 8-bit
+     * values, then with LookupStrategy::Auto (the default) the table
+     * is held in vector registers and indexed with shuffle
+     * instructions when the compiler can prove the indices lie in a
+     * range the target handles cheaply. LookupStrategy::Shuffle
+     * forces this for any table of up to 256 elements, and
+     * LookupStrategy::Gather forbids it. */
+    EXPORT Func &lookup_strategy(LookupStrategy strategy);
+
 
     /** Allocate storage for this function within f's loop over
      * var. Scheduling storage is optional, and can be used to
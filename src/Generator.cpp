@@ -2,9 +2,11 @@
 #include <fstream>
 #include <set>
 
+#include "BatchEntryPoint.h"
 #include "Generator.h"
 #include "Outputs.h"
 #include "Simplify.h"
+#include "TrustedEntryPoint.h"
 
 namespace Halide {
 namespace Internal {
@@ -51,6 +53,25 @@ std::string get_extension(const std::string& def, const GeneratorBase::EmitOptio
     return def;
 }
 
+// Write a main() that benchmarks the filter, using the generic driver in
+// tools/halide_benchmark_main.h. The driver gets everything else it needs
+// from the filter's metadata.
+void emit_benchmark_driver(const std::string &path,
+                           const std::string &function_name,
+                           const std::string &header_path) {
+    std::string header_name = header_path.substr(header_path.find_last_of('/') + 1);
+    std::ofstream file(path);
+    user_assert(file.is_open()) << "Unable to open " << path << " for writing\n";
+    file << "// Benchmark driver for " << function_name << ", generated by GenGen.\n"
+         << "#include \"" << header_name << "\"\n"
+         << "#include \"halide_benchmark_main.h\"\n"
+         << "\n"
+         << "int main(int argc, char **argv) {\n"
+         << "    return Halide::Tools::benchmark_main(argc, argv, "
+         << function_name << "_argv, " << function_name << "_metadata());\n"
+         << "}\n";
+}
+
 Outputs compute_outputs(const Target &target,
                         const std::string &base_path,
                         const GeneratorBase::EmitOptions &options) {
@@ -287,7 +308,8 @@ private:
     std::vector<Internal::GeneratorParamBase *> filter_params(const std::vector<Internal::GeneratorParamBase *> &in) {
         std::vector<Internal::GeneratorParamBase *> out;
         for (auto p : in) {
-            if (p->name == "target") continue;
+            if (p->name == "target" || p->name == "batch_entry_point" ||
+                p->name == "trusted_entry_point") continue;
             if (p->is_synthetic_param()) continue;
             out.push_back(p);
         }
@@ -782,7 +804,9 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
     const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] "
                           "target=target-string[,target-string...] [generator_arg=value [...]]\n\n"
                           "  -e  A comma separated list of files to emit. Accepted values are "
-                          "[assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub]. If omitted, default value is [static_library, h].\n"
+                          "[assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub, benchmark]. If omitted, default value is [static_library, h].\n"
+                          "      \"benchmark\" emits a .benchmark.cpp containing a main() that times the filter on synthesized inputs; "
+                          "build it against the static_library and h.\n"
                           "  -x  A comma separated list of file extension pairs to substitute during file naming, "
                           "in the form [.old=.new[,.old2=.new2]]\n";
 
@@ -896,9 +920,11 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                 emit_options.emit_static_library = true;
             } else if (opt == "cpp_stub") {
                 emit_options.emit_cpp_stub = true;
+            } else if (opt == "benchmark") {
+                emit_options.emit_benchmark = true;
             } else if (!opt.empty()) {
                 cerr << "Unrecognized emit option: " << opt
-                     << " not one of [assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub], ignoring.\n";
+                     << " not one of [assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub, benchmark], ignoring.\n";
             }
         }
     }
@@ -958,6 +984,14 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                     return gen->build_module(name);
                 };
             if (targets.size() > 1 || !emit_options.substitutions.empty()) {
+                // The extra entry points are added per target by
+                // build_module(), so the multitarget wrapper wouldn't
+                // expose them.
+                for (const char *param : {"batch_entry_point", "trusted_entry_point"}) {
+                    auto it = generator_args.find(param);
+                    user_assert(it == generator_args.end() || it->second != "true")
+                        << "The GeneratorParam " << param << " is not supported with multiple targets.\n";
+                }
                 compile_multitarget(function_name, output_files, targets, module_producer, emit_options.substitutions);
             } else {
                 user_assert(emit_options.substitutions.empty()) << "substitutions not supported for single-target";
@@ -965,6 +999,11 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                 // so defer directly to Module::compile if there is a single target.
                 module_producer(function_name, targets[0]).compile(output_files);
             }
+            if (emit_options.emit_benchmark) {
+                emit_benchmark_driver(base_path + get_extension(".benchmark.cpp", emit_options),
+                                      function_name,
+                                      base_path + get_extension(".h", emit_options));
+            }
         }
     }
 
@@ -1433,6 +1472,77 @@ Module GeneratorBase::build_module(const std::string &function_name,
     }
 
     Module result = pipeline.compile_to_module(filter_arguments, function_name, target, linkage_type);
+
+    // Compile another version of the pipeline called name, and add it
+    // to the module, with the wrappers for any extern stages it calls
+    // but not its legacy buffer_t wrapper.
+    auto append_variant = [&](const std::string &name, const Target &t,
+                              LoweredFunc::LinkageType linkage) {
+        Module variant = pipeline.compile_to_module(filter_arguments, name, t, linkage);
+        bool found = false;
+        for (const LoweredFunc &f : variant.functions()) {
+            if ((f.name == name && !found) || starts_with(f.name, "_halide_wrapper_")) {
+                found |= (f.name == name);
+                result.append(f);
+            }
+        }
+    };
+    const Target unchecked_target = target.value().with_feature(Target::NoAsserts).with_feature(Target::NoBoundsQuery);
+
+    if (batch_entry_point) {
+        user_assert(!target.value().has_gpu_feature())
+            << "The batch entry point for " << function_name << " is not supported for GPU targets.\n";
+        // Items after the first in a batch have the same shape as the
+        // first, so they can skip the checks. Compile a version of the
+        // pipeline without them. This also drops the checks on its heap
+        // allocations. (Multitarget builds are rejected in
+        // generate_filter_main.)
+        std::vector<std::string> namespaces;
+        std::string unchecked_name = extract_namespaces(function_name, namespaces) + "_batch_item";
+        append_variant(unchecked_name, unchecked_target, LoweredFunc::Internal);
+        std::map<std::string, int> host_alignments;
+        for (auto param : pi.filter_params) {
+            if (param->is_buffer()) {
+                host_alignments[param->name()] = param->host_alignment();
+            }
+        }
+        for (auto input : pi.filter_inputs) {
+            for (const auto &p : input->parameters_) {
+                if (p.is_buffer()) {
+                    host_alignments[p.name()] = p.host_alignment();
+                }
+            }
+        }
+        for (Func f : pipeline.outputs()) {
+            for (const Parameter &p : f.function().output_buffers()) {
+                host_alignments[p.name()] = p.host_alignment();
+            }
+        }
+        add_batch_entry_point(result, result.get_function_by_name(function_name),
+                              unchecked_name, function_name + "_batch", host_alignments);
+    }
+
+    if (trusted_entry_point) {
+        const Target t = target;
+        user_assert(!t.has_gpu_feature() &&
+                    !t.has_feature(Target::Profile) &&
+                    !t.has_feature(Target::TraceLoads) &&
+                    !t.has_feature(Target::TraceStores) &&
+                    !t.has_feature(Target::TraceRealizations))
+            << "The trusted entry point for " << function_name
+            << " is not supported for GPU targets, or with tracing or profiling.\n";
+        append_variant(function_name + "_trusted", unchecked_target, LoweredFunc::External);
+        // The validation entry point is the checks from a version of
+        // the pipeline that, like the trusted one, has no bounds query.
+        std::vector<std::string> namespaces;
+        std::string checks_name = extract_namespaces(function_name, namespaces) + "_checks";
+        Module checks = pipeline.compile_to_module(filter_arguments, checks_name,
+                                                   t.with_feature(Target::NoBoundsQuery),
+                                                   LoweredFunc::External);
+        result.append(make_validation_function(checks.get_function_by_name(checks_name),
+                                               function_name + "_validate"));
+    }
+
     std::shared_ptr<ExternsMap> externs_map = get_externs_map();
     if (externs_map) {
         for (const auto &map_entry : *externs_map) {
@@ -2225,8 +2225,37 @@ class GeneratorBase : public NamesInterface, public GeneratorContext {
 public:
     GeneratorParam<Target> target{ "target", Halide::get_host_target() };
 
+    /** If true, build_module() adds a second entry point, named after the
+     * function with the suffix "_batch", that runs the pipeline over a
+     * batch of same-shaped arguments. Each of its buffer arguments has an
+     * extra outermost dimension indexing the batch. The arguments are
+     * checked once, for the first item, and the remaining items run in
+     * a single parallel loop. Note that the later items are compiled
+     * with no_asserts, which also drops the checks that the pipeline's
+     * own heap allocations succeeded, so running out of memory in one of
+     * them is not reported as an error. Each item still makes its own
+     * allocations for the pipeline's intermediate Funcs; they are not
+     * shared across the items of a batch. (Not supported for GPU
+     * targets, or with multiple targets.) */
+    GeneratorParam<bool> batch_entry_point{ "batch_entry_point", false };
+
+    /** If true, build_module() adds two more entry points, named after
+     * the function with the suffixes "_trusted" and "_validate". The
+     * trusted entry point runs the pipeline without checking its
+     * arguments and without bounds query support. The validation entry
+     * point takes the same arguments, runs only the checks, and returns
+     * zero if they pass. A caller may validate the arguments once, and
+     * then call the trusted entry point repeatedly with buffers of the
+     * same types, shapes and host alignments and the same scalar
+     * values. The trusted entry point is compiled with no_asserts, so
+     * the failure of a heap allocation inside the pipeline can't be
+     * returned as an error, and crashes instead. (Not supported for
+     * GPU targets, with tracing or profiling, or with multiple
+     * targets.) */
+    GeneratorParam<bool> trusted_entry_point{ "trusted_entry_point", false };
+
     struct EmitOptions {
-        bool emit_o, emit_h, emit_cpp, emit_assembly, emit_bitcode, emit_stmt, emit_stmt_html, emit_static_library, emit_cpp_stub;
+        bool emit_o, emit_h, emit_cpp, emit_assembly, emit_bitcode, emit_stmt, emit_stmt_html, emit_static_library, emit_cpp_stub, emit_benchmark;
         // This is an optional map used to replace the default extensions generated for
         // a file: if an key matches an output extension, emit those files with the
         // corresponding value instead (e.g., ".s" -> ".assembly_text"). This is
@@ -2236,7 +2265,7 @@ public:
         std::map<std::string, std::string> substitutions;
         EmitOptions()
             : emit_o(false), emit_h(true), emit_cpp(false), emit_assembly(false),
-              emit_bitcode(false), emit_stmt(false), emit_stmt_html(false), emit_static_library(true), emit_cpp_stub(false) {}
+              emit_bitcode(false), emit_stmt(false), emit_stmt_html(false), emit_static_library(true), emit_cpp_stub(false), emit_benchmark(false) {}
     };
 
     EXPORT virtual ~GeneratorBase();
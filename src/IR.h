@@ -500,6 +500,7 @@ struct Call : public ExprNode<Call> {
         alloca,
         likely,
         likely_if_innermost,
+        predicated_tail,
         register_destructor,
         div_round_to_zero,
         mod_round_to_zero,
@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "IREquality.h"
 #include "IRVisitor.h"
 #include "IROperator.h"
@@ -33,13 +35,23 @@ public:
      * subexpressions, it's worth passing in a cache to use.
      * Currently this is only done in common-subexpression
      * elimination. */
-    IRComparer(IRCompareCache *c = nullptr) : result(Equal), cache(c) {}
+    IRComparer(IRCompareCache *c = nullptr, bool e = false) : result(Equal), cache(c), equality_only(e) {}
 
 private:
     Expr expr;
     Stmt stmt;
     IRCompareCache *cache;
 
+    /** If we only care whether the two are equal, not how they are
+     * ordered, nodes that already have different hashes can be
+     * declared unequal immediately. */
+    bool equality_only;
+
+    bool hashes_differ(const IRNode *a, const IRNode *b) {
+        uint64_t ha = a->structural_hash, hb = b->structural_hash;
+        return equality_only && ha && hb && ha != hb;
+    }
+
     CmpResult compare_names(const std::string &a, const std::string &b);
     CmpResult compare_types(Type a, Type b);
     CmpResult compare_expr_vector(const std::vector<Expr> &a, const std::vector<Expr> &b);
@@ -130,11 +142,10 @@ IRComparer::CmpResult IRComparer::compare_expr(const Expr &a, const Expr &b) {
         return result;
     }
 
-    // If in the future we have hashes for Exprs, this is a good place
-    // to compare the hashes:
-    // if (compare_scalar(a.hash(), b.hash()) != Equal) {
-    //   return result;
-    // }
+    if (hashes_differ(a.get(), b.get())) {
+        result = LessThan;
+        return result;
+    }
 
     if (compare_scalar(a->type_info(), b->type_info()) != Equal) {
         return result;
@@ -185,6 +196,11 @@ IRComparer::CmpResult IRComparer::compare_stmt(const Stmt &a, const Stmt &b) {
         return result;
     }
 
+    if (hashes_differ(a.get(), b.get())) {
+        result = LessThan;
+        return result;
+    }
+
     if (compare_scalar(a->type_info(), b->type_info()) != Equal) {
         return result;
     }
@@ -452,7 +468,7 @@ void IRComparer::visit(const Shuffle *op) {
 }
 
 void IRComparer::visit(const Prefetch *op) {
-    const Prefetch *s = expr.as<Prefetch>();
+    const Prefetch *s = stmt.as<Prefetch>();
 
     compare_names(s->name, op->name);
     compare_scalar(s->bounds.size(), op->bounds.size());
@@ -462,26 +478,348 @@ void IRComparer::visit(const Prefetch *op) {
     }
 }
 
+
+/** Computes the hash of a single node from its fields and the
+ * (cached) hashes of its children. The fields hashed must be a subset
+ * of those compared by IRComparer above, so that equal IR hashes
+ * equal. */
+class IRHasher : public IRVisitor {
+public:
+    uint64_t result = 0;
+
+private:
+    void mix(uint64_t x) {
+        result ^= x + 0x9e3779b97f4a7c15ULL + (result << 6) + (result >> 2);
+    }
+
+    void mix(const std::string &s) {
+        mix((uint64_t)std::hash<std::string>()(s));
+    }
+
+    void mix(Type t) {
+        // Not the handle type, which is a pointer, so that the hash
+        // doesn't depend on where things are in memory.
+        mix(((uint64_t)t.code() << 32) | ((uint64_t)t.bits() << 16) | (uint64_t)t.lanes());
+    }
+
+    void mix(const Expr &e) {
+        mix(structural_hash(e));
+    }
+
+    void mix(const Stmt &s) {
+        mix(structural_hash(s));
+    }
+
+    void mix(const std::vector<Expr> &v) {
+        mix((uint64_t)v.size());
+        for (const Expr &e : v) {
+            mix(e);
+        }
+    }
+
+    void start(const BaseExprNode *op) {
+        result = (uint64_t)op->type_info() + 1;
+        mix(op->type);
+    }
+
+    void start(const BaseStmtNode *op) {
+        result = (uint64_t)op->type_info() + 1;
+    }
+
+    void finish() {
+        // Zero means not computed yet.
+        if (result == 0) result = 1;
+    }
+
+    template<typename T>
+    void visit_binary_operator(const T *op) {
+        start(op);
+        mix(op->a);
+        mix(op->b);
+        finish();
+    }
+
+    void visit(const IntImm *op) {
+        start(op);
+        mix((uint64_t)op->value);
+        finish();
+    }
+
+    void visit(const UIntImm *op) {
+        start(op);
+        mix(op->value);
+        finish();
+    }
+
+    void visit(const FloatImm *op) {
+        start(op);
+        // Positive and negative zero compare equal.
+        double v = op->value == 0 ? 0.0 : op->value;
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        mix(bits);
+        finish();
+    }
+
+    void visit(const StringImm *op) {
+        start(op);
+        mix(op->value);
+        finish();
+    }
+
+    void visit(const Cast *op) {
+        start(op);
+        mix(op->value);
+        finish();
+    }
+
+    void visit(const Variable *op) {
+        start(op);
+        mix(op->name);
+        finish();
+    }
+
+    void visit(const Add *op) {visit_binary_operator(op);}
+    void visit(const Sub *op) {visit_binary_operator(op);}
+    void visit(const Mul *op) {visit_binary_operator(op);}
+    void visit(const Div *op) {visit_binary_operator(op);}
+    void visit(const Mod *op) {visit_binary_operator(op);}
+    void visit(const Min *op) {visit_binary_operator(op);}
+    void visit(const Max *op) {visit_binary_operator(op);}
+    void visit(const EQ *op) {visit_binary_operator(op);}
+    void visit(const NE *op) {visit_binary_operator(op);}
+    void visit(const LT *op) {visit_binary_operator(op);}
+    void visit(const LE *op) {visit_binary_operator(op);}
+    void visit(const GT *op) {visit_binary_operator(op);}
+    void visit(const GE *op) {visit_binary_operator(op);}
+    void visit(const And *op) {visit_binary_operator(op);}
+    void visit(const Or *op) {visit_binary_operator(op);}
+
+    void visit(const Not *op) {
+        start(op);
+        mix(op->a);
+        finish();
+    }
+
+    void visit(const Select *op) {
+        start(op);
+        mix(op->condition);
+        mix(op->true_value);
+        mix(op->false_value);
+        finish();
+    }
+
+    void visit(const Load *op) {
+        start(op);
+        mix(op->name);
+        mix(op->predicate);
+        mix(op->index);
+        finish();
+    }
+
+    void visit(const Ramp *op) {
+        start(op);
+        mix(op->base);
+        mix(op->stride);
+        finish();
+    }
+
+    void visit(const Broadcast *op) {
+        start(op);
+        mix(op->value);
+        finish();
+    }
+
+    void visit(const Call *op) {
+        start(op);
+        mix(op->name);
+        mix((uint64_t)op->call_type);
+        mix((uint64_t)op->value_index);
+        mix(op->args);
+        finish();
+    }
+
+    void visit(const Let *op) {
+        start(op);
+        mix(op->name);
+        mix(op->value);
+        mix(op->body);
+        finish();
+    }
+
+    void visit(const LetStmt *op) {
+        start(op);
+        mix(op->name);
+        mix(op->value);
+        mix(op->body);
+        finish();
+    }
+
+    void visit(const AssertStmt *op) {
+        start(op);
+        mix(op->condition);
+        mix(op->message);
+        finish();
+    }
+
+    void visit(const ProducerConsumer *op) {
+        start(op);
+        mix(op->name);
+        mix((uint64_t)op->is_producer);
+        mix(op->body);
+        finish();
+    }
+
+    void visit(const For *op) {
+        start(op);
+        mix(op->name);
+        mix((uint64_t)op->for_type);
+        mix(op->min);
+        mix(op->extent);
+        mix(op->body);
+        finish();
+    }
+
+    void visit(const Store *op) {
+        start(op);
+        mix(op->name);
+        mix(op->predicate);
+        mix(op->value);
+        mix(op->index);
+        finish();
+    }
+
+    void visit(const Provide *op) {
+        start(op);
+        mix(op->name);
+        mix(op->args);
+        mix(op->values);
+        finish();
+    }
+
+    void visit(const Allocate *op) {
+        start(op);
+        mix(op->name);
+        mix(op->extents);
+        mix(op->body);
+        mix(op->condition);
+        mix(op->new_expr);
+        mix(op->free_function);
+        finish();
+    }
+
+    void visit(const Free *op) {
+        start(op);
+        mix(op->name);
+        finish();
+    }
+
+    void visit(const Realize *op) {
+        start(op);
+        mix(op->name);
+        for (Type t : op->types) {
+            mix(t);
+        }
+        for (const Range &r : op->bounds) {
+            mix(r.min);
+            mix(r.extent);
+        }
+        mix(op->body);
+        mix(op->condition);
+        finish();
+    }
+
+    void visit(const Block *op) {
+        start(op);
+        mix(op->first);
+        mix(op->rest);
+        finish();
+    }
+
+    void visit(const IfThenElse *op) {
+        start(op);
+        mix(op->condition);
+        mix(op->then_case);
+        mix(op->else_case);
+        finish();
+    }
+
+    void visit(const Evaluate *op) {
+        start(op);
+        mix(op->value);
+        finish();
+    }
+
+    void visit(const Shuffle *op) {
+        start(op);
+        mix(op->vectors);
+        for (int i : op->indices) {
+            mix((uint64_t)i);
+        }
+        finish();
+    }
+
+    void visit(const Prefetch *op) {
+        start(op);
+        mix(op->name);
+        for (const Range &r : op->bounds) {
+            mix(r.min);
+            mix(r.extent);
+        }
+        finish();
+    }
+};
+
 } // namespace
 
 
 // Now the methods exposed in the header.
 bool equal(const Expr &a, const Expr &b) {
-    return IRComparer().compare_expr(a, b) == IRComparer::Equal;
+    return IRComparer(nullptr, true).compare_expr(a, b) == IRComparer::Equal;
 }
 
 bool graph_equal(const Expr &a, const Expr &b) {
     IRCompareCache cache(8);
-    return IRComparer(&cache).compare_expr(a, b) == IRComparer::Equal;
+    return IRComparer(&cache, true).compare_expr(a, b) == IRComparer::Equal;
 }
 
 bool equal(const Stmt &a, const Stmt &b) {
-    return IRComparer().compare_stmt(a, b) == IRComparer::Equal;
+    return IRComparer(nullptr, true).compare_stmt(a, b) == IRComparer::Equal;
 }
 
 bool graph_equal(const Stmt &a, const Stmt &b) {
     IRCompareCache cache(8);
-    return IRComparer(&cache).compare_stmt(a, b) == IRComparer::Equal;
+    return IRComparer(&cache, true).compare_stmt(a, b) == IRComparer::Equal;
+}
+
+bool ExprEqual::operator()(const Expr &a, const Expr &b) const {
+    if (a.same_as(b)) {
+        return true;
+    }
+    if (structural_hash(a) != structural_hash(b)) {
+        return false;
+    }
+    return IRComparer(cache, true).compare_expr(a, b) == IRComparer::Equal;
+}
+
+uint64_t structural_hash(const Expr &e) {
+    if (!e.defined()) return 1;
+    uint64_t h = e.get()->structural_hash;
+    if (h) return h;
+    IRHasher hasher;
+    e.accept(&hasher);
+    e.get()->structural_hash = hasher.result;
+    return hasher.result;
+}
+
+uint64_t structural_hash(const Stmt &s) {
+    if (!s.defined()) return 1;
+    uint64_t h = s.get()->structural_hash;
+    if (h) return h;
+    IRHasher hasher;
+    s.accept(&hasher);
+    s.get()->structural_hash = hasher.result;
+    return hasher.result;
 }
 
 bool IRDeepCompare::operator()(const Expr &a, const Expr &b) const {
@@ -523,6 +861,12 @@ void check_equal(const Expr &a, const Expr &b) {
         << " instead of " << IRComparer::Equal
         << " when comparing:\n" << a
         << "\nand\n" << b << "\n";
+    internal_assert(structural_hash(a) == structural_hash(b))
+        << "Error in ir_equality_test: equal expressions have different hashes:\n"
+        << a << "\nand\n" << b << "\n";
+    internal_assert(ExprEqual(&cache)(a, b))
+        << "Error in ir_equality_test: ExprEqual disagrees with IRComparer:\n"
+        << a << "\nand\n" << b << "\n";
 }
 
 void check_not_equal(const Expr &a, const Expr &b) {
@@ -536,6 +880,9 @@ void check_not_equal(const Expr &a, const Expr &b) {
         << " is not the opposite of " << r2
         << " when comparing:\n" << a
         << "\nand\n" << b << "\n";
+    internal_assert(!ExprEqual(&cache)(a, b))
+        << "Error in ir_equality_test: ExprEqual disagrees with IRComparer:\n"
+        << a << "\nand\n" << b << "\n";
 }
 
 } // namespace
@@ -548,6 +895,9 @@ void ir_equality_test() {
     check_equal(x, Variable::make(Int(32), "x"));
     check_not_equal(x, Variable::make(Int(32), "y"));
 
+    check_equal(FloatImm::make(Float(32), 0.0), FloatImm::make(Float(32), -0.0));
+    check_not_equal(Cast::make(Int(16), x), Cast::make(UInt(16), x));
+
     // Something that will hang if IREquality has poor computational
     // complexity.
     Expr e1 = x, e2 = x;
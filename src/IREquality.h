@@ -101,6 +101,42 @@ struct ExprWithCompareCache {
     EXPORT bool operator<(const ExprWithCompareCache &other) const;
 };
 
+/** Compute a hash of the value of an Expr or Stmt, such that IR that
+ * compares equal (see below) hashes equal. The hash of each node is
+ * cached on the node, so hashing a graph visits every node at most
+ * once, and hashing it again is free. Never returns zero. The hash of
+ * an undefined Expr or Stmt is one. The hash depends only on names,
+ * types and values, but it is not stable across runs or platforms,
+ * so don't store it. */
+// @{
+EXPORT uint64_t structural_hash(const Expr &e);
+EXPORT uint64_t structural_hash(const Stmt &s);
+// @}
+
+/** Hash and equality functors for using Exprs as keys in unordered
+ * containers with equality of value. Equality compares the cached
+ * hashes first, so two distinct Exprs are almost always told apart
+ * without walking them. ExprEqual can be given an IRCompareCache for
+ * use on nasty graphs, as with ExprWithCompareCache.
+ *
+\code
+std::unordered_map<Expr, int, ExprHash, ExprEqual> numbering;
+\endcode
+ */
+// @{
+struct ExprHash {
+    size_t operator()(const Expr &e) const {
+        return (size_t)structural_hash(e);
+    }
+};
+
+struct ExprEqual {
+    IRCompareCache *cache;
+    ExprEqual(IRCompareCache *c = nullptr) : cache(c) {}
+    EXPORT bool operator()(const Expr &a, const Expr &b) const;
+};
+// @}
+
 /** Compare IR nodes for equality of value. Traverses entire IR
  * tree. For equality of reference, use Expr::same_as. If you're
  * comparing non-CSE'd Exprs, use graph_equal, which is safe for nasty
@@ -8,6 +8,7 @@
 #endif
 
 #include "CodeGen_Internal.h"
+#include "CompileTiming.h"
 #include "JITModule.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Runtime_Linker.h"
@@ -256,6 +257,8 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     // Ensure that LLVM is initialized
     CodeGen_LLVM::initialize_llvm();
 
+    CompileTimer timer(m->getModuleIdentifier(), "jit");
+
     // Make the execution engine
     debug(2) << "Creating new execution engine\n";
     debug(2) << "Target triple: " << m->getTargetTriple() << "\n";
@@ -268,6 +271,7 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
 
     DataLayout initial_module_data_layout = m->getDataLayout();
     string module_name = m->getModuleIdentifier();
+    CodeGenOpt::Level opt_level = get_codegen_opt_level(*m);
 
     llvm::EngineBuilder engine_builder((std::move(m)));
     engine_builder.setTargetOptions(options);
@@ -276,7 +280,7 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     HalideJITMemoryManager *memory_manager = new HalideJITMemoryManager(dependencies);
     engine_builder.setMCJITMemoryManager(std::unique_ptr<RTDyldMemoryManager>(memory_manager));
 
-    engine_builder.setOptLevel(CodeGenOpt::Aggressive);
+    engine_builder.setOptLevel(opt_level);
     if (!mcpu.empty()) {
         engine_builder.setMCPU(mcpu);
     }
@@ -336,6 +340,7 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
     debug(2) << "Finalizing object\n";
     ee->finalizeObject();
     memory_manager->work_around_llvm_bugs();
+    timer.mark("compiling and finalizing machine code");
 
     // Do any target-specific post-compilation module meddling
     for (size_t i = 0; i < listeners.size(); i++) {
@@ -1,6 +1,9 @@
 #include "LLVM_Runtime_Linker.h"
 #include "LLVM_Headers.h"
 
+#include <map>
+#include <mutex>
+
 namespace Halide {
 
 using std::string;
@@ -614,6 +617,28 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
 
     //    Halide::Internal::debug(0) << "Getting initial module type " << (int)module_type << "\n";
 
+    // Jitting a pipeline parses and links the inlined runtime modules
+    // into a fresh context every time, which dominates the cost of
+    // compiling small pipelines. The result only depends on the
+    // target, so link it once per target and keep it as bitcode, which
+    // is much cheaper to parse into a new context than relinking.
+    static std::mutex jit_inlined_cache_mutex;
+    static std::map<string, string> jit_inlined_cache;
+    if (module_type == ModuleJITInlined) {
+        const string *bitcode = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(jit_inlined_cache_mutex);
+            auto it = jit_inlined_cache.find(t.to_string());
+            if (it != jit_inlined_cache.end()) {
+                bitcode = &it->second;
+            }
+        }
+        if (bitcode) {
+            // Entries are never removed, so the string stays valid.
+            return parse_bitcode_file(*bitcode, c, "halide_jit_inlined_runtime");
+        }
+    }
+
     internal_assert(t.bits == 32 || t.bits == 64);
     bool bits_64 = (t.bits == 64);
     bool debug = t.has_feature(Target::Debug);
@@ -773,10 +798,12 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             } else {
                 modules.push_back(get_initmod_prefetch(c, bits_64, debug));
             }
-            if (t.has_feature(Target::SSE41)) {
+            // The extra versions of loops made for CPUDispatch may
+            // use any of these.
+            if (t.has_feature(Target::SSE41) || t.has_feature(Target::CPUDispatch)) {
                 modules.push_back(get_initmod_x86_sse41_ll(c));
             }
-            if (t.has_feature(Target::AVX)) {
+            if (t.has_feature(Target::AVX) || t.has_feature(Target::CPUDispatch)) {
                 modules.push_back(get_initmod_x86_avx_ll(c));
             }
             if (t.has_feature(Target::Profile)) {
@@ -784,8 +811,11 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             }
         }
 
-        if (module_type == ModuleAOT) {
-            // These modules are only used for AOT compilation
+        if (module_type == ModuleAOT ||
+            (module_type == ModuleJITInlined && t.has_feature(Target::CPUDispatch))) {
+            // These modules are only used for AOT compilation, and
+            // for choosing between versions of loops when jitting
+            // with CPUDispatch.
             modules.push_back(get_initmod_can_use_target(c, bits_64, debug));
             if (t.arch == Target::X86) {
                 modules.push_back(get_initmod_x86_cpu_features(c, bits_64, debug));
@@ -891,6 +921,15 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
         add_underscores_to_posix_calls_on_windows(modules[0].get());
     }
 
+    if (module_type == ModuleJITInlined) {
+        string bitcode;
+        llvm::raw_string_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(modules[0].get(), stream);
+        stream.flush();
+        std::lock_guard<std::mutex> lock(jit_inlined_cache_mutex);
+        jit_inlined_cache.emplace(t.to_string(), std::move(bitcode));
+    }
+
     return std::move(modules[0]);
 }
 
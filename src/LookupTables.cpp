@@ -0,0 +1,154 @@
+#include "LookupTables.h"
+#include "Bounds.h"
+#include "Function.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Simplify.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+
+namespace {
+
+// The largest table of 8-bit values the target can look up with a
+// single instruction. Zero if the target has no such instruction.
+int native_lookup_table_size(const Target &t) {
+    if (t.arch == Target::X86 && t.has_feature(Target::SSE41)) {
+        // pshufb indexes a single 16-byte register. It's an SSSE3
+        // instruction, but there's no target feature for SSSE3, and
+        // targets without SSE41 are compiled for a CPU without it.
+        return 16;
+    } else if (t.arch == Target::ARM && !t.has_feature(Target::NoNEON)) {
+        // tbl and vtbl index up to four registers.
+        return t.bits == 64 ? 64 : 32;
+    } else {
+        return 0;
+    }
+}
+
+// The widest table elements the target can look up in registers.
+int max_lookup_table_element_bits(const Target &t) {
+    if (t.arch == Target::Hexagon) {
+        // vlut only looks up 8- and 16-bit elements.
+        return 16;
+    } else {
+        return 64;
+    }
+}
+
+class LowerLookupTables : public IRMutator {
+    map<string, LookupStrategy> strategies;
+    int native_size, max_element_bits;
+    Scope<Interval> bounds;
+
+    using IRMutator::visit;
+
+    template<typename T>
+    void visit_let(const T *op) {
+        bounds.push(op->name, bounds_of_expr_in_scope(op->value, bounds));
+        IRMutator::visit(op);
+        bounds.pop(op->name);
+    }
+
+    void visit(const Let *op) { visit_let(op); }
+    void visit(const LetStmt *op) { visit_let(op); }
+
+    void visit(const For *op) {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Device backends have their own ideas about table
+            // lookups.
+            stmt = op;
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+
+    void visit(const Load *op) {
+        if (!op->type.is_vector() || op->index.as<Ramp>() || !is_one(op->predicate)) {
+            IRMutator::visit(op);
+            return;
+        }
+
+        LookupStrategy strategy = LookupStrategy::Auto;
+        auto it = strategies.find(op->name);
+        if (it != strategies.end()) {
+            strategy = it->second;
+        }
+
+        Expr index = mutate(op->index);
+
+        // Tables of elements the target can't look up in registers
+        // are always gathered from, whatever the strategy.
+        int max_size = 0;
+        if (op->type.bits() <= max_element_bits) {
+            if (strategy == LookupStrategy::Shuffle) {
+                max_size = 256;
+            } else if (strategy == LookupStrategy::Auto && op->type.bits() == 8) {
+                max_size = native_size;
+            }
+        }
+
+        if (max_size > 0) {
+            Interval index_bounds = bounds_of_expr_in_scope(index, bounds);
+            Expr span;
+            if (index_bounds.is_bounded()) {
+                span = simplify(index_bounds.max - index_bounds.min);
+            }
+            const int64_t *const_span = span.defined() ? as_const_int(span) : nullptr;
+            if (const_span && *const_span < max_size) {
+                // Load every element the indices could refer to, and
+                // look up the indices within that.
+                int extent = (int)(*const_span + 1);
+                Expr base = simplify(index_bounds.min);
+                Expr table = Load::make(op->type.with_lanes(extent), op->name,
+                                        Ramp::make(base, 1, extent),
+                                        op->image, op->param, const_true(extent));
+                index = simplify(cast(UInt(8, op->type.lanes()), index - base));
+                expr = Call::make(op->type, "dynamic_shuffle", {table, index, 0, extent - 1},
+                                  Call::PureIntrinsic);
+                return;
+            }
+            user_assert(strategy != LookupStrategy::Shuffle)
+                << "Func " << op->name << " has LookupStrategy::Shuffle, but the"
+                << " indices of a vectorized load from it, " << index
+                << ", are not provably within a range of 256 elements.\n";
+        }
+
+        if (!index.same_as(op->index)) {
+            expr = Load::make(op->type, op->name, index, op->image, op->param, op->predicate);
+        } else {
+            expr = op;
+        }
+    }
+
+public:
+    LowerLookupTables(const map<string, Function> &env, const Target &t) :
+        native_size(native_lookup_table_size(t)),
+        max_element_bits(max_lookup_table_element_bits(t)) {
+        for (const auto &p : env) {
+            const Function &f = p.second;
+            LookupStrategy s = f.schedule().lookup_strategy();
+            if (f.outputs() == 1) {
+                strategies[f.name()] = s;
+            } else {
+                for (int i = 0; i < f.outputs(); i++) {
+                    strategies[f.name() + "." + std::to_string(i)] = s;
+                }
+            }
+        }
+    }
+};
+
+}  // namespace
+
+Stmt lower_lookup_tables(Stmt s, const map<string, Function> &env, const Target &t) {
+    return LowerLookupTables(env, t).mutate(s);
+}
+
+}
+}
@@ -0,0 +1,29 @@
+#ifndef HALIDE_LOOKUP_TABLES_H
+#define HALIDE_LOOKUP_TABLES_H
+
+/** \file
+ * Defines a lowering pass that turns vectorized loads from small
+ * lookup tables into in-register table lookups.
+ */
+
+#include <map>
+
+#include "IR.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** Replace vector loads at data-dependent indices that provably
+ * fall within a small range with a dense load of that range and a
+ * dynamic_shuffle intrinsic, which the backends implement with table
+ * lookup instructions (e.g. pshufb on x86, tbl on ARM). Respects the
+ * LookupStrategy in the schedules of the functions in env. */
+EXPORT Stmt lower_lookup_tables(Stmt s, const std::map<std::string, Function> &env, const Target &t);
+
+}
+}
+
+#endif
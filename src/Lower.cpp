@@ -10,8 +10,10 @@
 #include "AllocationBoundsInference.h"
 #include "Bounds.h"
 #include "BoundsInference.h"
+#include "CPUDispatch.h"
 #include "CSE.h"
 #include "CanonicalizeGPUVars.h"
+#include "CompileTiming.h"
 #include "Debug.h"
 #include "DebugArguments.h"
 #include "DebugToFile.h"
@@ -32,6 +34,7 @@
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "IRPrinter.h"
+#include "LookupTables.h"
 #include "LoopCarry.h"
 #include "Memoization.h"
 #include "PartitionLoops.h"
@@ -80,6 +83,8 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
 
     Module result_module(simple_pipeline_name, t);
 
+    CompileTimer timer(pipeline_name, "lower");
+
     // Compute an environment
     map<string, Function> env;
     for (Function f : output_funcs) {
@@ -111,19 +116,24 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     // specializations' conditions
     simplify_specializations(env);
 
+    timer.mark("computing realization order");
+
     bool any_memoized = false;
 
     debug(1) << "Creating initial loop nests...\n";
     Stmt s = schedule_functions(outputs, order, env, t, any_memoized);
+    timer.mark("creating initial loop nests", s);
     debug(2) << "Lowering after creating initial loop nests:\n" << s << '\n';
 
     debug(1) << "Canonicalizing GPU var names...\n";
     s = canonicalize_gpu_vars(s);
+    timer.mark("canonicalizing GPU var names", s);
     debug(2) << "Lowering after canonicalizing GPU var names:\n" << s << '\n';
 
     if (any_memoized) {
         debug(1) << "Injecting memoization...\n";
         s = inject_memoization(s, env, pipeline_name, outputs);
+        timer.mark("injecting memoization", s);
         debug(2) << "Lowering after injecting memoization:\n" << s << '\n';
     } else {
         debug(1) << "Skipping injecting memoization...\n";
@@ -131,21 +141,25 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
 
     debug(1) << "Injecting tracing...\n";
     s = inject_tracing(s, pipeline_name, env, outputs, t);
+    timer.mark("injecting tracing", s);
     debug(2) << "Lowering after injecting tracing:\n" << s << '\n';
 
     debug(1) << "Adding checks for parameters\n";
     s = add_parameter_checks(s, t);
+    timer.mark("injecting parameter checks", s);
     debug(2) << "Lowering after injecting parameter checks:\n" << s << '\n';
 
     // Compute the maximum and minimum possible value of each
     // function. Used in later bounds inference passes.
     debug(1) << "Computing bounds of each function's value\n";
     FuncValueBounds func_bounds = compute_function_value_bounds(order, env);
+    timer.mark("computing function value bounds");
 
     // The checks will be in terms of the symbols defined by bounds
     // inference.
     debug(1) << "Adding checks for images\n";
     s = add_image_checks(s, outputs, t, order, env, func_bounds);
+    timer.mark("injecting image checks", s);
     debug(2) << "Lowering after injecting image checks:\n" << s << '\n';
 
     // This pass injects nested definitions of variable names, so we
@@ -153,18 +167,22 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     // can still simplify Exprs).
     debug(1) << "Performing computation bounds inference...\n";
     s = bounds_inference(s, outputs, order, env, func_bounds, t);
+    timer.mark("computation bounds inference", s);
     debug(2) << "Lowering after computation bounds inference:\n" << s << '\n';
 
     debug(1) << "Performing sliding window optimization...\n";
     s = sliding_window(s, env);
+    timer.mark("sliding window", s);
     debug(2) << "Lowering after sliding window:\n" << s << '\n';
 
     debug(1) << "Performing allocation bounds inference...\n";
     s = allocation_bounds_inference(s, env, func_bounds);
+    timer.mark("allocation bounds inference", s);
     debug(2) << "Lowering after allocation bounds inference:\n" << s << '\n';
 
     debug(1) << "Removing code that depends on undef values...\n";
     s = remove_undef(s);
+    timer.mark("removing code that depends on undef values", s);
     debug(2) << "Lowering after removing code that depends on undef values:\n" << s << "\n\n";
 
     // This uniquifies the variable names, so we're good to simplify
@@ -172,49 +190,60 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     // equivalence means semantic equivalence.
     debug(1) << "Uniquifying variable names...\n";
     s = uniquify_variable_names(s);
+    timer.mark("uniquifying variable names", s);
     debug(2) << "Lowering after uniquifying variable names:\n" << s << "\n\n";
 
     debug(1) << "Performing storage folding optimization...\n";
     s = storage_folding(s, env);
+    timer.mark("storage folding", s);
     debug(2) << "Lowering after storage folding:\n" << s << '\n';
 
     debug(1) << "Injecting debug_to_file calls...\n";
     s = debug_to_file(s, outputs, env);
+    timer.mark("injecting debug_to_file calls", s);
     debug(2) << "Lowering after injecting debug_to_file calls:\n" << s << '\n';
 
     debug(1) << "Simplifying...\n"; // without removing dead lets, because storage flattening needs the strides
     s = simplify(s, false);
+    timer.mark("first simplification", s);
     debug(2) << "Lowering after first simplification:\n" << s << "\n\n";
 
     debug(1) << "Injecting prefetches...\n";
     s = inject_prefetch(s, env);
+    timer.mark("injecting prefetches", s);
     debug(2) << "Lowering after injecting prefetches:\n" << s << "\n\n";
 
     debug(1) << "Dynamically skipping stages...\n";
     s = skip_stages(s, order);
+    timer.mark("dynamically skipping stages", s);
     debug(2) << "Lowering after dynamically skipping stages:\n" << s << "\n\n";
 
     debug(1) << "Destructuring tuple-valued realizations...\n";
     s = split_tuples(s, env);
+    timer.mark("destructuring tuple-valued realizations", s);
     debug(2) << "Lowering after destructuring tuple-valued realizations:\n" << s << "\n\n";
 
     if (t.has_feature(Target::OpenGL)) {
         debug(1) << "Injecting image intrinsics...\n";
         s = inject_image_intrinsics(s, env);
+        timer.mark("image intrinsics", s);
         debug(2) << "Lowering after image intrinsics:\n" << s << "\n\n";
     }
 
     debug(1) << "Performing storage flattening...\n";
     s = storage_flattening(s, outputs, env, t);
+    timer.mark("storage flattening", s);
     debug(2) << "Lowering after storage flattening:\n" << s << "\n\n";
 
     debug(1) << "Unpacking buffer arguments...\n";
     s = unpack_buffers(s);
+    timer.mark("unpacking buffer arguments", s);
     debug(2) << "Lowering after unpacking buffer arguments...\n";
 
     if (any_memoized) {
         debug(1) << "Rewriting memoized allocations...\n";
         s = rewrite_memoized_allocations(s, env);
+        timer.mark("rewriting memoized allocations", s);
         debug(2) << "Lowering after rewriting memoized allocations:\n" << s << "\n\n";
     } else {
         debug(1) << "Skipping rewriting memoized allocations...\n";
@@ -226,16 +255,19 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
         (t.arch != Target::Hexagon && (t.features_any_of({Target::HVX_64, Target::HVX_128})))) {
         debug(1) << "Selecting a GPU API for GPU loops...\n";
         s = select_gpu_api(s, t);
+        timer.mark("selecting a GPU API", s);
         debug(2) << "Lowering after selecting a GPU API:\n" << s << "\n\n";
 
         debug(1) << "Injecting host <-> dev buffer copies...\n";
         s = inject_host_dev_buffer_copies(s, t);
+        timer.mark("injecting host <-> dev buffer copies", s);
         debug(2) << "Lowering after injecting host <-> dev buffer copies:\n" << s << "\n\n";
     }
 
     if (t.has_feature(Target::OpenGL)) {
         debug(1) << "Injecting OpenGL texture intrinsics...\n";
         s = inject_opengl_intrinsics(s);
+        timer.mark("OpenGL intrinsics", s);
         debug(2) << "Lowering after OpenGL intrinsics:\n" << s << "\n\n";
     }
 
@@ -243,6 +275,7 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
         t.has_feature(Target::OpenGLCompute)) {
         debug(1) << "Injecting per-block gpu synchronization...\n";
         s = fuse_gpu_thread_loops(s);
+        timer.mark("injecting per-block gpu synchronization", s);
         debug(2) << "Lowering after injecting per-block gpu synchronization:\n" << s << "\n\n";
     }
 
@@ -250,78 +283,106 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     s = simplify(s);
     s = unify_duplicate_lets(s);
     s = remove_trivial_for_loops(s);
+    timer.mark("second simplification", s);
     debug(2) << "Lowering after second simplifcation:\n" << s << "\n\n";
 
     debug(1) << "Reduce prefetch dimension...\n";
     s = reduce_prefetch_dimension(s, t);
+    timer.mark("reduce prefetch dimension", s);
     debug(2) << "Lowering after reduce prefetch dimension:\n" << s << "\n";
 
     debug(1) << "Unrolling...\n";
     s = unroll_loops(s);
     s = simplify(s);
+    timer.mark("unrolling", s);
     debug(2) << "Lowering after unrolling:\n" << s << "\n\n";
 
     debug(1) << "Vectorizing...\n";
     s = vectorize_loops(s, t);
     s = simplify(s);
+    timer.mark("vectorizing", s);
     debug(2) << "Lowering after vectorizing:\n" << s << "\n\n";
 
     debug(1) << "Detecting vector interleavings...\n";
     s = rewrite_interleavings(s);
     s = simplify(s);
+    timer.mark("rewriting vector interleavings", s);
     debug(2) << "Lowering after rewriting vector interleavings:\n" << s << "\n\n";
 
+    debug(1) << "Lowering lookup tables...\n";
+    s = lower_lookup_tables(s, env, t);
+    timer.mark("lowering lookup tables", s);
+    debug(2) << "Lowering after lowering lookup tables:\n" << s << "\n\n";
+
     debug(1) << "Partitioning loops to simplify boundary conditions...\n";
     s = partition_loops(s);
     s = simplify(s);
+    timer.mark("partitioning loops", s);
     debug(2) << "Lowering after partitioning loops:\n" << s << "\n\n";
 
     debug(1) << "Trimming loops to the region over which they do something...\n";
     s = trim_no_ops(s);
+    timer.mark("loop trimming", s);
     debug(2) << "Lowering after loop trimming:\n" << s << "\n\n";
 
     debug(1) << "Injecting early frees...\n";
     s = inject_early_frees(s);
+    timer.mark("injecting early frees", s);
     debug(2) << "Lowering after injecting early frees:\n" << s << "\n\n";
 
     if (t.has_feature(Target::Profile)) {
         debug(1) << "Injecting profiling...\n";
-        s = inject_profiling(s, pipeline_name);
+        s = inject_profiling(s, pipeline_name, args);
+        timer.mark("injecting profiling", s);
         debug(2) << "Lowering after injecting profiling:\n" << s << "\n\n";
     }
 
     if (t.has_feature(Target::FuzzFloatStores)) {
         debug(1) << "Fuzzing floating point stores...\n";
         s = fuzz_float_stores(s);
+        timer.mark("fuzzing floating point stores", s);
         debug(2) << "Lowering after fuzzing floating point stores:\n" << s << "\n\n";
     }
 
     debug(1) << "Simplifying...\n";
     s = common_subexpression_elimination(s);
+    timer.mark("common subexpression elimination", s);
 
     if (t.has_feature(Target::OpenGL)) {
         debug(1) << "Detecting varying attributes...\n";
         s = find_linear_expressions(s);
+        timer.mark("detecting varying attributes", s);
         debug(2) << "Lowering after detecting varying attributes:\n" << s << "\n\n";
 
         debug(1) << "Moving varying attribute expressions out of the shader...\n";
         s = setup_gpu_vertex_buffer(s);
+        timer.mark("removing varying attributes", s);
         debug(2) << "Lowering after removing varying attributes:\n" << s << "\n\n";
     }
 
     s = remove_dead_allocations(s);
     s = remove_trivial_for_loops(s);
     s = simplify(s);
+    timer.mark("final simplification", s);
     debug(1) << "Lowering after final simplification:\n" << s << "\n\n";
 
+    if (t.has_feature(Target::CPUDispatch)) {
+        debug(1) << "Multi-versioning vectorized loops...\n";
+        s = multi_version_loops(s, t);
+        timer.mark("multi-versioning vectorized loops", s);
+        debug(2) << "Lowering after multi-versioning vectorized loops:\n" << s << "\n\n";
+    }
+
     debug(1) << "Splitting off Hexagon offload...\n";
     s = inject_hexagon_rpc(s, t, result_module);
+    timer.mark("splitting off Hexagon offload", s);
     debug(2) << "Lowering after splitting off Hexagon offload:\n" << s << '\n';
 
     if (!custom_passes.empty()) {
         for (size_t i = 0; i < custom_passes.size(); i++) {
             debug(1) << "Running custom lowering pass " << i << "...\n";
             s = custom_passes[i]->mutate(s);
+            timer.mark("custom pass " + std::to_string(i), s);
             debug(1) << "Lowering after custom pass " << i << ":\n" << s << "\n\n";
         }
     }
@@ -398,6 +459,8 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     // Also append any wrappers for extern stages that expect the old buffer_t
     wrap_legacy_extern_stages(result_module);
 
+    timer.mark("inferring arguments and adding wrappers");
+
     return result_module;
 }
 
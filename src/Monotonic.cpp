@@ -290,6 +290,7 @@ class MonotonicVisitor : public IRVisitor {
         // Some functions are known to be monotonic
         if (op->is_intrinsic(Call::likely) ||
             op->is_intrinsic(Call::likely_if_innermost) ||
+            op->is_intrinsic(Call::predicated_tail) ||
             op->is_intrinsic(Call::return_second)) {
             op->args.back().accept(this);
             return;
@@ -1,9 +1,14 @@
 #include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <sstream>
 
 #include "Pipeline.h"
 #include "Argument.h"
+#include "FindCalls.h"
 #include "Func.h"
 #include "InferArguments.h"
+#include "IRPrinter.h"
 #include "IRVisitor.h"
 #include "LLVM_Headers.h"
 #include "LLVM_Output.h"
@@ -39,6 +44,142 @@ Outputs static_library_outputs(const string &filename_prefix, const Target &targ
     return outputs;
 }
 
+// Collects the names of the extern functions a module calls, in the
+// order they are called.
+class FindExternCalls : public IRGraphVisitor {
+    using IRGraphVisitor::visit;
+
+    void visit(const Call *op) {
+        IRGraphVisitor::visit(op);
+        if (op->call_type == Call::Extern || op->call_type == Call::ExternCPlusPlus) {
+            names << op->name << " ";
+        }
+    }
+
+public:
+    std::ostringstream names;
+};
+
+// Collects the names bound inside a module, and the bit patterns of
+// its floating point constants, which aren't printed exactly. This
+// visits every node, rather than every distinct node, so that the
+// constants are listed in the order they are printed.
+class FindKeyDetails : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const FloatImm *op) {
+        uint64_t bits = 0;
+        memcpy(&bits, &op->value, sizeof(op->value));
+        float_bits << std::hex << bits << " ";
+    }
+
+    void visit(const Let *op) {
+        bound.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const LetStmt *op) {
+        bound.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const For *op) {
+        bound.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Allocate *op) {
+        bound.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Realize *op) {
+        bound.insert(op->name);
+        IRVisitor::visit(op);
+    }
+
+public:
+    std::set<string> bound;
+    std::ostringstream float_bits;
+};
+
+bool is_identifier_char(char c) {
+    return isalnum(c) || c == '_' || c == '$' || c == ':' || c == '.';
+}
+
+// Make a key that is equal for any two modules that compile to the
+// same code. The key is the printed module, with the names in renamed
+// (the names of the Funcs in the pipeline and of the generated
+// function), the names of the arguments, and the names bound inside
+// the module renamed in order of first appearance. Names derived from
+// one of these by appending a suffix (e.g. "f.buffer") are renamed
+// along with it. This makes redefining a pipeline from fresh Funcs
+// produce the same key. The exact values of the floating point
+// constants and the calls to extern functions are appended, as the
+// printed module doesn't capture them exactly.
+string structural_jit_key(const Module &module, const std::set<string> &renamed) {
+    std::ostringstream printed;
+    printed << module;
+    const string text = printed.str();
+
+    std::set<string> names = renamed;
+    FindKeyDetails details;
+    FindExternCalls externs;
+    std::ostringstream arg_types;
+    for (const auto &f : module.functions()) {
+        // The types of the arguments aren't printed with the module.
+        for (const auto &arg : f.args) {
+            arg_types << (int)arg.kind << ":" << arg.type << ":" << (int)arg.dimensions << " ";
+            names.insert(arg.name);
+        }
+        f.body.accept(&details);
+        f.body.accept(&externs);
+    }
+    names.insert(details.bound.begin(), details.bound.end());
+
+    std::map<string, string> renaming;
+    auto rename = [&](const string &name) {
+        auto it = renaming.find(name);
+        if (it == renaming.end()) {
+            it = renaming.emplace(name, "$" + std::to_string(renaming.size())).first;
+        }
+        return it->second;
+    };
+
+    string key;
+    key.reserve(text.size());
+    size_t i = 0;
+    while (i < text.size()) {
+        if (!is_identifier_char(text[i])) {
+            key += text[i++];
+            continue;
+        }
+        size_t j = i;
+        while (j < text.size() && is_identifier_char(text[j])) j++;
+        string token = text.substr(i, j - i);
+        size_t dot = token.find('.');
+        if (names.count(token)) {
+            key += rename(token);
+        } else if (dot != string::npos && names.count(token.substr(0, dot))) {
+            key += rename(token.substr(0, dot)) + token.substr(dot);
+        } else {
+            key += token;
+        }
+        i = j;
+    }
+
+    key += "\nargument types: " + arg_types.str();
+    key += "\nfloat constants: " + details.float_bits.str();
+    key += "\nextern calls: " + externs.names.str();
+    return key;
+}
+
+// Jitted code shared between structurally identical pipelines
+// compiled with Target::FastCompile.
+std::mutex jit_cache_mutex;
+std::map<string, JITModule> jit_cache;
+const size_t jit_cache_max_entries = 256;
+
 }  // namespace
 
 struct PipelineContents {
@@ -415,11 +556,54 @@ void *Pipeline::compile_jit(const Target &target_arg) {
     Module module = compile_to_module(args, name, target).resolve_submodules();
     auto f = module.get_function_by_name(name);
 
+    // With FastCompile, reuse the code compiled for any structurally
+    // identical pipeline. The lowered module is compared rather than
+    // the Funcs, so that schedules and parameters are accounted for.
+    // Pipelines whose code depends on more than the lowered module
+    // (embedded buffers, externs, custom passes, tracing) are always
+    // compiled afresh.
+    string structural_key;
+    if (target.has_feature(Target::FastCompile) &&
+        module.buffers().empty() &&
+        module.external_code().empty() &&
+        contents->jit_externs.empty() &&
+        contents->custom_lowering_passes.empty() &&
+        !target.features_any_of({Target::TraceLoads, Target::TraceStores, Target::TraceRealizations})) {
+        std::set<string> renamed = {name};
+        for (Function out : contents->outputs) {
+            for (const auto &it : find_transitive_calls(out)) {
+                renamed.insert(it.first);
+            }
+        }
+        structural_key = structural_jit_key(module, renamed);
+        if (structural_key.find(Call::trace) != string::npos) {
+            structural_key.clear();
+        }
+    }
+
+    if (!structural_key.empty()) {
+        std::lock_guard<std::mutex> lock(jit_cache_mutex);
+        auto it = jit_cache.find(structural_key);
+        if (it != jit_cache.end()) {
+            debug(2) << "Reusing jit module compiled for a structurally identical pipeline\n";
+            contents->jit_module = it->second;
+            return contents->jit_module.main_function();
+        }
+    }
+
     std::map<std::string, JITExtern> lowered_externs = contents->jit_externs;
 
     // Compile to jit module
     JITModule jit_module(module, f, make_externs_jit_module(target_arg, lowered_externs));
 
+    if (!structural_key.empty()) {
+        std::lock_guard<std::mutex> lock(jit_cache_mutex);
+        if (jit_cache.size() >= jit_cache_max_entries) {
+            jit_cache.clear();
+        }
+        jit_cache.emplace(structural_key, jit_module);
+    }
+
     // Dump bitcode to a file if the environment variable
     // HL_GENBITCODE is defined to a nonzero value.
     if (atoi(get_env_variable("HL_GENBITCODE").c_str())) {
@@ -16,6 +16,7 @@ namespace Halide {
 namespace Internal {
 
 using std::map;
+using std::pair;
 using std::string;
 using std::vector;
 
@@ -262,10 +263,69 @@ private:
     }
 };
 
-Stmt inject_profiling(Stmt s, string pipeline_name) {
+// Record the values of the pipeline's integer scalar arguments and
+// the shapes of its buffers, for profile-guided specialization. The
+// call goes after the buffer shapes have been unpacked and checked.
+class RecordArgs {
+    vector<pair<string, Expr>> values;
+
+    Stmt make_record_call() {
+        const int num_args = (int)values.size();
+        Expr profiler_pipeline_state = Variable::make(Handle(), "profiler_pipeline_state");
+        Expr names_buf = Variable::make(Handle(), "profiling_arg_names");
+        Expr values_buf = Variable::make(Handle(), "profiling_arg_values");
+        Stmt s = Evaluate::make(Call::make(Int(32), "halide_profiler_record_args",
+                                           {profiler_pipeline_state, num_args, names_buf, values_buf},
+                                           Call::Extern));
+        for (int i = num_args-1; i >= 0; --i) {
+            s = Block::make(Store::make("profiling_arg_names", values[i].first,
+                                        i, Parameter(), const_true()), s);
+            s = Block::make(Store::make("profiling_arg_values", cast<int64_t>(values[i].second),
+                                        i, Parameter(), const_true()), s);
+        }
+        s = Block::make(s, Free::make("profiling_arg_values"));
+        s = Allocate::make("profiling_arg_values", Int(64), {num_args}, const_true(), s);
+        s = Block::make(s, Free::make("profiling_arg_names"));
+        s = Allocate::make("profiling_arg_names", Handle(), {num_args}, const_true(), s);
+        return s;
+    }
+
+public:
+    RecordArgs(const vector<Argument> &args) {
+        for (const Argument &arg : args) {
+            if (arg.is_scalar() && (arg.type.is_int() || arg.type.is_uint() || arg.type.is_bool())) {
+                values.push_back({arg.name, Variable::make(arg.type, arg.name)});
+            }
+        }
+    }
+
+    Stmt inject(Stmt s) {
+        if (const LetStmt *let = s.as<LetStmt>()) {
+            const Call *c = let->value.as<Call>();
+            if (c && (c->name == Call::buffer_get_min ||
+                      c->name == Call::buffer_get_extent ||
+                      c->name == Call::buffer_get_stride)) {
+                values.push_back({let->name, Variable::make(let->value.type(), let->name)});
+            }
+            return LetStmt::make(let->name, let->value, inject(let->body));
+        } else if (const Block *block = s.as<Block>()) {
+            if (block->first.as<AssertStmt>()) {
+                return Block::make(block->first, inject(block->rest));
+            }
+        }
+        if (values.empty()) {
+            return s;
+        }
+        return Block::make(make_record_call(), s);
+    }
+};
+
+Stmt inject_profiling(Stmt s, string pipeline_name, const vector<Argument> &args) {
     InjectProfiling profiling(pipeline_name);
     s = profiling.mutate(s);
 
+    s = RecordArgs(args).inject(s);
+
     int num_funcs = (int)(profiling.indices.size());
 
     Expr func_names_buf = Variable::make(Handle(), "profiling_func_names");
@@ -24,6 +24,7 @@
  *   argmin:      0.027715ms (46%)   stack: 20
  */
 
+#include "Argument.h"
 #include "IR.h"
 
 namespace Halide {
@@ -33,10 +34,11 @@ namespace Internal {
  * high-resolution timing into the generated code (via spawning a
  * thread that acts as a sampling profiler); summaries of execution
  * times and counts will be logged at the end. Should be done before
- * storage flattening, but after all bounds inference.
- *
+ * storage flattening, but after all bounds inference. The values of
+ * the integer scalar arguments and the buffer shapes seen on each run
+ * are also recorded, for use by Func::specialize_from_profile.
  */
-Stmt inject_profiling(Stmt, std::string);
+Stmt inject_profiling(Stmt, std::string, const std::vector<Argument> &args);
 
 }
 }
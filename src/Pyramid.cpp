@@ -0,0 +1,151 @@
+#include "Pyramid.h"
+
+namespace Halide {
+
+namespace Pyramid {
+
+using std::string;
+using std::vector;
+
+Func downsample(Func f) {
+    user_assert(f.dimensions() >= 2)
+        << "Can't downsample Func " << f.name() << ", which has fewer than two dimensions.\n";
+    Var x("x"), y("y");
+    Func downx(f.name() + "_downx"), downy(f.name() + "_down");
+    downx(x, y, _) = (f(2*x-1, y, _) + 3.0f * (f(2*x, y, _) + f(2*x+1, y, _)) + f(2*x+2, y, _)) / 8.0f;
+    downy(x, y, _) = (downx(x, 2*y-1, _) + 3.0f * (downx(x, 2*y, _) + downx(x, 2*y+1, _)) + downx(x, 2*y+2, _)) / 8.0f;
+    return downy;
+}
+
+Func upsample(Func f) {
+    user_assert(f.dimensions() >= 2)
+        << "Can't upsample Func " << f.name() << ", which has fewer than two dimensions.\n";
+    Var x("x"), y("y");
+    Func upx(f.name() + "_upx"), upy(f.name() + "_up");
+    upx(x, y, _) = 0.25f * f((x/2) - 1 + 2*(x % 2), y, _) + 0.75f * f(x/2, y, _);
+    upy(x, y, _) = 0.25f * upx(x, (y/2) - 1 + 2*(y % 2), _) + 0.75f * upx(x, y/2, _);
+    return upy;
+}
+
+namespace {
+
+// Wrap f in a Func with the given name, so that each level of a
+// pyramid is a distinct Func that can be scheduled independently.
+Func level_func(Func f, const string &name, int level) {
+    Func result(name + "_" + std::to_string(level));
+    result(_) = f(_);
+    return result;
+}
+
+}  // namespace
+
+vector<Func> gaussian(Func f, int levels, const string &name) {
+    user_assert(levels >= 1) << "A pyramid must have at least one level.\n";
+    vector<Func> result = {f};
+    for (int j = 1; j < levels; j++) {
+        result.push_back(level_func(downsample(result[j-1]), name, j));
+    }
+    return result;
+}
+
+vector<Func> gaussian_low_memory(Func f, int levels, int fine_levels,
+                                 vector<Func> *feeder, const string &name) {
+    user_assert(feeder) << "gaussian_low_memory needs somewhere to put the feeder levels.\n";
+    fine_levels = std::max(1, std::min(fine_levels, levels));
+    vector<Func> result = gaussian(f, fine_levels, name);
+    *feeder = gaussian(f, fine_levels, name + "_feeder");
+    for (int j = fine_levels; j < levels; j++) {
+        Func prev = (j == fine_levels) ? feeder->back() : result[j-1];
+        result.push_back(level_func(downsample(prev), name, j));
+    }
+    return result;
+}
+
+vector<Func> laplacian(const vector<Func> &gaussian, const string &name) {
+    const int levels = (int)gaussian.size();
+    user_assert(levels >= 1) << "A pyramid must have at least one level.\n";
+    vector<Func> result(levels);
+    result[levels-1] = level_func(gaussian[levels-1], name, levels-1);
+    for (int j = levels-2; j >= 0; j--) {
+        result[j] = Func(name + "_" + std::to_string(j));
+        result[j](_) = gaussian[j](_) - upsample(gaussian[j+1])(_);
+    }
+    return result;
+}
+
+vector<Func> collapse(const vector<Func> &laplacian, const string &name) {
+    const int levels = (int)laplacian.size();
+    user_assert(levels >= 1) << "A pyramid must have at least one level.\n";
+    vector<Func> result(levels);
+    result[levels-1] = level_func(laplacian[levels-1], name, levels-1);
+    for (int j = levels-2; j >= 0; j--) {
+        result[j] = Func(name + "_" + std::to_string(j));
+        result[j](_) = upsample(result[j+1])(_) + laplacian[j](_);
+    }
+    return result;
+}
+
+void schedule(Func level, LevelPolicy policy, const ScheduleOptions &options) {
+    if (policy == LevelPolicy::Inline) {
+        return;
+    }
+
+    vector<Var> args = level.args();
+    user_assert(args.size() >= 2)
+        << "Can't schedule Func " << level.name() << " as a pyramid level, as it has fewer than two dimensions.\n";
+    Var x = args[0], y = args[1];
+
+    switch (policy) {
+    case LevelPolicy::Root:
+        level.compute_root();
+        if (options.parallel_task_size > 0) {
+            level.parallel(y, options.parallel_task_size);
+        }
+        break;
+    case LevelPolicy::Fused:
+        user_assert(options.compute_level.defined())
+            << "Scheduling pyramid level " << level.name() << " as Fused requires a compute_level.\n";
+        level.compute_at(options.compute_level);
+        break;
+    case LevelPolicy::Streaming:
+        user_assert(options.store_level.defined() && options.compute_level.defined())
+            << "Scheduling pyramid level " << level.name()
+            << " as Streaming requires a store_level and a compute_level.\n";
+        level.store_at(options.store_level).compute_at(options.compute_level);
+        break;
+    case LevelPolicy::Inline:
+        break;
+    }
+
+    if (options.vector_width > 1) {
+        level.vectorize(x, options.vector_width);
+    }
+}
+
+void schedule(const vector<Func> &levels, const vector<LevelPolicy> &policies,
+              const ScheduleOptions &options) {
+    user_assert(levels.size() == policies.size())
+        << "Scheduling a pyramid of " << levels.size() << " levels with "
+        << policies.size() << " policies.\n";
+    for (size_t j = 0; j < levels.size(); j++) {
+        schedule(levels[j], policies[j], options);
+    }
+}
+
+vector<LevelPolicy> policies(int levels, int fine_levels, LevelPolicy fine, LevelPolicy coarse) {
+    vector<LevelPolicy> result;
+    for (int j = 0; j < levels; j++) {
+        if (j == 0) {
+            result.push_back(LevelPolicy::Inline);
+        } else if (j < fine_levels) {
+            result.push_back(fine);
+        } else {
+            result.push_back(coarse);
+        }
+    }
+    return result;
+}
+
+}
+
+}
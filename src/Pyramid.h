@@ -0,0 +1,136 @@
+#ifndef HALIDE_PYRAMID_H
+#define HALIDE_PYRAMID_H
+
+/** \file
+ * Support for building and scheduling multi-scale pyramids of Halide::Funcs.
+ */
+
+#include <string>
+#include <vector>
+
+#include "Func.h"
+
+namespace Halide {
+
+/** namespace to hold functions for building Gaussian and Laplacian
+ *  pyramids of Halide Funcs, and for scheduling their levels.
+ *
+ *  The first two dimensions of every Func passed to these functions
+ *  are taken to be x and y. Pyramids are built over those two
+ *  dimensions, and any others are passed through unchanged. Level 0
+ *  is the finest level, and level j has 1/2^j the resolution of level
+ *  0 in x and y.
+ *
+ *  None of these functions impose a boundary condition; the Func used
+ *  as level 0 should already have one (see BoundaryConditions).
+ *
+ *  Every level other than level 0 is computed with downsample or
+ *  upsample, and so is floating point even when level 0 isn't.
+ */
+namespace Pyramid {
+
+/** Downsample a Func by a factor of two in x and y, with a [1 3 3 1]
+ *  filter in each. The filter is applied in floating point, so the
+ *  result is Float(32), unless f is Float(64), in which case it is
+ *  Float(64). Integer inputs should be cast first if another type
+ *  is wanted. */
+EXPORT Func downsample(Func f);
+
+/** Upsample a Func by a factor of two in x and y, with bilinear
+ *  interpolation. As with downsample, the result is Float(32) unless
+ *  f is Float(64). */
+EXPORT Func upsample(Func f);
+
+/** Make a Gaussian pyramid with the given number of levels. Level 0
+ *  is f itself, and each other level is the downsampled previous
+ *  level. The new levels are called name + "_" + level. */
+EXPORT std::vector<Func> gaussian(Func f, int levels, const std::string &name = "gaussian");
+
+/** Make a Gaussian pyramid as above, but compute the levels from
+ *  fine_levels onwards from a separate copy of the finer levels,
+ *  which is returned in feeder (with f as feeder[0]).
+ *
+ *  The finer levels of the result can then be fused into the
+ *  consumers of the pyramid, and the feeder levels into the first
+ *  coarse level, so that no fine level is ever resident all at once.
+ *  This trades computing the fine levels twice for the memory of the
+ *  whole levels. */
+EXPORT std::vector<Func> gaussian_low_memory(Func f, int levels, int fine_levels,
+                                             std::vector<Func> *feeder,
+                                             const std::string &name = "gaussian");
+
+/** Make the Laplacian pyramid of a Gaussian pyramid. Each level is
+ *  the difference between that level of the Gaussian pyramid and the
+ *  upsampled next level. The last level is the last level of the
+ *  Gaussian pyramid. */
+EXPORT std::vector<Func> laplacian(const std::vector<Func> &gaussian,
+                                   const std::string &name = "laplacian");
+
+/** Collapse a Laplacian pyramid. The last level is the last level of
+ *  the Laplacian pyramid, and each other level is the upsampled next
+ *  level plus that level of the Laplacian pyramid. Level 0 is the
+ *  reconstructed image. */
+EXPORT std::vector<Func> collapse(const std::vector<Func> &laplacian,
+                                  const std::string &name = "collapse");
+
+/** Ways to schedule a level of a pyramid. */
+enum class LevelPolicy {
+    /** Leave the level unscheduled, so that it's inlined (or
+     *  scheduled by the caller). */
+    Inline,
+
+    /** Compute the whole level at root, in parallel over rows. The
+     *  whole level is resident until its last consumer has run. This
+     *  suits coarse levels, which are small and are read by large
+     *  regions of the finer ones. */
+    Root,
+
+    /** Compute the level at ScheduleOptions::compute_level, which is
+     *  typically a tile or strip of a consumer. Only the region that
+     *  iteration needs is resident, but the overlap between
+     *  neighboring iterations is computed more than once. */
+    Fused,
+
+    /** Store the level at ScheduleOptions::store_level, and compute
+     *  it at ScheduleOptions::compute_level, which should be a loop
+     *  over rows within it. Each row is computed once per iteration
+     *  of the store level, and only the rows still needed are kept.
+     *  This uses the least memory. */
+    Streaming,
+};
+
+/** Where and how to schedule levels of a pyramid. */
+struct ScheduleOptions {
+    /** The loop levels used by the Fused and Streaming policies. */
+    LoopLevel store_level, compute_level;
+
+    /** The vector width in x. Zero or one means don't vectorize. */
+    int vector_width = 8;
+
+    /** The number of rows in each parallel task of a level computed
+     *  at root. Zero means compute the level serially. */
+    int parallel_task_size = 8;
+};
+
+/** Schedule one level of a pyramid. */
+EXPORT void schedule(Func level, LevelPolicy policy, const ScheduleOptions &options);
+
+/** Schedule each level of a pyramid with the policy of the same
+ *  index. */
+EXPORT void schedule(const std::vector<Func> &levels,
+                     const std::vector<LevelPolicy> &policies,
+                     const ScheduleOptions &options);
+
+/** Make a list of policies for a pyramid with the given number of
+ *  levels, using fine for the levels below fine_levels and coarse for
+ *  the rest. Level 0 is usually defined and scheduled elsewhere, so it
+ *  is Inline. */
+EXPORT std::vector<LevelPolicy> policies(int levels, int fine_levels,
+                                         LevelPolicy fine,
+                                         LevelPolicy coarse = LevelPolicy::Root);
+
+}
+
+}
+
+#endif
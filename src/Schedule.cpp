@@ -135,9 +135,11 @@ struct ScheduleContents {
     bool memoized;
     bool touched;
     bool allow_race_conditions;
+    LookupStrategy lookup_strategy;
 
     ScheduleContents() : store_level(LoopLevel::inlined()), compute_level(LoopLevel::inlined()), 
-    memoized(false), touched(false), allow_race_conditions(false) {};
+    memoized(false), touched(false), allow_race_conditions(false),
+    lookup_strategy(LookupStrategy::Auto) {};
 
     // Pass an IRMutator through to all Exprs referenced in the ScheduleContents
     void mutate(IRMutator *mutator) {
@@ -205,6 +207,7 @@ Schedule Schedule::deep_copy(
     copy.contents->memoized = contents->memoized;
     copy.contents->touched = contents->touched;
     copy.contents->allow_race_conditions = contents->allow_race_conditions;
+    copy.contents->lookup_strategy = contents->lookup_strategy;
 
     // Deep-copy wrapper functions. If function has already been deep-copied before,
     // i.e. it's in the 'copied_map', use the deep-copied version from the map instead
@@ -230,6 +233,14 @@ bool Schedule::memoized() const {
     return contents->memoized;
 }
 
+LookupStrategy &Schedule::lookup_strategy() {
+    return contents->lookup_strategy;
+}
+
+LookupStrategy Schedule::lookup_strategy() const {
+    return contents->lookup_strategy;
+}
+
 bool &Schedule::touched() {
     return contents->touched;
 }
@@ -44,6 +44,15 @@ enum class TailStrategy {
      * case to handle the if statement. */
     GuardWithIf,
 
+    /** Like GuardWithIf, but when vectorizing, the tail case is
+     * always computed as a single vector iteration with predicated
+     * (masked) loads and stores, instead of being scalarized. Always
+     * legal. Pros: as for GuardWithIf, but with a much cheaper
+     * tail. Best on targets with native masked loads and stores of
+     * every lane width, such as AVX-512. Cons: on targets without
+     * them, the masked loads and stores may be emulated. */
+    Predicate,
+
     /** Prevent evaluation beyond the original extent by shifting
      * the tail case inwards, re-evaluating some points near the
      * end. Only legal for pure variables in pure definitions. If
@@ -88,6 +97,28 @@ enum class PrefetchBoundStrategy {
     NonFaulting
 };
 
+/** Different ways to vectorize data-dependent loads from a Func
+ * that is used as a lookup table. */
+enum class LookupStrategy {
+    /** Hold the table in vector registers and use in-register table
+     * lookup instructions (e.g. pshufb on x86, tbl on ARM) if the
+     * table is provably small enough for the target to do this
+     * cheaply. Otherwise, gather from memory. */
+    Auto,
+
+    /** Always hold the table in vector registers. It is an error if
+     * the indices are not provably within a 256-element range. Tables
+     * larger than the target's native lookup instructions take
+     * several instructions per lookup. Tables of elements the target
+     * can't look up in registers (wider than 16 bits on Hexagon) are
+     * gathered from instead. */
+    Shuffle,
+
+    /** Never hold the table in vector registers. Always gather from
+     * memory. */
+    Gather
+};
+
 /** A reference to a site in a Halide statement at the top of the
  * body of a particular for loop. Evaluating a region of a halide
  * function is done by generating a loop nest that spans its
@@ -265,6 +296,13 @@ public:
     bool memoized() const;
     // @}
 
+    /** How to vectorize data-dependent loads from this function. See
+     * \ref Func::lookup_strategy */
+    // @{
+    LookupStrategy &lookup_strategy();
+    LookupStrategy lookup_strategy() const;
+    // @}
+
     /** This flag is set to true if the dims list has been manipulated
      * by the user (or if a ScheduleHandle was created that could have
      * been used to manipulate it). It controls the warning that
@@ -144,7 +144,12 @@ Stmt build_provide_loop_nest_helper(string func_name,
     // Put all the reduction domain predicates into the containers vector.
     for (Expr pred : predicates) {
         pred = qualify(prefix, pred);
-        Container c = {Container::If, 0, "", likely(pred)};
+        // Predicated tails of RVar splits are already marked as likely.
+        const Call *call = pred.as<Call>();
+        if (!call || !call->is_intrinsic(Call::predicated_tail)) {
+            pred = likely(pred);
+        }
+        Container c = {Container::If, 0, "", pred};
         pred_container.push_back(c);
     }
     int n_predicates = pred_container.size();
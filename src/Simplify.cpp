@@ -3,6 +3,7 @@
 #include <cmath>
 #include <limits>
 #include <stdio.h>
+#include <unordered_map>
 
 #include "Simplify.h"
 #include "IROperator.h"
@@ -89,21 +90,21 @@ bool no_overflow(Type t) {
     return t.is_float() || no_overflow_scalar_int(t.element_of());
 }
 
+// Mark each poison value with an atomic counter, so that the errors
+// can't cancel against each other. The simplifier also watches this
+// counter to avoid memoizing any result that contains a fresh poison
+// value.
+std::atomic<int> poison_counter;
+
 // Make a poison value used when overflow is detected during constant
 // folding.
 Expr signed_integer_overflow_error(Type t) {
-    // Mark each call with an atomic counter, so that the errors can't
-    // cancel against each other.
-    static std::atomic<int> counter;
-    return Call::make(t, Call::signed_integer_overflow, {counter++}, Call::Intrinsic);
+    return Call::make(t, Call::signed_integer_overflow, {poison_counter++}, Call::Intrinsic);
 }
 
 // Make a poison value used when integer div/mod-by-zero is detected during constant folding.
 Expr indeterminate_expression_error(Type t) {
-    // Mark each call with an atomic counter, so that the errors can't
-    // cancel against each other.
-    static std::atomic<int> counter;
-    return Call::make(t, Call::indeterminate_expression, {counter++}, Call::Intrinsic);
+    return Call::make(t, Call::indeterminate_expression, {poison_counter++}, Call::Intrinsic);
 }
 
 // If 'e' is indeterminate_expression of type t,
@@ -176,7 +177,8 @@ static int debug_indent = 0;
 class Simplify : public IRMutator {
 public:
     Simplify(bool r, const Scope<Interval> *bi, const Scope<ModulusRemainder> *ai) :
-        simplify_lets(r) {
+        simplify_lets(r), compare_cache(8), memo(64, MemoKeyHash(), MemoKeyEqual {&compare_cache}),
+        contexts(1, 0) {
         alignment_info.set_containing_scope(ai);
 
         // Only respect the constant bounds from the containing scope.
@@ -195,7 +197,7 @@ public:
         const std::string spaces(debug_indent, ' ');
         debug(1) << spaces << "Simplifying Expr: " << e << "\n";
         debug_indent++;
-        Expr new_e = IRMutator::mutate(e);
+        Expr new_e = mutate_memoized(e);
         debug_indent--;
         if (!new_e.same_as(e)) {
             debug(1)
@@ -204,6 +206,10 @@ public:
         }
         return new_e;
     }
+#else
+    Expr mutate(Expr e) {
+        return mutate_memoized(e);
+    }
 #endif
 
 #if LOG_STMT_MUTATIONS
@@ -236,6 +242,106 @@ private:
     Scope<pair<int64_t, int64_t>> bounds_info;
     Scope<ModulusRemainder> alignment_info;
 
+    // The same Expr often turns up many times within one call to
+    // simplify (e.g. the same index in many unrolled taps, or shared
+    // subexpressions produced by bounds inference). We memoize the
+    // simplified form of each Expr, keyed on its value and on the
+    // scopes above that it was simplified in. Every time we enter a
+    // new set of scopes we give it a fresh id, and when we leave it
+    // we return to the id of the enclosing set, so cached results are
+    // only reused with exactly the bounds, alignment, and let
+    // bindings they were computed with. The memo lives only as long
+    // as this mutator, i.e. one call to simplify.
+    struct MemoKey {
+        Expr e;
+        int context;
+    };
+
+    struct MemoKeyHash {
+        size_t operator()(const MemoKey &k) const {
+            return ExprHash()(k.e) ^ ((size_t)k.context * 0x9e3779b97f4a7c15ULL);
+        }
+    };
+
+    struct MemoKeyEqual {
+        IRCompareCache *cache;
+        bool operator()(const MemoKey &a, const MemoKey &b) const {
+            return a.context == b.context && ExprEqual(cache)(a.e, b.e);
+        }
+    };
+
+    // Simplifying an Expr counts uses of the enclosing let
+    // variables, which decides which lets survive. We record the uses
+    // made while simplifying each memoized Expr, and replay them when
+    // the result is reused.
+    struct VarUse {
+        string name;
+        bool replaced;
+    };
+
+    struct MemoEntry {
+        Expr result;
+        vector<VarUse> uses;
+    };
+
+    IRCompareCache compare_cache;
+    std::unordered_map<MemoKey, MemoEntry, MemoKeyHash, MemoKeyEqual> memo;
+    vector<int> contexts;
+    int next_context = 0;
+    vector<VarUse> use_log;
+    int memo_depth = 0;
+
+    Expr mutate_memoized(const Expr &e) {
+        // Leaves are cheaper to simplify than to look up.
+        if (!e.defined() || e.as<Variable>() || is_const(e)) {
+            return IRMutator::mutate(e);
+        }
+
+        MemoKey key {e, contexts.back()};
+        auto it = memo.find(key);
+        if (it != memo.end()) {
+            for (const VarUse &u : it->second.uses) {
+                count_use(u.name, u.replaced);
+            }
+            return it->second.result;
+        }
+
+        size_t log_start = use_log.size();
+        int old_poison_counter = poison_counter;
+        memo_depth++;
+        Expr result = IRMutator::mutate(e);
+        memo_depth--;
+
+        if (poison_counter == old_poison_counter) {
+            MemoEntry entry {result, vector<VarUse>(use_log.begin() + log_start, use_log.end())};
+            memo.emplace(std::move(key), std::move(entry));
+        }
+        if (memo_depth == 0) {
+            use_log.clear();
+        }
+        return result;
+    }
+
+    void enter_context() {
+        contexts.push_back(++next_context);
+    }
+
+    void leave_context() {
+        contexts.pop_back();
+    }
+
+    void count_use(const string &name, bool replaced) {
+        VarInfo &info = var_info.ref(name);
+        if (replaced) {
+            info.new_uses++;
+        } else {
+            info.old_uses++;
+        }
+        if (memo_depth > 0) {
+            use_log.push_back({name, replaced});
+        }
+    }
+
     // If we encounter a reference to a buffer (a Load, Store, Call,
     // or Provide), there's an implicit dependence on some associated
     // symbols.
@@ -243,17 +349,17 @@ private:
         for (size_t i = 0; i < dimensions; i++) {
             string stride = name + ".stride." + std::to_string(i);
             if (var_info.contains(stride)) {
-                var_info.ref(stride).old_uses++;
+                count_use(stride, false);
             }
 
             string min = name + ".min." + std::to_string(i);
             if (var_info.contains(min)) {
-                var_info.ref(min).old_uses++;
+                count_use(min, false);
             }
         }
 
         if (var_info.contains(name)) {
-            var_info.ref(name).old_uses++;
+            count_use(name, false);
         }
     }
 
@@ -566,12 +672,12 @@ private:
                 internal_assert(info.replacement.type() == op->type) << "Cannot replace variable " << op->name
                     << " of type " << op->type << " with expression of type " << info.replacement.type() << "\n";
                 expr = info.replacement;
-                info.new_uses++;
+                count_use(op->name, true);
             } else {
                 // This expression was not something deemed
                 // substitutable - no replacement is defined.
                 expr = op;
-                info.old_uses++;
+                count_use(op->name, false);
             }
         } else {
             // We never encountered a let that defines this var. Must
@@ -4698,7 +4804,16 @@ private:
             }
         }
 
+        enter_context();
+        size_t use_log_start = use_log.size();
         body = mutate(body);
+        leave_context();
+
+        // Uses of this let variable mean nothing outside of its body,
+        // so memoized Exprs that contain this let shouldn't replay them.
+        use_log.erase(std::remove_if(use_log.begin() + use_log_start, use_log.end(),
+                                     [&](const VarUse &u) { return u.name == op->name; }),
+                      use_log.end());
 
         if (value_alignment_tracked) {
             alignment_info.pop(op->name);
@@ -4794,9 +4909,14 @@ private:
             bounds_info.push(op->name, { new_min_int, new_max_int });
         }
 
+        if (bounds_tracked) {
+            enter_context();
+        }
+
         Stmt new_body = mutate(op->body);
 
         if (bounds_tracked) {
+            leave_context();
             bounds_info.pop(op->name);
         }
 
@@ -6282,6 +6402,18 @@ void simplify_test() {
     check(Evaluate::make(Let::make("x", Call::make(Int(32), "dummy", {3, x, 4}, Call::Extern), Let::make("y", 10, x + y + 2))),
           LetStmt::make("x", Call::make(Int(32), "dummy", {3, x, 4}, Call::Extern), Evaluate::make(x + 12)));
 
+    {
+        // Check that memoized results aren't reused in a different
+        // scope, and that reusing them still keeps the lets they use.
+        Expr e = Call::make(Int(32), "dummy", {x + y}, Call::Extern);
+        Expr e_y3 = Call::make(Int(32), "dummy", {x + 3}, Call::Extern);
+        Expr load = Call::make(Int(32), "dummy", {z}, Call::Extern);
+        check(Block::make(Evaluate::make(e), LetStmt::make("y", 3, Evaluate::make(e))),
+              Block::make(Evaluate::make(e), Evaluate::make(e_y3)));
+        check(LetStmt::make("y", load, Block::make(Evaluate::make(e), Evaluate::make(e))),
+              LetStmt::make("y", load, Block::make(Evaluate::make(e), Evaluate::make(e))));
+    }
+
     // Test case with most negative 32-bit number, as constant to check that it is not negated.
     check(((x * (int32_t)0x80000000) + (y + z * (int32_t)0x80000000)),
           ((x * (int32_t)0x80000000) + (y + z * (int32_t)0x80000000)));
@@ -347,7 +347,8 @@ private:
     void visit(const Call *op) {
         // Ignore likely intrinsics
         if (op->is_intrinsic(Call::likely) ||
-            op->is_intrinsic(Call::likely_if_innermost)) {
+            op->is_intrinsic(Call::likely_if_innermost) ||
+            op->is_intrinsic(Call::predicated_tail)) {
             expr = mutate(op->args[0]);
         } else {
             IRMutator::visit(op);
@@ -115,7 +115,9 @@ public:
     using IRMutator::mutate;
 
     Expr mutate(Expr e) {
-        if (equal(e, find)) {
+        // Comparing structural hashes first means we only walk the
+        // subexpressions that are very likely to match.
+        if (ExprEqual()(e, find)) {
             return replacement;
         } else {
             return IRMutator::mutate(e);
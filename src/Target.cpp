@@ -262,6 +262,8 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"trace_loads", Target::TraceLoads},
     {"trace_stores", Target::TraceStores},
     {"trace_realizations", Target::TraceRealizations},
+    {"fast_compile", Target::FastCompile},
+    {"cpu_dispatch", Target::CPUDispatch},
 };
 
 bool lookup_feature(const std::string &tok, Target::Feature &result) {
@@ -83,6 +83,8 @@ struct Target {
         TraceLoads = halide_target_feature_trace_loads,
         TraceStores = halide_target_feature_trace_stores,
         TraceRealizations = halide_target_feature_trace_realizations,
+        FastCompile = halide_target_feature_fast_compile,
+        CPUDispatch = halide_target_feature_cpu_dispatch,
         FeatureEnd = halide_target_feature_end
     };
     Target() : os(OSUnknown), arch(ArchUnknown), bits(0) {}
@@ -250,11 +252,13 @@ struct Target {
                                has_feature(Halide::Target::AVX512_Cannonlake))) {
                 // AVX512BW exists on Skylake and Cannonlake
                 return 64 / data_size;
-            } else if (t.is_float() && (has_feature(Halide::Target::AVX512) ||
-                                        has_feature(Halide::Target::AVX512_KNL) ||
-                                        has_feature(Halide::Target::AVX512_Skylake) ||
-                                        has_feature(Halide::Target::AVX512_Cannonlake))) {
-                // AVX512F is on all AVX512 architectures
+            } else if ((t.is_float() || data_size >= 4) &&
+                       (has_feature(Halide::Target::AVX512) ||
+                        has_feature(Halide::Target::AVX512_KNL) ||
+                        has_feature(Halide::Target::AVX512_Skylake) ||
+                        has_feature(Halide::Target::AVX512_Cannonlake))) {
+                // AVX512F is on all AVX512 architectures, and covers
+                // floats and 32- and 64-bit integers.
                 return 64 / data_size;
             } else if (has_feature(Halide::Target::AVX2)) {
                 // AVX2 uses 256-bit vectors for everything.
@@ -0,0 +1,63 @@
+#include "TrustedEntryPoint.h"
+#include "IROperator.h"
+#include "Simplify.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// The checks are injected at the top of the pipeline, as a sequence
+// of lets and asserts, possibly under an if for specializations. Keep
+// those, and drop everything else (the producers, the allocations,
+// and any calls made for their side effects).
+Stmt strip_to_checks(Stmt s) {
+    if (const LetStmt *let = s.as<LetStmt>()) {
+        return LetStmt::make(let->name, let->value, strip_to_checks(let->body));
+    } else if (const Block *block = s.as<Block>()) {
+        return Block::make(strip_to_checks(block->first), strip_to_checks(block->rest));
+    } else if (s.as<AssertStmt>()) {
+        return s;
+    } else if (const IfThenElse *op = s.as<IfThenElse>()) {
+        Stmt else_case;
+        if (op->else_case.defined()) {
+            else_case = strip_to_checks(op->else_case);
+        }
+        return IfThenElse::make(op->condition, strip_to_checks(op->then_case), else_case);
+    } else {
+        return Evaluate::make(0);
+    }
+}
+
+}  // namespace
+
+LoweredFunc make_validation_function(const LoweredFunc &fn, const string &name) {
+    Stmt body = simplify(strip_to_checks(fn.body));
+
+    // Without a bounds query, nothing in the pipeline checks that
+    // the buffers are allocated, so check that first. The pipeline's
+    // own checks that the buffer pointers aren't null come too late
+    // to guard this, so repeat them.
+    vector<Stmt> null_checks, host_checks;
+    for (const LoweredArgument &arg : fn.args) {
+        if (!arg.is_buffer()) continue;
+        Expr buf = Variable::make(type_of<struct halide_buffer_t *>(), arg.name + ".buffer");
+        Expr host = Call::make(Handle(), Call::buffer_get_host, {buf}, Call::Extern);
+        Expr error = Call::make(Int(32), "halide_error_buffer_argument_is_null",
+                                {arg.name}, Call::Extern);
+        null_checks.push_back(AssertStmt::make(reinterpret<uint64_t>(buf) != 0, error));
+        host_checks.push_back(AssertStmt::make(reinterpret<uint64_t>(host) != 0, error));
+    }
+    if (!null_checks.empty()) {
+        body = Block::make({Block::make(null_checks), Block::make(host_checks), body});
+    }
+
+    debug(2) << "Validation function for " << fn.name << ":\n" << body << "\n\n";
+    return LoweredFunc(name, fn.args, body, fn.linkage, fn.name_mangling);
+}
+
+}
+}
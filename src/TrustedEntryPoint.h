@@ -0,0 +1,30 @@
+#ifndef HALIDE_TRUSTED_ENTRY_POINT_H
+#define HALIDE_TRUSTED_ENTRY_POINT_H
+
+/** \file
+ *
+ * Defines a pass that turns a lowered pipeline into a function that
+ * only checks its arguments.
+ */
+
+#include "Module.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Given a pipeline fn lowered without bounds query support, make a
+ * LoweredFunc called name with the same arguments that runs only the
+ * argument checks in fn (types, host alignment, sizes and strides,
+ * and scalar constraints), plus a check that every buffer is
+ * allocated. It returns zero if a version of the pipeline compiled
+ * without assertions or bounds query support may safely be called
+ * with the same arguments, or with buffers of the same types, shapes
+ * and host alignments and the same scalar values. The pipeline must not use tracing, the
+ * profiler, or any device API, as these add side effects around the
+ * checks. */
+LoweredFunc make_validation_function(const LoweredFunc &fn, const std::string &name);
+
+}
+}
+
+#endif
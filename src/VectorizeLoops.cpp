@@ -231,11 +231,32 @@ bool uses_gpu_vars(Expr s) {
     return uses.uses_gpu;
 }
 
+bool is_predicated_tail_guard(Expr cond) {
+    const Call *call = cond.as<Call>();
+    return call && call->is_intrinsic(Call::predicated_tail);
+}
+
+// Remove the tags from the guards of splits with
+// TailStrategy::Predicate (see ApplySplit.cpp) once loop
+// vectorization is done with them.
+class RemovePredicatedTailTags : public IRMutator {
+    using IRMutator::visit;
+
+    void visit(const Call *op) {
+        if (op->is_intrinsic(Call::predicated_tail)) {
+            expr = mutate(op->args[0]);
+        } else {
+            IRMutator::visit(op);
+        }
+    }
+};
+
 // Wrap a vectorized predicate around a Load/Store node.
 class PredicateLoadStore : public IRMutator {
     string var;
     Expr vector_predicate;
     bool in_hexagon;
+    bool force;
     const Target &target;
     int lanes;
     bool valid;
@@ -248,7 +269,19 @@ class PredicateLoadStore : public IRMutator {
             internal_assert(target.features_any_of({Target::HVX_64, Target::HVX_128}))
                 << "We are inside a hexagon loop, but the target doesn't have hexagon's features\n";
             return true;
+        } else if (force) {
+            // The schedule asked for a predicated tail. Masked loads
+            // and stores are legal at any width; LLVM emulates them
+            // where there's no native support.
+            return true;
         } else if (target.arch == Target::X86) {
+            // AVX-512 has k-mask predicated moves for 32- and 64-bit
+            // lanes, and AVX512BW adds them for 8- and 16-bit lanes.
+            if (target.features_any_of({Target::AVX512_Skylake, Target::AVX512_Cannonlake})) {
+                return lanes >= 4;
+            } else if (target.features_any_of({Target::AVX512, Target::AVX512_KNL})) {
+                return (bit_size == 32 || bit_size == 64) && (lanes >= 4);
+            }
             // Should only attempt to predicate store/load if the lane size is
             // no less than 4
             return (bit_size == 32) && (lanes >= 4);
@@ -338,8 +371,8 @@ class PredicateLoadStore : public IRMutator {
     }
 
 public:
-    PredicateLoadStore(string v, Expr vpred, bool in_hexagon, const Target &t) :
-            var(v), vector_predicate(vpred), in_hexagon(in_hexagon), target(t),
+    PredicateLoadStore(string v, Expr vpred, bool in_hexagon, bool force, const Target &t) :
+            var(v), vector_predicate(vpred), in_hexagon(in_hexagon), force(force), target(t),
             lanes(vpred.type().lanes()), valid(true), vectorized(false) {
         internal_assert(lanes > 1);
     }
@@ -362,6 +395,10 @@ class VectorSubs : public IRMutator {
 
     bool in_hexagon; // Are we inside the hexagon loop?
 
+    // Is the IfThenElse being visited the guard of a split with
+    // TailStrategy::Predicate?
+    bool in_predicated_tail_guard = false;
+
     // A suffix to attach to widened variables.
     string widening_suffix;
 
@@ -674,6 +711,18 @@ class VectorSubs : public IRMutator {
     }
 
     void visit(const IfThenElse *op) {
+        if (is_predicated_tail_guard(op->condition)) {
+            // Vectorize the untagged guard, remembering that it must
+            // become predicated loads and stores.
+            Stmt untagged = IfThenElse::make(op->condition.as<Call>()->args[0],
+                                             op->then_case, op->else_case);
+            in_predicated_tail_guard = true;
+            visit(untagged.as<IfThenElse>());
+            return;
+        }
+        bool predicated_tail = in_predicated_tail_guard;
+        in_predicated_tail_guard = false;
+
         Expr cond = mutate(op->condition);
         int lanes = cond.type().lanes();
         debug(3) << "Vectorizing over " << var << "\n"
@@ -691,16 +740,21 @@ class VectorSubs : public IRMutator {
             bool vectorize_predicate = !uses_gpu_vars(cond);
             Stmt predicated_stmt;
             if (vectorize_predicate) {
-                PredicateLoadStore p(var, cond, in_hexagon, target);
+                PredicateLoadStore p(var, cond, in_hexagon, predicated_tail, target);
                 predicated_stmt = p.mutate(then_case);
                 vectorize_predicate = p.is_vectorized();
             }
             if (vectorize_predicate && else_case.defined()) {
-                PredicateLoadStore p(var, !cond, in_hexagon, target);
+                PredicateLoadStore p(var, !cond, in_hexagon, predicated_tail, target);
                 predicated_stmt = Block::make(predicated_stmt, p.mutate(else_case));
                 vectorize_predicate = p.is_vectorized();
             }
 
+            if (predicated_tail && !vectorize_predicate) {
+                user_warning << "Could not use predicated loads and stores for the tail of the "
+                             << "loop over " << var << ", so it will be scalarized.\n";
+            }
+
             debug(4) << "IfThenElse should vectorize predicate over var " << var << "? " << vectorize_predicate << "; cond: " << cond << "\n";
             debug(4) << "Predicated stmt:\n" << predicated_stmt << "\n";
 
@@ -955,7 +1009,8 @@ public:
 } // Anonymous namespace
 
 Stmt vectorize_loops(Stmt s, const Target &t) {
-    return VectorizeLoops(t).mutate(s);
+    s = VectorizeLoops(t).mutate(s);
+    return RemovePredicatedTailTags().mutate(s);
 }
 
 }
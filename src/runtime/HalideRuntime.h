@@ -242,6 +242,16 @@ extern int32_t halide_debug_to_file(void *user_context, const char *filename,
                                     int32_t type_code,
                                     struct halide_buffer_t *buf);
 
+/** Wait for any debug_to_file writes still running in the
+ * background to complete. Called at the end of every pipeline that
+ * uses debug_to_file. Returns a non-zero error code if any of the
+ * writes since the last flush failed. Setting the environment
+ * variable HL_DEBUG_TO_FILE_ASYNC=1 makes halide_debug_to_file copy
+ * each realization into a staging buffer and write it on a
+ * background thread, so the pipeline doesn't stall on file I/O.
+ */
+extern int32_t halide_debug_to_file_flush(void *user_context);
+
 /** Types in the halide type system. They can be ints, unsigned ints,
  * or floats (of various bit-widths), or a handle (which is always 64-bits).
  * Note that the int/uint/float values do not imply a specific bit width
@@ -941,7 +951,9 @@ typedef enum halide_target_feature_t {
     halide_target_feature_trace_stores = 44, ///< Trace all stores done by the pipeline. Equivalent to calling Func::trace_stores on every non-inlined Func.
     halide_target_feature_trace_realizations = 45, ///< Trace all realizations done by the pipeline. Equivalent to calling Func::trace_realizations on every non-inlined Func.
     halide_target_feature_cuda_capability61 = 46,  ///< Enable CUDA compute capability 6.1 (Pascal)
-    halide_target_feature_end = 47 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
+    halide_target_feature_fast_compile = 47, ///< Trade code quality for compile speed: run fewer LLVM optimizations, and when jitting, reuse code compiled for structurally identical pipelines.
+    halide_target_feature_cpu_dispatch = 48, ///< Compile extra versions of vectorized loops for newer x86 instruction sets, and choose between them at runtime.
+    halide_target_feature_end = 49 ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
 /** This function is called internally by Halide in some situations to determine
@@ -1291,6 +1303,28 @@ struct halide_profiler_func_stats {
     int num_allocs;
 };
 
+/** The number of distinct values the profiler tracks for each
+ * pipeline argument. */
+#define HALIDE_PROFILER_ARG_VALUES 8
+
+/** The values seen for a scalar argument or a buffer min, extent, or
+ * stride across runs of a pipeline. Used to drive profile-guided
+ * specialization. Only the most frequently seen values are kept; when
+ * a new value arrives and all slots are full, it replaces the least
+ * frequent value and inherits its count, so counts are upper bounds. */
+struct halide_profiler_arg_stats {
+    /** The name of the argument, e.g. "p" or "input.stride.1". A
+     * global constant string. */
+    const char *name;
+
+    /** The values seen, and the number of runs each was seen in. */
+    int64_t values[HALIDE_PROFILER_ARG_VALUES];
+    uint64_t counts[HALIDE_PROFILER_ARG_VALUES];
+
+    /** The number of slots of values and counts in use. */
+    int num_values;
+};
+
 /** Per-pipeline state tracked by the sampling profiler. These exist
  * in a linked list. */
 struct halide_profiler_pipeline_stats {
@@ -1334,6 +1368,11 @@ struct halide_profiler_pipeline_stats {
 
     /** The total number of memory allocation of funcs in this pipeline. */
     int num_allocs;
+
+    /** The number of arguments whose values are tracked, and their
+     * stats. NULL until the pipeline first records its arguments. */
+    int num_args;
+    struct halide_profiler_arg_stats *args;
 };
 
 /** The global state of the profiler. */
@@ -1387,6 +1426,18 @@ extern struct halide_profiler_state *halide_profiler_get_state();
  * This function grabs the global profiler state's lock on entry. */
 extern struct halide_profiler_pipeline_stats *halide_profiler_get_pipeline_state(const char *pipeline_name);
 
+/** Record the values of the scalar arguments and buffer shapes of a
+ * pipeline for profile-guided specialization. Called by the pipeline
+ * itself when compiled with the -profile target flag. If the
+ * environment variable HL_PROFILE_ARGS_FILE is set, the values seen
+ * are written to that file when the profiler reports, in a form that
+ * Func::specialize_from_profile can read. If a pipeline of the same
+ * name is later recorded with a different number of arguments, the
+ * values seen so far are discarded. */
+extern void halide_profiler_record_args(void *user_context, void *pipeline_state,
+                                        int num_args, const uint64_t *arg_names,
+                                        const int64_t *arg_values);
+
 /** Reset all profiler state.
  * WARNING: Do NOT call this method while any halide pipeline is
  * running; halide_profiler_memory_allocate/free and
@@ -35,6 +35,10 @@ WEAK halide_thread *halide_spawn_thread(void (*f)(void *), void *closure) {
     return NULL;
 }
 
+WEAK void halide_join_thread(halide_thread *thread_arg) {
+    // halide_spawn_thread never returns a thread to join.
+}
+
 WEAK void halide_mutex_destroy(halide_mutex *mutex_arg) {
 }
 
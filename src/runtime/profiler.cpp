@@ -45,6 +45,8 @@ WEAK halide_profiler_pipeline_stats *find_or_create_pipeline(const char *pipelin
     p->num_allocs = 0;
     p->active_threads_numerator = 0;
     p->active_threads_denominator = 0;
+    p->num_args = 0;
+    p->args = NULL;
     p->funcs = (halide_profiler_func_stats *)malloc(num_funcs * sizeof(halide_profiler_func_stats));
     if (!p->funcs) {
         free(p);
@@ -197,6 +199,68 @@ WEAK int halide_profiler_pipeline_start(void *user_context,
     return p->first_func_id;
 }
 
+WEAK void halide_profiler_record_args(void *user_context,
+                                      void *pipeline_state,
+                                      int num_args,
+                                      const uint64_t *arg_names,
+                                      const int64_t *arg_values) {
+    halide_profiler_pipeline_stats *p_stats = (halide_profiler_pipeline_stats *) pipeline_state;
+    halide_assert(user_context, p_stats != NULL);
+
+    // This happens once per run, so just take the lock.
+    halide_profiler_state *s = halide_profiler_get_state();
+    ScopedMutexLock lock(&s->lock);
+
+    if (p_stats->args && p_stats->num_args != num_args) {
+        // A different pipeline with the same name has been run under
+        // the same profiler state (e.g. a JIT-compiled pipeline was
+        // redefined). The values seen so far describe arguments that
+        // no longer exist, so start over with the new argument list.
+        free(p_stats->args);
+        p_stats->args = NULL;
+        p_stats->num_args = 0;
+    }
+
+    if (!p_stats->args) {
+        p_stats->args =
+            (halide_profiler_arg_stats *)malloc(num_args * sizeof(halide_profiler_arg_stats));
+        if (!p_stats->args) return;
+        p_stats->num_args = num_args;
+        for (int i = 0; i < num_args; i++) {
+            p_stats->args[i].name = (const char *)(arg_names[i]);
+            p_stats->args[i].num_values = 0;
+        }
+    }
+
+    for (int i = 0; i < num_args; i++) {
+        halide_profiler_arg_stats *a = p_stats->args + i;
+        int64_t val = arg_values[i];
+        int slot = -1, least_frequent = 0;
+        for (int j = 0; j < a->num_values; j++) {
+            if (a->values[j] == val) {
+                slot = j;
+                break;
+            }
+            if (a->counts[j] < a->counts[least_frequent]) {
+                least_frequent = j;
+            }
+        }
+        if (slot < 0) {
+            if (a->num_values < HALIDE_PROFILER_ARG_VALUES) {
+                slot = a->num_values++;
+                a->counts[slot] = 0;
+            } else {
+                // Evict the least frequent value, but keep its count
+                // (the space-saving algorithm). Values that really are
+                // frequent still rise to the top.
+                slot = least_frequent;
+            }
+            a->values[slot] = val;
+        }
+        a->counts[slot]++;
+    }
+}
+
 WEAK void halide_profiler_stack_peak_update(void *user_context,
                                             void *pipeline_state,
                                             uint64_t *f_values) {
@@ -283,6 +347,43 @@ WEAK void halide_profiler_memory_free(void *user_context,
     __sync_sub_and_fetch(&f_stats->memory_current, decr);
 }
 
+// Write out the argument values seen by each pipeline, for use by
+// Func::specialize_from_profile. The format is one line per pipeline:
+//   pipeline <name> <runs>
+// followed by one line per argument:
+//   arg <name> <value>:<count> <value>:<count> ...
+WEAK void halide_profiler_write_args_unlocked(void *user_context, halide_profiler_state *s,
+                                              const char *filename) {
+    void *f = fopen(filename, "w");
+    if (!f) {
+        halide_print(user_context, "Failed to open profile argument file\n");
+        return;
+    }
+
+    char line_buf[1024];
+    Printer<StringStreamPrinter, sizeof(line_buf)> sstr(user_context, line_buf);
+
+    for (halide_profiler_pipeline_stats *p = s->pipelines; p;
+         p = (halide_profiler_pipeline_stats *)(p->next)) {
+        if (!p->runs || !p->args) continue;
+        sstr.clear();
+        sstr << "pipeline " << p->name << " " << p->runs << "\n";
+        fwrite(sstr.str(), sstr.size(), 1, f);
+        for (int i = 0; i < p->num_args; i++) {
+            halide_profiler_arg_stats *a = p->args + i;
+            sstr.clear();
+            sstr << "arg " << a->name;
+            for (int j = 0; j < a->num_values; j++) {
+                sstr << " " << a->values[j] << ":" << a->counts[j];
+            }
+            sstr << "\n";
+            fwrite(sstr.str(), sstr.size(), 1, f);
+        }
+    }
+
+    fclose(f);
+}
+
 WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_state *s) {
 
     char line_buf[1024];
@@ -383,6 +484,11 @@ WEAK void halide_profiler_report_unlocked(void *user_context, halide_profiler_st
             }
         }
     }
+
+    const char *args_file = getenv("HL_PROFILE_ARGS_FILE");
+    if (args_file) {
+        halide_profiler_write_args_unlocked(user_context, s, args_file);
+    }
 }
 
 WEAK void halide_profiler_report(void *user_context) {
@@ -405,6 +511,7 @@ WEAK void halide_profiler_reset() {
         halide_profiler_pipeline_stats *p = s->pipelines;
         s->pipelines = (halide_profiler_pipeline_stats *)(p->next);
         free(p->funcs);
+        free(p->args);
         free(p);
     }
     s->first_free_id = 0;
@@ -34,6 +34,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_cuda_wrap_device_ptr,
     (void *)&halide_current_time_ns,
     (void *)&halide_debug_to_file,
+    (void *)&halide_debug_to_file_flush,
     (void *)&halide_default_can_use_target_features,
     (void *)&halide_device_and_host_free,
     (void *)&halide_device_and_host_free_as_destructor,
@@ -152,6 +153,7 @@ extern "C" __attribute__((used)) void *halide_runtime_api_functions[] = {
     (void *)&halide_profiler_memory_allocate,
     (void *)&halide_profiler_memory_free,
     (void *)&halide_profiler_pipeline_start,
+    (void *)&halide_profiler_record_args,
     (void *)&halide_profiler_report,
     (void *)&halide_profiler_reset,
     (void *)&halide_profiler_stack_peak_update,
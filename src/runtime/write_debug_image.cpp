@@ -1,4 +1,6 @@
 #include "HalideRuntime.h"
+#include "runtime_internal.h"
+#include "scoped_mutex_lock.h"
 
 // Use TIFF because it meets the following criteria:
 // - Supports uncompressed data
@@ -97,35 +99,79 @@ WEAK bool has_tiff_extension(const char *filename) {
     return *f == '\0';
 }
 
-}}} // namespace Halide::Runtime::Internal
+WEAK bool has_npy_extension(const char *filename) {
+    const char *f = filename;
 
-WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *filename,
-                                             int32_t type_code, struct halide_buffer_t *buf) {
+    while (*f != '\0') f++;
+    while (f != filename && *f != '.') f--;
 
-    if (buf->dimensions > 4) {
-        halide_error(user_context, "Can't debug_to_file a Func with more than four dimensions\n");
-        return -1;
-    }
+    if (*f != '.') return false;
+    f++;
 
-    halide_copy_to_host(user_context, buf);
+    if (*f != 'n' && *f != 'N') return false;
+    f++;
 
-    void *f = fopen(filename, "wb");
-    if (!f) return -1;
+    if (*f != 'p' && *f != 'P') return false;
+    f++;
+
+    if (*f != 'y' && *f != 'Y') return false;
+    f++;
+
+    return *f == '\0';
+}
+
+// numpy dtype strings for each type_code, without the byte order.
+WEAK const char *pixel_type_to_npy_dtype[] = {
+  "f4", "f8", "u1", "i1", "u2", "i2", "u4", "i4", "u8", "i8"
+};
 
+// Write the header of the output file. shape always has four
+// entries; 'dimensions' says how many of them are real.
+WEAK int write_debug_image_header(void *f, const char *filename, int32_t type_code,
+                                  int32_t dimensions, const halide_dimension_t *shape,
+                                  int32_t bytes_per_element) {
     size_t elts = 1;
-    halide_dimension_t shape[4];
-    for (int i = 0; i < buf->dimensions && i < 4; i++) {
-        shape[i] = buf->dim[i];
+    for (int i = 0; i < 4; i++) {
         elts *= shape[i].extent;
     }
-    for (int i = buf->dimensions; i < 4; i++) {
-        shape[i].min = 0;
-        shape[i].extent = 1;
-        shape[i].stride = 0;
-    }
-    int32_t bytes_per_element = buf->type.bytes();
 
-    if (has_tiff_extension(filename)) {
+    if (has_npy_extension(filename)) {
+        // The data is written with dimension 0 innermost, so describe
+        // it as a Fortran-order array, which makes numpy indices match
+        // Halide coordinates. See
+        // https://docs.scipy.org/doc/numpy/neps/npy-format.html
+        int32_t one = 1;
+        bool little_endian = *(const char *)&one == 1;
+
+        char header[256];
+        char *end = header + sizeof(header) - 1;
+        char *dst = header + 10;
+        dst = halide_string_to_string(dst, end, "{'descr': '");
+        dst = halide_string_to_string(dst, end, bytes_per_element == 1 ? "|" : (little_endian ? "<" : ">"));
+        dst = halide_string_to_string(dst, end, pixel_type_to_npy_dtype[type_code]);
+        dst = halide_string_to_string(dst, end, "', 'fortran_order': True, 'shape': (");
+        for (int i = 0; i < dimensions; i++) {
+            dst = halide_int64_to_string(dst, end, shape[i].extent, 1);
+            dst = halide_string_to_string(dst, end, ",");
+        }
+        dst = halide_string_to_string(dst, end, "), }");
+        // Pad with spaces and a newline to a multiple of 64 bytes.
+        while ((dst - header + 1) % 64 != 0 && dst < end) {
+            *dst++ = ' ';
+        }
+        *dst++ = '\n';
+
+        size_t total = dst - header;
+        uint16_t header_len = (uint16_t)(total - 10);
+        memcpy(header, "\x93NUMPY", 6);
+        header[6] = 1;
+        header[7] = 0;
+        header[8] = (char)(header_len & 0xff);
+        header[9] = (char)(header_len >> 8);
+        if (!fwrite((void *)header, total, 1, f)) {
+            return -2;
+        }
+    } else if (has_tiff_extension(filename)) {
         int32_t channels;
         int32_t width = shape[0].extent;
         int32_t height = shape[1].extent;
@@ -181,7 +227,6 @@ WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *fil
         header.height_resolution[1] = 1;
 
         if (!fwrite((void *)(&header), sizeof(header), 1, f)) {
-            fclose(f);
             return -2;
         }
 
@@ -190,7 +235,6 @@ WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *fil
 
             for (int32_t i = 0; i < channels; i++) {
                 if (!fwrite((void*)(&offset), 4, 1, f)) {
-                    fclose(f);
                     return -2;
                 }
                 offset += shape[0].extent * shape[1].extent * depth * bytes_per_element;
@@ -198,7 +242,6 @@ WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *fil
             int32_t count = shape[0].extent * shape[1].extent * depth;
             for (int32_t i = 0; i < channels; i++) {
                 if (!fwrite((void*)(&count), 4, 1, f)) {
-                    fclose(f);
                     return -2;
                 }
             }
@@ -210,10 +253,183 @@ WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *fil
                             shape[3].extent,
                             type_code};
         if (!fwrite((void *)(&header[0]), sizeof(header), 1, f)) {
-            fclose(f);
             return -2;
         }
     }
+    return 0;
+}
+
+// State for writing debug images on background threads. Each
+// realization is copied into a staging buffer, which is then handed to
+// one of a small pool of jobs and written out by a thread spawned for
+// it. The staging buffer is freed once the write completes.
+struct debug_image_job {
+    halide_thread *thread;
+    void *user_context;
+    const char *filename;
+    int32_t type_code;
+    int32_t dimensions;
+    halide_dimension_t shape[4];
+    int32_t bytes_per_element;
+    uint8_t *data;
+    size_t size;
+    int result;
+};
+
+#define HALIDE_DEBUG_IMAGE_JOBS 4
+WEAK debug_image_job debug_image_jobs[HALIDE_DEBUG_IMAGE_JOBS];
+WEAK int next_debug_image_job = 0;
+WEAK halide_mutex debug_image_jobs_lock = { { 0 } };
+// The first failure since the last flush.
+WEAK int debug_image_job_error = 0;
+WEAK const char *debug_image_job_error_filename = NULL;
+// -1 until the environment has been checked.
+WEAK int debug_image_async = -1;
+
+WEAK void write_debug_image_job(void *arg) {
+    debug_image_job *job = (debug_image_job *)arg;
+    void *f = fopen(job->filename, "wb");
+    if (!f) {
+        job->result = -1;
+        return;
+    }
+    job->result = write_debug_image_header(f, job->filename, job->type_code, job->dimensions,
+                                           job->shape, job->bytes_per_element);
+    if (job->result == 0 && job->size > 0 && !fwrite((void *)job->data, job->size, 1, f)) {
+        job->result = -1;
+    }
+    fclose(f);
+}
+
+// Wait for the write using a job to complete, record its result,
+// and free its staging buffer. Must be called with
+// debug_image_jobs_lock held.
+WEAK void finish_debug_image_job(debug_image_job *job) {
+    if (job->thread) {
+        halide_join_thread(job->thread);
+        job->thread = NULL;
+        if (job->result != 0 && debug_image_job_error == 0) {
+            debug_image_job_error = job->result;
+            debug_image_job_error_filename = job->filename;
+        }
+    }
+    if (job->data) {
+        halide_free(job->user_context, job->data);
+        job->data = NULL;
+    }
+}
+
+}}} // namespace Halide::Runtime::Internal
+
+WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *filename,
+                                             int32_t type_code, struct halide_buffer_t *buf) {
+
+    if (buf->dimensions > 4) {
+        halide_error(user_context, "Can't debug_to_file a Func with more than four dimensions\n");
+        return -1;
+    }
+
+    halide_copy_to_host(user_context, buf);
+
+    size_t elts = 1;
+    halide_dimension_t shape[4];
+    for (int i = 0; i < buf->dimensions && i < 4; i++) {
+        shape[i] = buf->dim[i];
+        elts *= shape[i].extent;
+    }
+    for (int i = buf->dimensions; i < 4; i++) {
+        shape[i].min = 0;
+        shape[i].extent = 1;
+        shape[i].stride = 0;
+    }
+    int32_t bytes_per_element = buf->type.bytes();
+
+    if (debug_image_async < 0) {
+        const char *async = getenv("HL_DEBUG_TO_FILE_ASYNC");
+        debug_image_async = (async && async[0] == '1') ? 1 : 0;
+    }
+
+    if (debug_image_async) {
+        // Gather the data into a staging buffer in the order it will
+        // be written. This is done before taking the lock, so that
+        // producers only serialize on handing the buffer off.
+        size_t size = elts * bytes_per_element;
+        uint8_t *data = (uint8_t *)halide_malloc(user_context, size);
+        if (!data) {
+            return -1;
+        }
+        uint8_t *dst = data;
+        const size_t row_bytes = shape[0].extent * bytes_per_element;
+        for (int32_t dim3 = shape[3].min; dim3 < shape[3].extent + shape[3].min; ++dim3) {
+            for (int32_t dim2 = shape[2].min; dim2 < shape[2].extent + shape[2].min; ++dim2) {
+                for (int32_t dim1 = shape[1].min; dim1 < shape[1].extent + shape[1].min; ++dim1) {
+                    int idx[] = {shape[0].min, dim1, dim2, dim3};
+                    uint8_t *src = buf->address_of(idx);
+                    if (shape[0].stride == 1) {
+                        memcpy(dst, src, row_bytes);
+                        dst += row_bytes;
+                    } else {
+                        for (int32_t dim0 = 0; dim0 < shape[0].extent; ++dim0) {
+                            memcpy(dst, src, bytes_per_element);
+                            src += shape[0].stride * bytes_per_element;
+                            dst += bytes_per_element;
+                        }
+                    }
+                }
+            }
+        }
+
+        debug_image_job sync_job;
+        {
+            ScopedMutexLock lock(&debug_image_jobs_lock);
+
+            // A Func computed inside a loop writes the same file
+            // repeatedly. The last write must win, so wait for any
+            // earlier write to the same file first.
+            for (int i = 0; i < HALIDE_DEBUG_IMAGE_JOBS; i++) {
+                if (debug_image_jobs[i].thread && strcmp(debug_image_jobs[i].filename, filename) == 0) {
+                    finish_debug_image_job(&debug_image_jobs[i]);
+                }
+            }
+
+            debug_image_job *job = &debug_image_jobs[next_debug_image_job];
+            next_debug_image_job = (next_debug_image_job + 1) % HALIDE_DEBUG_IMAGE_JOBS;
+            finish_debug_image_job(job);
+
+            job->user_context = user_context;
+            job->data = data;
+            job->filename = filename;
+            job->type_code = type_code;
+            job->dimensions = buf->dimensions;
+            for (int i = 0; i < 4; i++) {
+                job->shape[i] = shape[i];
+            }
+            job->bytes_per_element = bytes_per_element;
+            job->size = size;
+            job->result = 0;
+            job->thread = halide_spawn_thread(write_debug_image_job, job);
+            if (job->thread) {
+                return 0;
+            }
+
+            // No threads on this platform. Take the job back, and
+            // write it below without holding the lock.
+            sync_job = *job;
+            job->data = NULL;
+        }
+        write_debug_image_job(&sync_job);
+        halide_free(user_context, data);
+        return sync_job.result;
+    }
+
+    void *f = fopen(filename, "wb");
+    if (!f) return -1;
+
+    int header_result = write_debug_image_header(f, filename, type_code, buf->dimensions, shape, bytes_per_element);
+    if (header_result != 0) {
+        fclose(f);
+        return header_result;
+    }
 
     // Reorder the data according to the strides.
     const int TEMP_SIZE = 4*1024;
@@ -252,3 +468,21 @@ WEAK extern "C" int32_t halide_debug_to_file(void *user_context, const char *fil
 
     return 0;
 }
+
+WEAK extern "C" int32_t halide_debug_to_file_flush(void *user_context) {
+    if (debug_image_async <= 0) {
+        return 0;
+    }
+    ScopedMutexLock lock(&debug_image_jobs_lock);
+    for (int i = 0; i < HALIDE_DEBUG_IMAGE_JOBS; i++) {
+        finish_debug_image_job(&debug_image_jobs[i]);
+    }
+    int result = debug_image_job_error;
+    const char *failed = debug_image_job_error_filename;
+    debug_image_job_error = 0;
+    debug_image_job_error_filename = NULL;
+    if (result != 0) {
+        return halide_error_debug_to_file_failed(user_context, "(background write)", failed, result);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <string>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    printf("Skipping test because it uses setenv\n");
+    return 0;
+#else
+    std::string report = Internal::get_test_tmp_dir() + "compile_timing.json";
+    Internal::ensure_no_file_exists(report);
+
+    // The variable is read the first time anything is compiled.
+    setenv("HL_COMPILE_TIMING", report.c_str(), 1);
+
+    Func f, g;
+    Var x, y;
+    f(x, y) = x + y;
+    g(x, y) = f(x - 1, y) + f(x + 1, y);
+    f.compute_at(g, y);
+    g.vectorize(x, 4);
+
+    Buffer<int> out = g.realize(16, 16);
+
+    Internal::assert_file_exists(report);
+
+    bool found_lowering_pass = false, found_llvm_stage = false;
+    std::ifstream in(report);
+    std::string line;
+    int lines = 0;
+    while (std::getline(in, line)) {
+        lines++;
+        if (line.empty() || line[0] != '{' || line.back() != '}' ||
+            line.find("\"seconds\": ") == std::string::npos ||
+            line.find("\"ir_nodes\": ") == std::string::npos) {
+            printf("Malformed line in compile timing report: %s\n", line.c_str());
+            return -1;
+        }
+        if (line.find("\"pass\": \"vectorizing\"") != std::string::npos) {
+            found_lowering_pass = true;
+            if (line.find("\"ir_nodes\": -1") != std::string::npos) {
+                printf("Lowering pass has no IR node count: %s\n", line.c_str());
+                return -1;
+            }
+        }
+        if (line.find("\"stage\": \"llvm\"") != std::string::npos) {
+            found_llvm_stage = true;
+        }
+    }
+
+    if (!found_lowering_pass || !found_llvm_stage) {
+        printf("Compile timing report is missing passes (%d lines)\n", lines);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+#endif
+}
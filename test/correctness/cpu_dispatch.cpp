@@ -0,0 +1,73 @@
+#include "Halide.h"
+#include <stdio.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Target host = get_jit_target_from_environment();
+    if (host.arch != Target::X86) {
+        printf("Skipping test because CPUDispatch is x86-only\n");
+        return 0;
+    }
+
+    // Start from a baseline x86 target, so that there is something to
+    // dispatch to on most machines.
+    Target t = host;
+    for (Target::Feature f : {Target::SSE41, Target::AVX, Target::AVX2, Target::FMA, Target::F16C,
+                              Target::AVX512, Target::AVX512_KNL, Target::AVX512_Skylake,
+                              Target::AVX512_Cannonlake}) {
+        t.set_feature(f, false);
+    }
+    t.set_feature(Target::CPUDispatch);
+
+    ImageParam in(Int(32), 2);
+    Var x, y;
+    Func f, g;
+    f(x, y) = in(x, y) * 3 + 1;
+    g(x, y) = f(x, y) * f(x, y) + y;
+    f.compute_at(g, y).vectorize(x, 8);
+    g.vectorize(x, 16).parallel(y);
+
+    // The vectorized loops should have been multi-versioned, and the
+    // scalar loop over y left alone.
+    std::string stmt_file = Internal::get_test_tmp_dir() + "cpu_dispatch.stmt";
+    Internal::ensure_no_file_exists(stmt_file);
+    g.compile_to_lowered_stmt(stmt_file, {in}, Text, t);
+    Internal::assert_file_exists(stmt_file);
+    std::ifstream stmt_in(stmt_file);
+    std::stringstream stmt;
+    stmt << stmt_in.rdbuf();
+    if (stmt.str().find(".cpu_dispatch_avx2") == std::string::npos ||
+        stmt.str().find("halide_can_use_target_features") == std::string::npos) {
+        printf("Loops were not multi-versioned:\n%s\n", stmt.str().c_str());
+        return -1;
+    }
+
+    Buffer<int> input(100, 50);
+    for (int y = 0; y < 50; y++) {
+        for (int x = 0; x < 100; x++) {
+            input(x, y) = x - y;
+        }
+    }
+    in.set(input);
+
+    Buffer<int> out = g.realize(96, 50, t);
+    for (int y = 0; y < 50; y++) {
+        for (int x = 0; x < 96; x++) {
+            int fx = input(x, y) * 3 + 1;
+            int correct = fx * fx + y;
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
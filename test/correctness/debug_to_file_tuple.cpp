@@ -0,0 +1,95 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+
+// Check the header of a .npy file, and leave the file positioned at
+// the start of the data.
+bool check_npy_header(FILE *f, const char *descr, const char *shape) {
+    char magic[10];
+    if (fread(magic, 1, 10, f) != 10 || memcmp(magic, "\x93NUMPY", 6) != 0) {
+        printf("Bad npy magic number\n");
+        return false;
+    }
+    int header_len = (uint8_t)magic[8] | ((uint8_t)magic[9] << 8);
+    if ((10 + header_len) % 64 != 0) {
+        printf("npy header is not padded to a multiple of 64 bytes\n");
+        return false;
+    }
+    std::string header(header_len, ' ');
+    if (fread(&header[0], 1, header_len, f) != (size_t)header_len) {
+        printf("Truncated npy header\n");
+        return false;
+    }
+    if (header.find(descr) == std::string::npos ||
+        header.find(shape) == std::string::npos ||
+        header.find("'fortran_order': True") == std::string::npos) {
+        printf("Unexpected npy header: %s\n", header.c_str());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+#ifndef _WIN32
+    // Exercise the background writer too. All files must be complete
+    // by the time realize returns.
+    setenv("HL_DEBUG_TO_FILE_ASYNC", "1", 1);
+#endif
+
+    std::string f_npy = Internal::get_test_tmp_dir() + "debug_to_file_tuple_f.npy";
+    std::string f0_npy = Internal::get_test_tmp_dir() + "debug_to_file_tuple_f.0.npy";
+    std::string f1_npy = Internal::get_test_tmp_dir() + "debug_to_file_tuple_f.1.npy";
+
+    Internal::ensure_no_file_exists(f0_npy);
+    Internal::ensure_no_file_exists(f1_npy);
+
+    {
+        Func f, g;
+        Var x, y;
+        f(x, y) = Tuple(x + y, cast<uint8_t>(x * y));
+        g(x, y) = f(x, y)[0] + f(x, y)[1];
+
+        f.compute_root().debug_to_file(f_npy);
+
+        Buffer<int> im = g.realize(10, 8);
+    }
+
+    Internal::assert_file_exists(f0_npy);
+    Internal::assert_file_exists(f1_npy);
+
+    FILE *f0 = fopen(f0_npy.c_str(), "rb");
+    FILE *f1 = fopen(f1_npy.c_str(), "rb");
+    assert(f0 && f1);
+
+    if (!check_npy_header(f0, "'descr': '<i4'", "'shape': (10,8,)") ||
+        !check_npy_header(f1, "'descr': '|u1'", "'shape': (10,8,)")) {
+        return -1;
+    }
+
+    int32_t f0_data[10*8];
+    uint8_t f1_data[10*8];
+    assert(fread((void *)(&f0_data[0]), 4, 10*8, f0) == 10*8);
+    assert(fread((void *)(&f1_data[0]), 1, 10*8, f1) == 10*8);
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 10; x++) {
+            if (f0_data[y*10+x] != x+y) {
+                printf("f0_data[%d, %d] = %d instead of %d\n", x, y, f0_data[y*10+x], x+y);
+                return -1;
+            }
+            if (f1_data[y*10+x] != (uint8_t)(x*y)) {
+                printf("f1_data[%d, %d] = %d instead of %d\n", x, y, f1_data[y*10+x], x*y);
+                return -1;
+            }
+        }
+    }
+    fclose(f0);
+    fclose(f1);
+
+    printf("Success!\n");
+    return 0;
+}
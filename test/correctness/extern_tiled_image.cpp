@@ -0,0 +1,110 @@
+#include "Halide.h"
+#include "halide_tiled_image.h"
+#include <stdio.h>
+
+using namespace Halide;
+using Halide::Tools::TiledImageFile;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+int loaded_min[2], loaded_extent[2];
+int load_calls = 0;
+
+extern "C" DLLEXPORT int load_tiles(void *file, halide_buffer_t *out) {
+    if (out->host) {
+        load_calls++;
+        for (int d = 0; d < 2; d++) {
+            loaded_min[d] = out->dim[d].min;
+            loaded_extent[d] = out->dim[d].extent;
+        }
+    }
+    return Halide::Tools::load_tiled_image_region(file, out);
+}
+
+int main(int argc, char **argv) {
+    const int W = 256, H = 192;
+    Buffer<uint16_t> image(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            image(x, y) = (uint16_t)(x * 3 + y * 5);
+        }
+    }
+
+    const char *filename = "extern_tiled_image.tiled";
+    {
+        TiledImageFile file;
+        int tile_extents[] = {32, 16};
+        if (!file.save(filename, image.raw_buffer(), tile_extents)) {
+            printf("Failed to write %s\n", filename);
+            return -1;
+        }
+    }
+
+    TiledImageFile file;
+    if (!file.open(filename)) {
+        printf("Failed to open %s\n", filename);
+        return -1;
+    }
+
+    // Reading a region through the ImageParam-style path.
+    {
+        Buffer<uint16_t> region(40, 30);
+        region.set_min(100, 50);
+        if (!file.read_region(region.raw_buffer())) {
+            printf("read_region failed\n");
+            return -1;
+        }
+        for (int y = 50; y < 80; y++) {
+            for (int x = 100; x < 140; x++) {
+                if (region(x, y) != image(x, y)) {
+                    printf("region(%d, %d) = %d instead of %d\n", x, y, region(x, y), image(x, y));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // Feeding a pipeline through an extern stage. Only the region
+    // required by the output should be loaded.
+    Param<void *> handle;
+    handle.set(&file);
+
+    Func input;
+    input.define_extern("load_tiles", {handle}, UInt(16), 2);
+
+    Var x, y;
+    Func blur;
+    blur(x, y) = (input(x - 1, y) + input(x, y) + input(x + 1, y)) / 3;
+
+    Buffer<uint16_t> out(64, 32);
+    out.set_min(70, 90);
+    blur.realize(out);
+
+    for (int y = 90; y < 122; y++) {
+        for (int x = 70; x < 134; x++) {
+            uint16_t correct = (image(x - 1, y) + image(x, y) + image(x + 1, y)) / 3;
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    if (load_calls != 1 ||
+        loaded_min[0] != 69 || loaded_extent[0] != 66 ||
+        loaded_min[1] != 90 || loaded_extent[1] != 32) {
+        printf("Loaded the wrong region: [%d, %d] x [%d, %d] in %d calls\n",
+               loaded_min[0], loaded_extent[0], loaded_min[1], loaded_extent[1], load_calls);
+        return -1;
+    }
+
+    file.close();
+    remove(filename);
+
+    printf("Success!\n");
+    return 0;
+}
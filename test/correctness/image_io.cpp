@@ -42,6 +42,147 @@ void test_round_trip(Buffer<uint8_t> buf, std::string format) {
     }
 }
 
+// Check that the memory-mapped and row-streaming PGM/PPM readers give
+// the same pixels as load(). buf has one channel for PGM, or three for
+// PPM.
+template<typename T>
+void test_mapped_and_streamed(Runtime::Buffer<T> buf, std::string format) {
+    const int width = buf.width(), height = buf.height(), channels = buf.channels();
+    std::string name = Internal::get_test_tmp_dir() + "test_mapped_" + std::to_string(sizeof(T) * 8);
+    std::string filename = name + "." + format;
+    Tools::save_image(buf, filename);
+
+    Runtime::Buffer<T> loaded = Tools::load_image(filename);
+    auto check = [&](T actual, int x, int y, int c, const char *what) {
+        T correct = loaded.dimensions() == 2 ? loaded(x, y) : loaded(x, y, c);
+        if (actual != correct || actual != buf(x, y, c)) {
+            printf("%s of %d-bit %s: %d instead of %d at (%d, %d, %d)\n",
+                   what, (int)sizeof(T) * 8, format.c_str(), (int)actual, (int)correct, x, y, c);
+            abort();
+        }
+    };
+
+    // Map the file.
+    {
+        Tools::MappedFile file;
+        Runtime::Buffer<T> mapped;
+        if (!Tools::map_pnm(filename, &file, &mapped)) {
+            printf("Could not map %s\n", filename.c_str());
+            abort();
+        }
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                for (int c = 0; c < channels; c++) {
+                    check(channels == 1 ? mapped(x, y) : mapped(x, y, c), x, y, c, "map_pnm");
+                }
+            }
+        }
+    }
+
+    // Write the pixels out after a short header, interleaved and
+    // planar, and map them raw.
+    const size_t offset = 16;
+    for (bool interleaved : {true, false}) {
+        std::string raw_filename = name + (interleaved ? "_interleaved.raw" : "_planar.raw");
+        {
+            std::vector<T> data(offset / sizeof(T), 0);
+            for (int plane = 0; plane < (interleaved ? 1 : channels); plane++) {
+                for (int y = 0; y < height; y++) {
+                    for (int x = 0; x < width; x++) {
+                        for (int c = 0; c < channels; c++) {
+                            if (interleaved || c == plane) {
+                                data.push_back(buf(x, y, c));
+                            }
+                        }
+                    }
+                }
+            }
+            FILE *f = fopen(raw_filename.c_str(), "wb");
+            fwrite(data.data(), sizeof(T), data.size(), f);
+            fclose(f);
+        }
+        Tools::MappedFile file;
+        Runtime::Buffer<T> mapped;
+        if (!Tools::map_raw(raw_filename, &file, &mapped, width, height, channels, interleaved, offset)) {
+            printf("Could not map %s\n", raw_filename.c_str());
+            abort();
+        }
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                for (int c = 0; c < channels; c++) {
+                    check(channels == 1 ? mapped(x, y) : mapped(x, y, c), x, y, c, "map_raw");
+                }
+            }
+        }
+    }
+
+    // Stream the file a row at a time, and then in strips into a
+    // buffer with nonzero mins. The last strip is short.
+    {
+        Tools::PNMRowReader reader;
+        if (!reader.open(filename) ||
+            reader.width() != width || reader.height() != height || reader.channels() != channels ||
+            reader.bit_depth() != (int)sizeof(T) * 8) {
+            printf("Could not open %s as a stream\n", filename.c_str());
+            abort();
+        }
+        std::vector<T> row(width * channels);
+        for (int y = 0; y < height; y++) {
+            if (!reader.read_row(row.data())) {
+                printf("Could not read row %d of %s\n", y, filename.c_str());
+                abort();
+            }
+            for (int x = 0; x < width; x++) {
+                for (int c = 0; c < channels; c++) {
+                    check(row[x * channels + c], x, y, c, "PNMRowReader::read_row");
+                }
+            }
+        }
+    }
+    {
+        Tools::PNMRowReader reader;
+        reader.open(filename);
+        const int strip_height = 7, x_min = -3, y_min = 100, c_min = 2;
+        for (int y0 = 0; y0 < height; y0 += strip_height) {
+            const int rows = std::min(strip_height, height - y0);
+            Runtime::Buffer<T> strip = channels == 1 ?
+                Runtime::Buffer<T>(width, rows) :
+                Runtime::Buffer<T>::make_interleaved(width, rows, channels);
+            if (channels == 1) {
+                strip.set_min(x_min, y_min);
+            } else {
+                strip.set_min(x_min, y_min, c_min);
+            }
+            if (!reader.read_rows(&strip)) {
+                printf("Could not read rows %d to %d of %s\n", y0, y0 + rows, filename.c_str());
+                abort();
+            }
+            for (int y = 0; y < rows; y++) {
+                for (int x = 0; x < width; x++) {
+                    for (int c = 0; c < channels; c++) {
+                        T actual = channels == 1 ?
+                            strip(x + x_min, y + y_min) :
+                            strip(x + x_min, y + y_min, c + c_min);
+                        check(actual, x, y0 + y, c, "PNMRowReader::read_rows");
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename T>
+void test_mapped_and_streamed() {
+    const int width = 123, height = 45;
+    for (int channels : {1, 3}) {
+        Runtime::Buffer<T> buf(width, height, channels);
+        buf.for_each_value([](T &v) {
+            v = (T)(rand() * 2654435761u >> 8);
+        });
+        test_mapped_and_streamed(buf, channels == 1 ? "pgm" : "ppm");
+    }
+}
+
 Func make_noise(int depth) {
     Func f;
     Var x, y, c;
@@ -83,6 +224,10 @@ int main(int argc, char **argv) {
             test_round_trip(luma_buf, format);
         }
     }
+
+    test_mapped_and_streamed<uint8_t>();
+    test_mapped_and_streamed<uint16_t>();
+
     return 0;
 }
 
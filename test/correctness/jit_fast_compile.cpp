@@ -0,0 +1,84 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// Define a small pipeline from fresh Funcs, and run it.
+int run(const Target &t, ImageParam in, Param<int> p, int k) {
+    Var x;
+    Func f, g;
+    f(x) = in(x) * k + p;
+    g(x) = f(x) + f(x + 1);
+    g.vectorize(x, 4);
+
+    Buffer<int> input(17);
+    for (int i = 0; i < 17; i++) {
+        input(i) = i;
+    }
+    in.set(input);
+
+    Buffer<int> out(16);
+    g.realize(out, t);
+    return out(15);
+}
+
+// Define a pipeline that scales its input by a float constant, and
+// run it.
+float run_scaled(const Target &t, ImageParam in, float k) {
+    Var x;
+    Func f;
+    f(x) = cast<float>(in(x)) * k;
+
+    Buffer<float> out(16);
+    f.realize(out, t);
+    return out(15);
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment().with_feature(Target::FastCompile);
+
+    ImageParam in(Int(32), 1);
+    Param<int> p;
+    p.set(3);
+
+    // Identical pipelines built from fresh Funcs must keep working.
+    for (int i = 0; i < 5; i++) {
+        int result = run(t, in, p, 2);
+        int correct = (15 * 2 + 3) + (16 * 2 + 3);
+        if (result != correct) {
+            printf("Iteration %d: result = %d instead of %d\n", i, result, correct);
+            return -1;
+        }
+    }
+
+    // Structurally different pipelines must not reuse each other's code.
+    int result = run(t, in, p, 5);
+    int correct = (15 * 5 + 3) + (16 * 5 + 3);
+    if (result != correct) {
+        printf("Different constant: result = %d instead of %d\n", result, correct);
+        return -1;
+    }
+
+    // Nor may a pipeline that differs only in its parameter values
+    // compute the wrong thing.
+    p.set(10);
+    result = run(t, in, p, 5);
+    correct = (15 * 5 + 10) + (16 * 5 + 10);
+    if (result != correct) {
+        printf("Different parameter: result = %d instead of %d\n", result, correct);
+        return -1;
+    }
+
+    // Float constants that only differ beyond the precision the IR
+    // is printed with must not share code either.
+    float scaled_1 = run_scaled(t, in, 1e-7f);
+    float scaled_2 = run_scaled(t, in, 2e-7f);
+    if (scaled_1 != 15 * 1e-7f || scaled_2 != 15 * 2e-7f) {
+        printf("Different float constant: results = %g and %g instead of %g and %g\n",
+               scaled_1, scaled_2, 15 * 1e-7f, 15 * 2e-7f);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// Apply a lookup table of the given size to some noise, with the
+// given strategy, and check the result.
+template<typename T>
+bool test(int table_size, LookupStrategy strategy, int vector_width) {
+    const int size = 1024;
+    Buffer<uint8_t> input(size);
+    for (int i = 0; i < size; i++) {
+        input(i) = (uint8_t)(rand() & 0xff);
+    }
+
+    Var x;
+    Func lut, f;
+    lut(x) = cast<T>(x * 7 + 3);
+    f(x) = lut(cast<int>(input(x)) % table_size);
+
+    lut.compute_root().lookup_strategy(strategy);
+    f.vectorize(x, vector_width);
+
+    Buffer<T> out = f.realize(size);
+    for (int i = 0; i < size; i++) {
+        T correct = (T)((input(i) % table_size) * 7 + 3);
+        if (out(i) != correct) {
+            printf("Table of %d, width %d: out(%d) = %d instead of %d\n",
+                   table_size, vector_width, i, (int)out(i), (int)correct);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    for (int w : {8, 16, 32}) {
+        for (int table_size : {4, 16, 32, 64}) {
+            if (!test<uint8_t>(table_size, LookupStrategy::Auto, w) ||
+                !test<int8_t>(table_size, LookupStrategy::Auto, w) ||
+                !test<uint8_t>(table_size, LookupStrategy::Gather, w)) {
+                return -1;
+            }
+        }
+        // Forcing the shuffle works for tables too large for a single
+        // instruction, and for wider types.
+        for (int table_size : {16, 100, 256}) {
+            if (!test<uint8_t>(table_size, LookupStrategy::Shuffle, w) ||
+                !test<uint16_t>(table_size, LookupStrategy::Shuffle, w)) {
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -350,6 +350,40 @@ int vectorized_predicated_predicate_with_pure_call_test() {
     return 0;
 }
 
+int predicated_tail_test() {
+    // The input is exactly as large as the output, so the vector tail
+    // must not read or write out of bounds.
+    const int size = 37;
+    Buffer<uint8_t> input(size, 5);
+    input.for_each_element([&](int x, int y) { input(x, y) = (uint8_t)(x * 3 + y); });
+
+    Var x("x"), y("y");
+    Func f("f");
+    f(x, y) = input(x, y) * 2 + 1;
+
+    Target target = get_jit_target_from_environment();
+    if (target.features_any_of({Target::HVX_64, Target::HVX_128})) {
+        f.hexagon().vectorize(x, 64, TailStrategy::Predicate);
+    } else {
+        // Predicated tails are requested by the schedule, so 8-bit
+        // lanes get predicated on every target.
+        f.vectorize(x, 16, TailStrategy::Predicate);
+        f.add_custom_lowering_pass(new CheckPredicatedStoreLoad(true, true));
+    }
+
+    Buffer<uint8_t> im = f.realize(size, 5);
+    for (int y = 0; y < im.height(); y++) {
+        for (int x = 0; x < im.width(); x++) {
+            uint8_t correct = (uint8_t)(input(x, y) * 2 + 1);
+            if (im(x, y) != correct) {
+                printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
 int main(int argc, char **argv) {
     printf("Running vectorized dense load with stride minus one test\n");
     if (vectorized_dense_load_with_stride_minus_one_test() != 0) {
@@ -391,6 +425,11 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    printf("Running predicated tail test\n");
+    if (predicated_tail_test() != 0) {
+        return -1;
+    }
+
     printf("Success!\n");
     return 0;
 }
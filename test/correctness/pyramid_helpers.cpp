@@ -0,0 +1,129 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <math.h>
+
+using namespace Halide;
+using namespace Halide::Pyramid;
+
+using std::vector;
+
+const int W = 67, H = 45, levels = 4;
+
+// Check that two realizations agree to within a tolerance.
+bool check_close(const Buffer<float> &a, const Buffer<float> &b, float tol, const char *what) {
+    for (int y = 0; y < a.height(); y++) {
+        for (int x = 0; x < a.width(); x++) {
+            if (fabs(a(x, y) - b(x, y)) > tol) {
+                printf("%s: %f instead of %f at (%d, %d)\n", what, a(x, y), b(x, y), x, y);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Buffer<float> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (rand() % 1024) / 1024.0f;
+        }
+    }
+
+    Var x("x"), y("y");
+
+    // Downsampling must match the [1 3 3 1] filter, with the boundary
+    // condition applied at level 0.
+    {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        vector<Func> g = gaussian(clamped, levels);
+        Buffer<float> down = g[1].realize(W / 2, H / 2);
+        auto in = [&](int x, int y) {
+            return input(std::min(std::max(x, 0), W - 1), std::min(std::max(y, 0), H - 1));
+        };
+        const float k[] = {1, 3, 3, 1};
+        for (int y = 0; y < H / 2; y++) {
+            for (int x = 0; x < W / 2; x++) {
+                float correct = 0;
+                for (int j = 0; j < 4; j++) {
+                    for (int i = 0; i < 4; i++) {
+                        correct += k[i] * k[j] * in(2*x - 1 + i, 2*y - 1 + j);
+                    }
+                }
+                correct /= 64;
+                if (fabs(down(x, y) - correct) > 1e-5f) {
+                    printf("down(%d, %d) = %f instead of %f\n", x, y, down(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // Collapsing the Laplacian pyramid of a Gaussian pyramid must
+    // reconstruct the input, under every schedule policy.
+    Buffer<float> reference;
+    const LevelPolicy fine_policies[] = {LevelPolicy::Inline, LevelPolicy::Root,
+                                         LevelPolicy::Fused, LevelPolicy::Streaming};
+    for (LevelPolicy fine : fine_policies) {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        vector<Func> g = gaussian(clamped, levels);
+        vector<Func> out = collapse(laplacian(g));
+        Func output("output");
+        output(x, y) = out[0](x, y);
+
+        Var yo("yo");
+        output.split(y, yo, y, 16).parallel(yo).vectorize(x, 8);
+        ScheduleOptions options;
+        options.store_level = LoopLevel(output, yo);
+        options.compute_level = LoopLevel(output, y);
+        schedule(g, policies(levels, 2, LevelPolicy::Root), options);
+        schedule(out, policies(levels, 2, fine), options);
+
+        Buffer<float> result = output.realize(W, H);
+        if (!check_close(result, input, 1e-4f, "collapse")) {
+            return -1;
+        }
+        if (!reference.defined()) {
+            reference = result;
+        } else if (!check_close(result, reference, 1e-5f, "scheduled collapse")) {
+            return -1;
+        }
+    }
+
+    // The low memory Gaussian pyramid must compute the same coarse
+    // levels as the ordinary one, with its fine levels streamed into
+    // the first coarse level.
+    {
+        Func clamped = BoundaryConditions::repeat_edge(input);
+        vector<Func> g = gaussian(clamped, levels);
+        vector<Func> feeder;
+        vector<Func> g_low = gaussian_low_memory(clamped, levels, 2, &feeder);
+        if (g_low.size() != (size_t)levels || feeder.size() != 2) {
+            printf("gaussian_low_memory made %d levels and %d feeder levels\n",
+                   (int)g_low.size(), (int)feeder.size());
+            return -1;
+        }
+
+        Func coarse = g_low[2];
+        vector<Var> args = coarse.args();
+        Var yo("yo");
+        coarse.compute_root().split(args[1], yo, args[1], 4);
+        ScheduleOptions options;
+        options.store_level = LoopLevel(coarse, yo);
+        options.compute_level = LoopLevel(coarse, args[1]);
+        schedule(feeder, policies(2, 2, LevelPolicy::Streaming), options);
+
+        Func output("output");
+        output(x, y) = g_low[levels - 1](x, y);
+        Func correct("correct");
+        correct(x, y) = g[levels - 1](x, y);
+
+        const int w = W >> (levels - 1), h = H >> (levels - 1);
+        if (!check_close(output.realize(w, h), correct.realize(w, h), 1e-5f, "gaussian_low_memory")) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "Halide.h"
+#include <stdio.h>
+#include <cmath>
+#include <limits>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int W = 37, H = 1000;
+    Buffer<int> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (rand() % 256) - 128;
+        }
+    }
+
+    Var x("x"), y("y");
+
+    // A cumulative sum that doesn't start at the beginning of the Func,
+    // with a block size that doesn't divide the domain.
+    {
+        Func f("f");
+        RDom r(10, H - 10);
+        f(x) = x * 3;
+        f(r) = f(r - 1) + input(3, r);
+        f.update(0).scan_parallel(r, 64);
+
+        Buffer<int> out = f.realize(H);
+        int correct = 9 * 3;
+        for (int i = 0; i < H; i++) {
+            if (i < 10) {
+                correct = i * 3;
+            } else {
+                correct += input(3, i);
+            }
+            if (out(i) != correct) {
+                printf("f(%d) = %d instead of %d\n", i, out(i), correct);
+                return -1;
+            }
+        }
+    }
+
+    // A summed-area table, scanning the columns and then the rows.
+    {
+        Func cols("cols"), sat("sat");
+        RDom ry(0, H), rx(0, W);
+        cols(x, y) = 0;
+        cols(x, ry) = cols(x, ry - 1) + input(x, ry);
+        sat(x, y) = 0;
+        sat(rx, y) = sat(rx - 1, y) + cols(rx, y);
+
+        cols.compute_root();
+        cols.update(0).scan_parallel(ry, 100).update(0).vectorize(x, 8, TailStrategy::GuardWithIf);
+        sat.update(0).scan_parallel(rx, 16);
+
+        Buffer<int> out = sat.realize(W, H);
+        Buffer<int> correct(W, H);
+        for (int j = 0; j < H; j++) {
+            for (int i = 0; i < W; i++) {
+                correct(i, j) = input(i, j);
+                if (i > 0) correct(i, j) += correct(i - 1, j);
+                if (j > 0) correct(i, j) += correct(i, j - 1);
+                if (i > 0 && j > 0) correct(i, j) -= correct(i - 1, j - 1);
+                if (out(i, j) != correct(i, j)) {
+                    printf("sat(%d, %d) = %d instead of %d\n", i, j, out(i, j), correct(i, j));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A running argmin, which is a Tuple-valued scan.
+    {
+        Func f("argmin");
+        RDom r(0, H);
+        f(x) = {std::numeric_limits<int>::max(), -1};
+        f(r) = {min(f(r - 1)[0], input(0, r)),
+                select(f(r - 1)[0] < input(0, r), f(r - 1)[1], r)};
+        f.update(0).scan_parallel(r, 128);
+
+        Realization result = f.realize(H);
+        Buffer<int> min_value = result[0], min_index = result[1];
+        int correct_value = std::numeric_limits<int>::max(), correct_index = -1;
+        for (int i = 0; i < H; i++) {
+            if (!(correct_value < input(0, i))) {
+                correct_value = input(0, i);
+                correct_index = i;
+            }
+            if (min_value(i) != correct_value || min_index(i) != correct_index) {
+                printf("argmin(%d) = (%d, %d) instead of (%d, %d)\n", i,
+                       min_value(i), min_index(i), correct_value, correct_index);
+                return -1;
+            }
+        }
+    }
+
+    // A first-order IIR filter down the columns, as in
+    // apps/HelloMatlab/iir_blur.cpp. This is a linear recurrence
+    // rather than an associative op on the values.
+    {
+        Buffer<float> in(W, H);
+        in.for_each_value([](float &v) { v = (rand() % 1024) / 1024.0f; });
+
+        const float alpha = 0.1f;
+        Func blur("blur");
+        RDom ry(1, H - 1);
+        blur(x, y) = in(x, y);
+        blur(x, ry) = (1 - alpha) * blur(x, ry - 1) + alpha * in(x, ry);
+        blur.update(0).scan_parallel(ry, 64);
+
+        Buffer<float> out = blur.realize(W, H);
+        for (int i = 0; i < W; i++) {
+            float correct = in(i, 0);
+            for (int j = 0; j < H; j++) {
+                if (j > 0) {
+                    correct = (1 - alpha) * correct + alpha * in(i, j);
+                }
+                if (std::abs(out(i, j) - correct) > 1e-4f) {
+                    printf("blur(%d, %d) = %f instead of %f\n", i, j, out(i, j), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A linear recurrence with a coefficient that varies along the
+    // scan, in integers, so the result must match exactly.
+    {
+        Func f("f_linear");
+        RDom r(1, H - 1);
+        f(x) = 1;
+        f(r) = f(r - 1) * select(r % 7 == 0, -1, 1) + input(1, r);
+        f.update(0).scan_parallel(r, 50);
+
+        Buffer<int> out = f.realize(H);
+        int correct = 1;
+        for (int i = 0; i < H; i++) {
+            if (i > 0) {
+                correct = correct * (i % 7 == 0 ? -1 : 1) + input(1, i);
+            }
+            if (out(i) != correct) {
+                printf("f_linear(%d) = %d instead of %d\n", i, out(i), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
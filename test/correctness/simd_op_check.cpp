@@ -38,6 +38,7 @@ struct Task {
     string name;
     int vector_width;
     Expr expr;
+    TailStrategy tail;
 };
 
 size_t num_threads = Halide::Internal::ThreadPool<void>::num_processors_online();
@@ -186,23 +187,28 @@ struct Test {
         return wildcard_match("*" + p + "*", str);
     }
 
-    TestResult check_one(const string &op, const string &name, int vector_width, Expr e) const {
+    TestResult check_one(const string &op, const string &name, int vector_width, Expr e,
+                         TailStrategy tail) const {
         std::ostringstream error_msg;
 
+        // If we're checking how the tail is handled, make sure
+        // there is one.
+        const int width = (tail == TailStrategy::Auto) ? W : W - 1;
+
         // Define a vectorized Func that uses the pattern.
         Func f(name);
         f(x, y) = e;
-        f.bound(x, 0, W).vectorize(x, vector_width);
+        f.bound(x, 0, width).vectorize(x, vector_width, tail);
         f.compute_root();
 
         // Include a scalar version
         Func f_scalar("scalar_" + name);
         f_scalar(x, y) = e;
-        f_scalar.bound(x, 0, W);
+        f_scalar.bound(x, 0, width);
         f_scalar.compute_root();
 
         // The output to the pipeline is the maximum absolute difference as a double.
-        RDom r(0, W, 0, H);
+        RDom r(0, width, 0, H);
         Func error("error_" + name);
         error() = cast<double>(maximum(absd(f(r.x, r.y), f_scalar(r.x, r.y))));
 
@@ -254,7 +260,7 @@ struct Test {
         return { op, error_msg.str() };
     }
 
-    void check(string op, int vector_width, Expr e) {
+    void check(string op, int vector_width, Expr e, TailStrategy tail = TailStrategy::Auto) {
         // Make a name for the test by uniquing then sanitizing the op name
         string name = "op_" + op;
         for (size_t i = 0; i < name.size(); i++) {
@@ -268,7 +274,7 @@ struct Test {
         // settings.
         if (!wildcard_match(filter, op)) return;
 
-        tasks.emplace_back(Task {op, name, vector_width, e});
+        tasks.emplace_back(Task {op, name, vector_width, e, tail});
     }
 
     void check_sse_all() {
@@ -446,6 +452,13 @@ struct Test {
                 check("pabsw", 4*w, abs(i16_1));
                 check("pabsd", 2*w, abs(i32_1));
             }
+
+            // Pairwise multiply-adds of unsigned and signed bytes
+            for (int w = 1; w <= 2; w++) {
+                check("pmaddubsw", 8*w, i16(u8_1) * 3 + i16(u8_2) * 4);
+                check("pmaddubsw", 8*w, i16(u8_1) * 3 + i16(u8_2) * 4 + i16(u8_3) * 5 + i16(u8_1 + 1) * 6);
+                check("pmaddubsw", 8*w, i16_sat(i32(u8_1) * i32(i8_2) + i32(u8_2) * i32(i8_1)));
+            }
         }
 
         // SSE 4.1
@@ -454,6 +467,8 @@ struct Test {
         for (int w = 2; w <= 4; w++) {
             check("pmaddwd", 2*w, i32(i16_1) * 3 + i32(i16_2) * 4);
             check("pmaddwd", 2*w, i32(i16_1) * 3 - i32(i16_2) * 4);
+            // Dot products with more than two terms pair up the products
+            check("pmaddwd", 2*w, i32(i16_1) * 3 + i32(i16_2) * 4 + i32(i16_3) * 5 + i32(u8_1) * 6);
         }
 
         if (use_avx2) {
@@ -478,6 +493,9 @@ struct Test {
                 check("pblend*b", 8*w, select(u8_1 == 7, u8_1, u8_2));
                 check("pblend*b", 8*w, select(u8_1 <= 7, i8_1, i8_2));
 
+                // Lookups in small tables use pshufb
+                check("pshufb", 8*w, in_u8(u8_1 % 16));
+
                 check("pmaxsb", 8*w, max(i8_1, i8_2));
                 check("pminsb", 8*w, min(i8_1, i8_2));
                 check("pmaxuw", 4*w, max(u16_1, u16_2));
@@ -608,6 +626,8 @@ struct Test {
             check("vpabsw", 16, abs(i16_1));
             check("vpabsd", 8, abs(i32_1));
 
+            check("vpmaddubsw", 16, i16(u8_1) * 3 + i16(u8_2) * 4);
+
             // llvm doesn't distinguish between signed and unsigned multiplies
             // check("vpmuldq", 8, i64(i32_1) * i64(i32_2));
             if (!use_avx512) {
@@ -630,6 +650,13 @@ struct Test {
             check("vpcmpeqq" YMM, 4, select(i64_1 == i64_2, i64(1), i64(2)));
             check("vpackusdw", 16, u16(clamp(i32_1, 0, max_u16)));
             check("vpcmpgtq" YMM, 4, select(i64_1 > i64_2, i64(1), i64(2)));
+
+            // Data-dependent loads of 32 and 64-bit values that fill a
+            // register use native gathers.
+            check("vgatherdps", 8, in_f32(u8_1));
+            check("vpgatherdd", 8, in_i32(u8_1));
+            check("vgatherdpd", 4, in_f64(u8_1));
+            check("vpgatherdq", 4, in_i64(u8_1));
         }
 
         if (use_avx512) {
@@ -647,6 +674,12 @@ struct Test {
             check("vreducepd", 8, f64_1 - trunc(f64_1));
             check("vreducepd", 8, f64_1 - trunc(f64_1*8)/8);
 #endif
+
+            // Vector tails should use k-mask predicated stores
+            check("vmovups*{%k", 16, f32_1 * 2.0f, TailStrategy::Predicate);
+            check("vmovupd*{%k", 8, f64_1 * f64(2), TailStrategy::Predicate);
+            check("vmovdqu32*{%k", 16, i32_1 + i32_2, TailStrategy::Predicate);
+            check("vmovdqu64*{%k", 8, i64_1 + i64_2, TailStrategy::Predicate);
         }
         if (use_avx512_skylake) {
             check("vpabsq", 8, abs(i64_1));
@@ -654,6 +687,11 @@ struct Test {
             check("vpminuq", 8, min(u64_1, u64_2));
             check("vpmaxsq", 8, max(i64_1, i64_2));
             check("vpminsq", 8, min(i64_1, i64_2));
+
+            // AVX512BW adds predicated moves for 8- and 16-bit lanes
+            check("vmovdqu8*{%k", 64, u8_1 + u8_2, TailStrategy::Predicate);
+            check("vmovdqu16*{%k", 32, u16_1 + u16_2, TailStrategy::Predicate);
+            check("vmovdqu8*{%k", 64, u8_1 + u8_2, TailStrategy::GuardWithIf);
         }
     }
 
@@ -1407,7 +1445,12 @@ struct Test {
 
         // VTBL X       -       Table Lookup
         // Arm's version of shufps. Allows for arbitrary permutations of a
-        // 64-bit vector. We typically use vrev variants instead.
+        // 64-bit vector. We typically use vrev variants instead. We also
+        // use it for lookups in small tables.
+        for (int w = 1; w <= 2; w++) {
+            check(arm32 ? "vtbl.8" : "tbl", 8*w, in_u8(u8_1 % 32));
+            check(arm32 ? "vtbl.8" : "tbl", 8*w, in_i8(u8_1 % 16));
+        }
 
         // VTBX X       -       Table Extension
         // Like vtbl, but doesn't change any elements where the index was
@@ -2053,7 +2096,7 @@ check("v*.w += vrmpy(v*.b,v*.b)", hvx_width, i32_1 + i32(i8_1)*i8_1 + i32(i8_2)*
         std::vector<std::future<TestResult>> futures;
         for (const Task &task : tasks) {
             futures.push_back(pool.async([this, task]() {
-                return check_one(task.op, task.name, task.vector_width, task.expr);
+                return check_one(task.op, task.name, task.vector_width, task.expr, task.tail);
             }));
         }
 
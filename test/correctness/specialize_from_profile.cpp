@@ -0,0 +1,140 @@
+#include "Halide.h"
+#include <stdio.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+
+bool check(Func f, ImageParam in, Param<int> scale, int width, int s, const Target &t) {
+    Buffer<uint8_t> input(width, 8);
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < width; x++) {
+            input(x, y) = (uint8_t)(x + y * 3);
+        }
+    }
+    in.set(input);
+    scale.set(s);
+
+    Buffer<int> out = f.realize(width, 8, t);
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < width; x++) {
+            int correct = input(x, y) * s + y;
+            if (out(x, y) != correct) {
+                printf("width %d, scale %d: out(%d, %d) = %d instead of %d\n",
+                       width, s, x, y, out(x, y), correct);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    // A profile in the format written by the profiler runtime when
+    // HL_PROFILE_ARGS_FILE is set.
+    std::string profile_file = Internal::get_test_tmp_dir() + "specialize_from_profile.txt";
+    {
+        std::ofstream profile(profile_file);
+        profile << "pipeline f 10\n"
+                << "arg scale 3:9 5:1\n"
+                << "arg in.min.0 0:10\n"
+                << "arg in.extent.0 64:10\n"
+                << "arg in.stride.0 1:10\n"
+                << "arg in.stride.1 64:4 100:3 128:3\n"
+                << "arg unused 7:10\n";
+    }
+
+    ImageParam in(UInt(8), 2, "in");
+    Param<int> scale("scale");
+    Var x("x"), y("y");
+    Func f("f");
+    f(x, y) = cast<int>(in(x, y)) * scale + y;
+    f.specialize_from_profile(profile_file).vectorize(x, 8);
+
+    std::string stmt_file = Internal::get_test_tmp_dir() + "specialize_from_profile.stmt";
+    Internal::ensure_no_file_exists(stmt_file);
+    f.compile_to_lowered_stmt(stmt_file, f.infer_arguments());
+    Internal::assert_file_exists(stmt_file);
+    std::ifstream stmt_in(stmt_file);
+    std::stringstream stmt;
+    stmt << stmt_in.rdbuf();
+
+    // The dominant values should be specialized on, and the one with
+    // no dominant value should not.
+    for (const char *cond : {"scale == 3", "in.extent.0 == 64", "in.stride.0 == 1"}) {
+        if (stmt.str().find(cond) == std::string::npos) {
+            printf("Missing specialization on %s:\n%s\n", cond, stmt.str().c_str());
+            return -1;
+        }
+    }
+    if (stmt.str().find("in.stride.1 == ") != std::string::npos) {
+        printf("Unexpected specialization on in.stride.1:\n%s\n", stmt.str().c_str());
+        return -1;
+    }
+
+    // Both the specialized and the generic paths must be correct. Run
+    // with the profiler on, so that the argument values get recorded.
+    Target t = get_jit_target_from_environment().with_feature(Target::Profile);
+    if (!check(f, in, scale, 64, 3, t) ||
+        !check(f, in, scale, 64, 5, t) ||
+        !check(f, in, scale, 40, 3, t)) {
+        return -1;
+    }
+
+#ifndef _WIN32
+    // Now do the round trip: profile an unspecialized pipeline, and
+    // specialize a fresh definition of it from the profile the
+    // profiler wrote. The JIT reports (and so writes the file) after
+    // each realize.
+    std::string recorded_file = Internal::get_test_tmp_dir() + "specialize_from_profile_recorded.txt";
+    Internal::ensure_no_file_exists(recorded_file);
+    setenv("HL_PROFILE_ARGS_FILE", recorded_file.c_str(), 1);
+
+    Func g("g");
+    g(x, y) = cast<int>(in(x, y)) * scale + y;
+    if (!check(g, in, scale, 48, 7, t)) {
+        return -1;
+    }
+    unsetenv("HL_PROFILE_ARGS_FILE");
+
+    Internal::assert_file_exists(recorded_file);
+    std::ifstream recorded_in(recorded_file);
+    std::stringstream recorded;
+    recorded << recorded_in.rdbuf();
+    for (const char *line : {"pipeline g 1\n", "arg scale 7:1\n", "arg in.extent.0 48:1\n"}) {
+        if (recorded.str().find(line) == std::string::npos) {
+            printf("Missing \"%s\" in recorded profile:\n%s\n", line, recorded.str().c_str());
+            return -1;
+        }
+    }
+
+    Func h("h");
+    h(x, y) = cast<int>(in(x, y)) * scale + y;
+    h.specialize_from_profile(recorded_file, "g").vectorize(x, 8);
+
+    std::string recorded_stmt_file = Internal::get_test_tmp_dir() + "specialize_from_profile_recorded.stmt";
+    Internal::ensure_no_file_exists(recorded_stmt_file);
+    h.compile_to_lowered_stmt(recorded_stmt_file, h.infer_arguments());
+    Internal::assert_file_exists(recorded_stmt_file);
+    std::ifstream recorded_stmt_in(recorded_stmt_file);
+    std::stringstream recorded_stmt;
+    recorded_stmt << recorded_stmt_in.rdbuf();
+    for (const char *cond : {"scale == 7", "in.extent.0 == 48"}) {
+        if (recorded_stmt.str().find(cond) == std::string::npos) {
+            printf("Missing specialization on %s:\n%s\n", cond, recorded_stmt.str().c_str());
+            return -1;
+        }
+    }
+
+    if (!check(h, in, scale, 48, 7, t) ||
+        !check(h, in, scale, 48, 2, t)) {
+        return -1;
+    }
+#endif
+
+    printf("Success!\n");
+    return 0;
+}
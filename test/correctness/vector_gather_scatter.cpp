@@ -0,0 +1,80 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// A permutation of [0, size) that is far from affine.
+int permute(int i, int size) {
+    return (i * 37 + 11) % size;
+}
+
+template<typename T>
+bool test(int vector_width) {
+    const int size = 256;
+    Target target = get_jit_target_from_environment();
+
+    Buffer<T> input(size);
+    Buffer<int> perm(size);
+    for (int i = 0; i < size; i++) {
+        input(i) = (T)(i * 3 + 1);
+        perm(i) = permute(i, size);
+    }
+
+    // A data-dependent load: a gather.
+    {
+        Func f;
+        Var x;
+        f(x) = input(perm(x));
+        f.vectorize(x, vector_width);
+        Buffer<T> out = f.realize(size, target);
+        for (int i = 0; i < size; i++) {
+            T correct = input(permute(i, size));
+            if (out(i) != correct) {
+                printf("Gather of %d x %s: out(%d) = %f instead of %f\n",
+                       vector_width, type_of<T>().is_float() ? "float" : "int",
+                       i, (double)out(i), (double)correct);
+                return false;
+            }
+        }
+    }
+
+    // A data-dependent store: a scatter. The permutation means no two
+    // lanes collide, so vectorizing the RVar is safe.
+    {
+        Func g;
+        Var x;
+        RDom r(0, size);
+        g(x) = cast<T>(0);
+        g(clamp(perm(r), 0, size - 1)) = input(r);
+        g.update().allow_race_conditions().vectorize(r, vector_width);
+        Buffer<T> out = g.realize(size, target);
+        for (int i = 0; i < size; i++) {
+            T correct = input(i);
+            if (out(permute(i, size)) != correct) {
+                printf("Scatter of %d x %s: out(%d) = %f instead of %f\n",
+                       vector_width, type_of<T>().is_float() ? "float" : "int",
+                       permute(i, size), (double)out(permute(i, size)), (double)correct);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    // Cover widths below, at, and above the native gather widths.
+    for (int w : {4, 8, 16, 32}) {
+        if (!test<uint8_t>(w) ||
+            !test<int16_t>(w) ||
+            !test<int32_t>(w) ||
+            !test<float>(w) ||
+            !test<int64_t>(w) ||
+            !test<double>(w)) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "HalideRuntime.h"
+#include "HalideBuffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "blur3x3.h"
+#include "halide_benchmark.h"
+
+using namespace Halide::Runtime;
+using namespace Halide::Tools;
+
+const int W = 64, H = 48, N = 64;
+const int offset = 3;
+
+int error_count = 0;
+
+void my_halide_error(void *user_context, const char *msg) {
+    // Count, but don't print, the expected errors.
+    error_count++;
+}
+
+int main(int argc, char **argv) {
+    // The blur has no boundary condition, so each input has a
+    // one-pixel border around the output.
+    Buffer<uint8_t> input(W + 2, H + 2, N), output(W, H, N), correct(W, H, N);
+    input.translate({-1, -1, 0});
+    input.for_each_value([](uint8_t &v) { v = (uint8_t)(rand() & 0xff); });
+
+    // The plain entry point, one item at a time.
+    auto run_plain = [&]() {
+        for (int i = 0; i < N; i++) {
+            Buffer<uint8_t> in_i = input.sliced(2, i), out_i = correct.sliced(2, i);
+            int result = blur3x3(in_i, offset, out_i);
+            if (result != 0) {
+                printf("blur3x3 failed on item %d: %d\n", i, result);
+                exit(-1);
+            }
+        }
+    };
+
+    // The batch entry point, all at once.
+    auto run_batch = [&]() {
+        int result = blur3x3_batch(input, offset, output);
+        if (result != 0) {
+            printf("blur3x3_batch failed: %d\n", result);
+            exit(-1);
+        }
+    };
+
+    run_plain();
+    run_batch();
+    for (int i = 0; i < N; i++) {
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (output(x, y, i) != correct(x, y, i)) {
+                    printf("output(%d, %d, %d) = %d instead of %d\n",
+                           x, y, i, output(x, y, i), correct(x, y, i));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // A batch of one, and an empty batch.
+    {
+        Buffer<uint8_t> in_1 = input.cropped(2, 5, 1), out_1(W, H, 1);
+        if (blur3x3_batch(in_1, offset, out_1) != 0) {
+            printf("blur3x3_batch failed on a batch of one\n");
+            return -1;
+        }
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                if (out_1(x, y, 0) != correct(x, y, 5)) {
+                    printf("out_1(%d, %d) = %d instead of %d\n",
+                           x, y, out_1(x, y, 0), correct(x, y, 5));
+                    return -1;
+                }
+            }
+        }
+        Buffer<uint8_t> in_0(W + 2, H + 2, 0), out_0(W, H, 0);
+        in_0.translate({-1, -1, 0});
+        if (blur3x3_batch(in_0, offset, out_0) != 0) {
+            printf("blur3x3_batch failed on an empty batch\n");
+            return -1;
+        }
+    }
+
+    // Mismatched batch sizes, and unallocated buffers (the batch entry
+    // point doesn't do bounds queries), must fail without running any
+    // items.
+    halide_error_handler_t old_handler = halide_set_error_handler(&my_halide_error);
+    {
+        Buffer<uint8_t> in_short = input.cropped(2, 0, N - 1);
+        int result = blur3x3_batch(in_short, offset, output);
+        if (result != halide_error_code_constraint_violated || error_count != 1) {
+            printf("Expected a constraint violation for mismatched batch sizes, got %d\n", result);
+            return -1;
+        }
+        Buffer<uint8_t> in_query(nullptr, W + 2, H + 2, N);
+        in_query.translate({-1, -1, 0});
+        result = blur3x3_batch(in_query, offset, output);
+        if (result != halide_error_code_buffer_argument_is_null || error_count != 2) {
+            printf("Expected an error for an unallocated input, got %d\n", result);
+            return -1;
+        }
+    }
+    halide_set_error_handler(old_handler);
+
+    double t_plain = benchmark(run_plain);
+    double t_batch = benchmark(run_batch);
+    printf("%d items of %dx%d: plain entry point in a loop %f ms, batch entry point %f ms\n",
+           N, W, H, t_plain * 1e3, t_batch * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,37 @@
+#include "Halide.h"
+
+namespace {
+
+// A 3x3 blur with an intermediate, and no boundary condition, used to
+// test the extra entry points. It's built with batch_entry_point=true
+// and trusted_entry_point=true, and shared by the batch_blur and
+// trusted_tile tests.
+class Blur3x3 : public Halide::Generator<Blur3x3> {
+public:
+    Input<Buffer<uint8_t>> input{ "input", 2 };
+    Input<int32_t> offset{ "offset", 0, -64, 64 };
+
+    Output<Buffer<uint8_t>> output{ "output", 2 };
+
+    void generate() {
+        Func wide;
+        wide(x, y) = cast<uint16_t>(input(x, y));
+
+        blur_x(x, y) = wide(x - 1, y) + 2 * wide(x, y) + wide(x + 1, y);
+        Expr blur_y = blur_x(x, y - 1) + 2 * blur_x(x, y) + blur_x(x, y + 1);
+        output(x, y) = cast<uint8_t>(clamp(cast<int32_t>((blur_y + 8) / 16) + offset, 0, 255));
+    }
+
+    void schedule() {
+        blur_x.compute_at(output, y).vectorize(x, natural_vector_size<uint16_t>());
+        output.vectorize(x, natural_vector_size<uint8_t>());
+    }
+
+private:
+    Var x{"x"}, y{"y"};
+    Func blur_x{"blur_x"};
+};
+
+Halide::RegisterGenerator<Blur3x3> register_my_gen{"blur3x3"};
+
+}  // namespace
@@ -0,0 +1,127 @@
+#include "HalideRuntime.h"
+#include "HalideBuffer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "blur3x3.h"
+#include "halide_benchmark.h"
+
+using namespace Halide::Runtime;
+using namespace Halide::Tools;
+
+const int T = 64, tiles_x = 16, tiles_y = 16;
+const int W = T * tiles_x, H = T * tiles_y;
+const int offset = 3;
+
+int error_count = 0;
+
+void my_halide_error(void *user_context, const char *msg) {
+    // Count, but don't print, the expected errors.
+    error_count++;
+}
+
+// The input and output of the tile at (tx, ty), translated so that
+// every tile's output covers [0, T) x [0, T). The input has a
+// one-pixel border around it.
+Buffer<uint8_t> input_tile(const Buffer<uint8_t> &input, int tx, int ty) {
+    return input.cropped({{tx * T, T + 2}, {ty * T, T + 2}}).translated({-tx * T - 1, -ty * T - 1});
+}
+
+Buffer<uint8_t> output_tile(const Buffer<uint8_t> &output, int tx, int ty) {
+    return output.cropped({{tx * T, T}, {ty * T, T}}).translated({-tx * T, -ty * T});
+}
+
+int main(int argc, char **argv) {
+    // The input covers the output of every tile, plus a border.
+    Buffer<uint8_t> input(W + 2, H + 2), checked(W, H), trusted(W, H);
+    input.for_each_value([](uint8_t &v) { v = (uint8_t)(rand() & 0xff); });
+
+    // The checked entry point, on every tile.
+    auto run_checked = [&]() {
+        for (int ty = 0; ty < tiles_y; ty++) {
+            for (int tx = 0; tx < tiles_x; tx++) {
+                Buffer<uint8_t> in = input_tile(input, tx, ty), out = output_tile(checked, tx, ty);
+                int result = blur3x3(in, offset, out);
+                if (result != 0) {
+                    printf("blur3x3 failed on tile (%d, %d): %d\n", tx, ty, result);
+                    exit(-1);
+                }
+            }
+        }
+    };
+
+    // Every tile has the same shape, so validate the first one, and
+    // then run the trusted entry point on all of them.
+    auto run_trusted = [&]() {
+        for (int ty = 0; ty < tiles_y; ty++) {
+            for (int tx = 0; tx < tiles_x; tx++) {
+                Buffer<uint8_t> in = input_tile(input, tx, ty), out = output_tile(trusted, tx, ty);
+                blur3x3_trusted(in, offset, out);
+            }
+        }
+    };
+
+    {
+        Buffer<uint8_t> in = input_tile(input, 0, 0), out = output_tile(trusted, 0, 0);
+        int result = blur3x3_validate(in, offset, out);
+        if (result != 0) {
+            printf("blur3x3_validate failed: %d\n", result);
+            return -1;
+        }
+    }
+
+    run_checked();
+    run_trusted();
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (trusted(x, y) != checked(x, y)) {
+                printf("trusted(%d, %d) = %d instead of %d\n",
+                       x, y, trusted(x, y), checked(x, y));
+                return -1;
+            }
+        }
+    }
+
+    // Arguments that the checked entry point would reject (or answer
+    // with a bounds query) must fail validation.
+    halide_error_handler_t old_handler = halide_set_error_handler(&my_halide_error);
+    {
+        Buffer<uint8_t> out = output_tile(trusted, 0, 0);
+
+        // An input with no border.
+        Buffer<uint8_t> in_small = input.cropped({{1, T}, {1, T}}).translated({-1, -1});
+        int result = blur3x3_validate(in_small, offset, out);
+        if (result != halide_error_code_access_out_of_bounds || error_count != 1) {
+            printf("Expected an out of bounds error for an input with no border, got %d\n", result);
+            return -1;
+        }
+
+        // An unallocated input, which the checked entry point would
+        // treat as a bounds query.
+        Buffer<uint8_t> in_query(nullptr, T + 2, T + 2);
+        in_query.translate({-1, -1});
+        result = blur3x3_validate(in_query, offset, out);
+        if (result != halide_error_code_buffer_argument_is_null || error_count != 2) {
+            printf("Expected an error for an unallocated input, got %d\n", result);
+            return -1;
+        }
+
+        // A scalar out of range.
+        Buffer<uint8_t> in = input_tile(input, 0, 0);
+        result = blur3x3_validate(in, 100, out);
+        if (result != halide_error_code_param_too_large || error_count != 3) {
+            printf("Expected an error for an offset out of range, got %d\n", result);
+            return -1;
+        }
+    }
+    halide_set_error_handler(old_handler);
+
+    double t_checked = benchmark(run_checked);
+    double t_trusted = benchmark(run_trusted);
+    printf("%d tiles of %dx%d: checked entry point %f ms, trusted entry point %f ms\n",
+           tiles_x * tiles_y, T, T, t_checked * 1e3, t_trusted * 1e3);
+
+    printf("Success!\n");
+    return 0;
+}
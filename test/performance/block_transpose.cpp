@@ -54,9 +54,9 @@ Buffer<uint16_t> test_transpose(int mode) {
 
     output.realize(result);
 
-    double t = benchmark(1, 10, [&]() {
+    double t = report_benchmark("block_transpose_dummy: " + algorithm, benchmark([&]() {
         output.realize(result);
-    });
+    }));
 
     std::cout << "Dummy Func version: "  << algorithm << " bandwidth " << 1024*1024 / t << " byte/s.\n";
     return result;
@@ -104,9 +104,9 @@ Buffer<uint16_t> test_transpose_wrap(int mode) {
 
     output.realize(result);
 
-    double t = benchmark(1, 10, [&]() {
+    double t = report_benchmark("block_transpose_wrapper: " + algorithm, benchmark([&]() {
         output.realize(result);
-    });
+    }));
 
     std::cout << "Wrapper version: "  << algorithm << " bandwidth " << 1024*1024 / t << " byte/s.\n";
     return result;
@@ -30,11 +30,10 @@ struct Test {
 
         Buffer<float> out = g.realize(W, H);
 
-        // best of 10 x 5 runs.
-        time = benchmark(10, 5, [&]() {
+        time = report_benchmark(std::string("boundary_conditions_3x3_") + name, benchmark([&]() {
                 g.realize(out);
                 out.device_sync();
-        });
+        }));
 
         printf("%-20s: %f us\n", name, time * 1e6);
     }
@@ -56,11 +55,10 @@ struct Test {
 
         Buffer<float> out = g.realize(W, H);
 
-        // best of 3 x 3 runs.
-        time = benchmark(3, 3, [&]() {
+        time = report_benchmark(std::string("boundary_conditions_rdom_") + name, benchmark([&]() {
                 g.realize(out);
                 out.device_sync();
-        });
+        }));
 
         printf("%-20s: %f us\n", name, time * 1e6);
     }
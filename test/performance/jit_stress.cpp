@@ -16,16 +16,30 @@ int main(int argc, char **argv) {
     a.set(c);
 
     int expected = 0;
-    double t = benchmark(1, 100, [&]() {
+    double t = report_benchmark("jit_stress", benchmark([&]() {
         Func f;
         f(x) = a(x) + b(x);
         f.realize(c);
         expected += 17;
         assert(c(0) == expected);
-    });
+    }));
 
     printf("%g ms per jit compilation\n", t * 1e3);
 
+    // The same, but with the fast compilation tier, which reuses the
+    // code compiled for the first of these structurally identical
+    // pipelines.
+    Target fast = get_jit_target_from_environment().with_feature(Target::FastCompile);
+    double t_fast = report_benchmark("jit_stress_fast_compile", benchmark([&]() {
+        Func f;
+        f(x) = a(x) + b(x);
+        f.realize(c, fast);
+        expected += 17;
+        assert(c(0) == expected);
+    }));
+
+    printf("%g ms per jit compilation with fast_compile\n", t_fast * 1e3);
+
     printf("Success!\n");
     return 0;
 }
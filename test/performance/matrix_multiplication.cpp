@@ -49,8 +49,6 @@ int main(int argc, char **argv) {
 
     matrix_mul.compile_jit();
 
-    const int iterations = 50;
-
     Buffer<float> mat_A(matrix_size, matrix_size);
     Buffer<float> mat_B(matrix_size, matrix_size);
     Buffer<float> output(matrix_size, matrix_size);
@@ -68,9 +66,9 @@ int main(int argc, char **argv) {
 
     matrix_mul.realize(output);
 
-    double t = benchmark(1, iterations, [&]() {
+    double t = report_benchmark("matrix_multiplication", benchmark([&]() {
         matrix_mul.realize(output);
-    });
+    }));
 
     // check results
     Buffer<float> output_ref(matrix_size, matrix_size);
@@ -15,6 +15,8 @@
 # -e : Emit options. [Defaults to static_library, h]
 # -n : Output filename base. [Defaults to same as -f]
 # -x : Extension options. [Defaults to none.]
+# -b : Also build a standalone benchmark executable, OUTPUT_DIR/FILE_BASE_NAME.benchmark.
+#      (See tools/halide_benchmark_main.h for its arguments.)
 #
 # Flags are followed by GeneratorParam values, in the form name=value name=value etc.
 # You must always set the 'target' params common to all Generators;
@@ -24,7 +26,7 @@ set -e
 
 usage()
 {
-  echo `basename $0` -c CXX -l LIBHALIDE -o OUTPUT_DIR -s GENERATOR_SRC [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] target=TARGET [generator_param=value ...]
+  echo `basename $0` -c CXX -l LIBHALIDE -o OUTPUT_DIR -s GENERATOR_SRC [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] [-b] target=TARGET [generator_param=value ...]
   exit 85
 }
 
@@ -36,8 +38,11 @@ LIBHALIDE=${HALIDE_DIR}/bin/libHalide.so
 # Initialize sources array.
 GENERATOR_SRCS=()
 
-while getopts "c:e:f:g:l:n:o:s:x:" opt; do
+while getopts "bc:e:f:g:l:n:o:s:x:" opt; do
   case $opt in
+    b)
+      BENCHMARK=1
+      ;;
     c)
       CXX="${OPTARG}"
       ;;
@@ -105,6 +110,17 @@ if [ -n "${FILE_BASE_NAME}" ]; then
   FILE_BASE_NAME_FLAG="-n ${FILE_BASE_NAME}"
 fi
 
+if [ -n "${BENCHMARK}" ]; then
+  # The benchmark needs the library and header, as well as the driver.
+  EMIT_OPTIONS="${EMIT_OPTIONS:-static_library,h},benchmark"
+  BENCHMARK_BASE_NAME=${FILE_BASE_NAME:-${FUNCTION_NAME:-${GENERATOR_NAME}}}
+  BENCHMARK_BASE_NAME=${BENCHMARK_BASE_NAME##*::}
+  if [ -z "${BENCHMARK_BASE_NAME}" ]; then
+    echo "Generator (-g) must be specified to build a benchmark."
+    usage
+  fi
+fi
+
 if [ -n "${EMIT_OPTIONS}" ]; then
   EMIT_OPTIONS_FLAG="-e ${EMIT_OPTIONS}"
 fi
@@ -116,3 +132,9 @@ GENGEN=`mktemp ${OUTPUT_DIR}/gengen.XXXX`
 ${CXX} -g -std=c++11 -fno-rtti -I${HALIDE_DIR}/include ${GENERATOR_SRCS[@]} ${TOOLS_DIR}/GenGen.cpp "${LIBHALIDE}" -lz -lpthread -ldl -o ${GENGEN}
 ${GENGEN} ${GENERATOR_FLAG} ${FUNCTION_FLAG} ${EXTENSIONS_FLAG} ${FILE_BASE_NAME_FLAG} ${EMIT_OPTIONS_FLAG} -o ${OUTPUT_DIR} $@
 rm ${GENGEN}
+
+if [ -n "${BENCHMARK}" ]; then
+  ${CXX} -O2 -std=c++11 -I${OUTPUT_DIR} -I${HALIDE_DIR}/include -I${TOOLS_DIR} \
+    ${OUTPUT_DIR}/${BENCHMARK_BASE_NAME}.benchmark.cpp ${OUTPUT_DIR}/${BENCHMARK_BASE_NAME}.a \
+    -lpthread -ldl -o ${OUTPUT_DIR}/${BENCHMARK_BASE_NAME}.benchmark
+fi
@@ -1,8 +1,17 @@
 #ifndef BENCHMARK_H
 #define BENCHMARK_H
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
 #include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace Halide {
 namespace Tools {
@@ -11,6 +20,10 @@ namespace Tools {
 // how many times the operation is run for each time measurement, the
 // result is the minimum over a number of samples runs. The result is the
 // amount of time in seconds for one iteration.
+//
+// This is the original fixed-count harness. Prefer the adaptive
+// benchmark(op, config) below, which picks the number of iterations
+// itself and reports more than the best time.
 
 template <typename F>
 double benchmark(int samples, int iterations, F op) {
@@ -27,7 +40,229 @@ double benchmark(int samples, int iterations, F op) {
     return best / iterations;
 }
 
+// Parameters for the adaptive benchmark. All times are in seconds.
+struct BenchmarkConfig {
+    // Keep taking samples for at least this long.
+    double min_time = 0.1;
+
+    // Stop taking samples after this long, even if the target
+    // accuracy has not been reached. At least one sample is always
+    // taken, regardless of how long it takes.
+    double max_time = 0.4;
+
+    // Stop once the fastest three samples are within this relative
+    // distance of each other (and min_time has elapsed).
+    double accuracy = 0.03;
+
+    // Number of untimed calls to make before measuring anything, to
+    // get JIT compilation, page faults and lazy initialization out
+    // of the way.
+    int warmup_iterations = 1;
+
+    // Minimum number of samples to take.
+    int min_samples = 3;
+
+    // If non-zero, stream through a scratch buffer of this many bytes
+    // before every sample, so that each sample starts with a cold
+    // cache. The flush itself is not timed. When flushing, each
+    // sample is a single call of op, so that every call sees the
+    // same cold cache.
+    size_t flush_cache_bytes = 0;
+};
+
+// The statistics gathered by the adaptive benchmark. All times are
+// in seconds per call of op.
+struct BenchmarkResult {
+    // The best time seen. This is the number to use for
+    // comparisons; the other statistics describe the noise.
+    double wall_time = 0;
+
+    double min = 0, median = 0, p90 = 0, mean = 0, stddev = 0;
+
+    // Number of samples taken, and the number of calls of op that
+    // each sample was averaged over.
+    uint64_t samples = 0;
+    uint64_t iterations = 0;
+
+    // Relative spread of the fastest three samples. If this is
+    // larger than the requested accuracy, the benchmark hit max_time
+    // before settling down.
+    double accuracy = 0;
+
+    operator double() const { return wall_time; }
+};
+
+namespace Internal {
+
+inline double benchmark_now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void flush_cache(size_t bytes) {
+    if (bytes == 0) return;
+    static std::vector<uint8_t> scratch;
+    if (scratch.size() < bytes) {
+        scratch.resize(bytes);
+    }
+    // Touch every cache line, and consume the result so that the
+    // loop can't be optimized away.
+    volatile uint8_t sink = 0;
+    uint8_t acc = 0;
+    for (size_t i = 0; i < bytes; i += 64) {
+        scratch[i]++;
+        acc += scratch[i];
+    }
+    sink = acc;
+    (void)sink;
+}
+
+// Value at fraction q of the sorted vector v, interpolating between
+// neighboring elements.
+inline double benchmark_percentile(const std::vector<double> &v, double q) {
+    if (v.empty()) return 0;
+    double pos = q * (v.size() - 1);
+    size_t lo = (size_t)std::floor(pos);
+    size_t hi = std::min(lo + 1, v.size() - 1);
+    double frac = pos - lo;
+    return v[lo] * (1 - frac) + v[hi] * frac;
+}
+
+}  // namespace Internal
+
+// Benchmark the operation 'op' adaptively. First op is run
+// config.warmup_iterations times untimed. Then the number of calls
+// per sample is doubled until a single sample is long enough to time
+// reliably, and samples are taken until min_time has elapsed and the
+// fastest three agree to within config.accuracy, or max_time has
+// elapsed. Returns the statistics over the samples; the result
+// converts to the best time per call in seconds, so it can be used
+// wherever the fixed-count benchmark above was.
+inline BenchmarkResult benchmark(std::function<void()> op, const BenchmarkConfig &config = BenchmarkConfig()) {
+    using Internal::benchmark_now;
+
+    const double min_time = std::max(config.min_time, 1e-5);
+    const double max_time = std::max(config.max_time, min_time);
+    const int min_samples = std::max(config.min_samples, 1);
+
+    for (int i = 0; i < config.warmup_iterations; i++) {
+        op();
+    }
+
+    auto take_sample = [&](uint64_t iters) {
+        Internal::flush_cache(config.flush_cache_bytes);
+        double t1 = benchmark_now();
+        for (uint64_t j = 0; j < iters; j++) {
+            op();
+        }
+        double t2 = benchmark_now();
+        return (t2 - t1) / iters;
+    };
+
+    std::vector<double> times;
+    const double start = benchmark_now();
+
+    // Aim for samples long enough that timer resolution doesn't
+    // matter, and short enough that we get a reasonable number of
+    // them inside min_time. The calibration samples count as real
+    // samples once they are long enough.
+    const double target_sample_time = min_time / 10;
+    uint64_t iters = 1;
+    while (true) {
+        double t = take_sample(iters);
+        if (config.flush_cache_bytes || t * iters >= target_sample_time ||
+            benchmark_now() - start >= max_time) {
+            times.push_back(t);
+            break;
+        }
+        iters *= 2;
+    }
+
+    auto spread = [&]() {
+        std::vector<double> sorted = times;
+        std::sort(sorted.begin(), sorted.end());
+        size_t n = std::min<size_t>(3, sorted.size());
+        return (sorted[n - 1] - sorted[0]) / sorted[0];
+    };
+
+    while (true) {
+        double elapsed = benchmark_now() - start;
+        if (elapsed >= max_time) break;
+        if (elapsed >= min_time && (int)times.size() >= min_samples &&
+            spread() <= config.accuracy) break;
+        times.push_back(take_sample(iters));
+    }
+
+    BenchmarkResult r;
+    r.samples = times.size();
+    r.iterations = iters;
+    r.accuracy = spread();
+
+    std::sort(times.begin(), times.end());
+    r.min = r.wall_time = times[0];
+    r.median = Internal::benchmark_percentile(times, 0.5);
+    r.p90 = Internal::benchmark_percentile(times, 0.9);
+    double sum = 0, sum_sq = 0;
+    for (double t : times) {
+        sum += t;
+        sum_sq += t * t;
+    }
+    r.mean = sum / times.size();
+    r.stddev = std::sqrt(std::max(0.0, sum_sq / times.size() - r.mean * r.mean));
+    return r;
+}
+
+// Escape a string for use inside a JSON string literal.
+inline std::string benchmark_json_escape(const std::string &str) {
+    std::string result;
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+            result += buf;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+// Format a benchmark result as a single-line JSON object.
+inline std::string benchmark_to_json(const std::string &name, const BenchmarkResult &r) {
+    std::ostringstream s;
+    s.precision(9);
+    s << "{\"name\": \"" << benchmark_json_escape(name) << "\""
+      << ", \"min\": " << r.min
+      << ", \"median\": " << r.median
+      << ", \"p90\": " << r.p90
+      << ", \"mean\": " << r.mean
+      << ", \"stddev\": " << r.stddev
+      << ", \"samples\": " << r.samples
+      << ", \"iterations\": " << r.iterations
+      << ", \"accuracy\": " << r.accuracy
+      << "}";
+    return s.str();
+}
+
+// If the environment variable HL_BENCHMARK_JSON names a file, append
+// the result to it as one line of JSON. This lets scripts collect
+// machine-readable results from drivers that otherwise print
+// human-readable timings. Returns the result so calls can be chained.
+inline const BenchmarkResult &report_benchmark(const std::string &name, const BenchmarkResult &r) {
+    const char *path = getenv("HL_BENCHMARK_JSON");
+    if (path && path[0]) {
+        FILE *f = fopen(path, "a");
+        if (f) {
+            fprintf(f, "%s\n", benchmark_to_json(name, r).c_str());
+            fclose(f);
+        }
+    }
+    return r;
+}
+
 }   // namespace Tools
-}   // mamespace Halide
+}   // namespace Halide
 
 #endif
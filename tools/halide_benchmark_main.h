@@ -0,0 +1,273 @@
+#ifndef HALIDE_BENCHMARK_MAIN_H
+#define HALIDE_BENCHMARK_MAIN_H
+
+//---------------------------------------------------------------------------
+// A generic benchmark driver for an AOT-compiled Halide pipeline. GenGen
+// emits a main() that calls benchmark_main() when given "-e benchmark"
+// (or tools/gengen.sh -b). The driver reads the pipeline's arguments from
+// its metadata, so it works for any Generator:
+//
+//   ./foo.benchmark [name=value ...] [--min_time=s] [--max_time=s]
+//
+// Scalar arguments are set with name=value; otherwise they take their
+// declared default (or zero). Buffer arguments are sized with
+// name=WxHx..., and are filled with random values. Outputs that aren't
+// sized default to the size of the first sized input with the same
+// dimensionality, or 1024x1024x1x... Inputs that aren't sized are given
+// the size the pipeline requires for the outputs, via a bounds query.
+//
+// If the pipeline was compiled with the "profile" target feature, the
+// profiler's report at exit covers only the timed runs.
+//---------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+#include "halide_benchmark.h"
+
+namespace Halide {
+namespace Tools {
+
+namespace Internal {
+
+inline std::vector<int> parse_extents(const std::string &s) {
+    std::vector<int> extents;
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t end = s.find('x', start);
+        if (end == std::string::npos) end = s.size();
+        extents.push_back(atoi(s.substr(start, end - start).c_str()));
+        start = end + 1;
+    }
+    return extents;
+}
+
+inline bool set_scalar(const halide_type_t &t, const std::string &value, halide_scalar_value_t *v) {
+    memset(v, 0, sizeof(*v));
+    double d = atof(value.c_str());
+    switch (t.code) {
+    case halide_type_float:
+        if (t.bits == 32) v->u.f32 = (float)d;
+        else v->u.f64 = d;
+        return true;
+    case halide_type_int:
+        switch (t.bits) {
+        case 8: v->u.i8 = (int8_t)d; return true;
+        case 16: v->u.i16 = (int16_t)d; return true;
+        case 32: v->u.i32 = (int32_t)d; return true;
+        case 64: v->u.i64 = (int64_t)d; return true;
+        }
+        break;
+    case halide_type_uint:
+        switch (t.bits) {
+        case 1: v->u.b = (d != 0); return true;
+        case 8: v->u.u8 = (uint8_t)d; return true;
+        case 16: v->u.u16 = (uint16_t)d; return true;
+        case 32: v->u.u32 = (uint32_t)d; return true;
+        case 64: v->u.u64 = (uint64_t)d; return true;
+        }
+        break;
+    case halide_type_handle:
+        // Handles are passed as null.
+        return value.empty();
+    }
+    return false;
+}
+
+template<typename T>
+void fill_random(T *data, size_t n, T range) {
+    for (size_t i = 0; i < n; i++) {
+        data[i] = (T)(rand() % ((int)range + 1));
+    }
+}
+
+// Fill a densely allocated buffer with random values. Floating point
+// values are in [0, 1]. Integer values span the range of narrow types,
+// and are small for wider types, so that they're plausible sizes and
+// indices.
+inline void fill_random(Halide::Runtime::Buffer<> &b) {
+    const halide_type_t t = b.type();
+    const size_t n = b.number_of_elements();
+    void *data = b.data();
+    if (t.code == halide_type_float) {
+        for (size_t i = 0; i < n; i++) {
+            double v = rand() / (double)RAND_MAX;
+            if (t.bits == 32) ((float *)data)[i] = (float)v;
+            else ((double *)data)[i] = v;
+        }
+        return;
+    }
+    const bool is_signed = t.code == halide_type_int;
+    switch (t.bits) {
+    case 1: fill_random((uint8_t *)data, n, (uint8_t)1); break;
+    case 8: fill_random((uint8_t *)data, n, (uint8_t)(is_signed ? 127 : 255)); break;
+    case 16: fill_random((uint16_t *)data, n, (uint16_t)(is_signed ? 32767 : 65535)); break;
+    case 32: fill_random((uint32_t *)data, n, (uint32_t)1023); break;
+    case 64: fill_random((uint64_t *)data, n, (uint64_t)1023); break;
+    }
+}
+
+}  // namespace Internal
+
+inline int benchmark_main(int argc, char **argv,
+                          int (*filter_argv)(void **),
+                          const halide_filter_metadata_t *md) {
+    using Halide::Runtime::Buffer;
+
+    BenchmarkConfig config;
+    std::map<std::string, std::string> values;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == std::string::npos) {
+            fprintf(stderr, "Usage: %s [name=value ...] [--min_time=s] [--max_time=s]\n", argv[0]);
+            return 1;
+        }
+        std::string name = arg.substr(0, eq), value = arg.substr(eq + 1);
+        if (name == "--min_time") {
+            config.min_time = atof(value.c_str());
+        } else if (name == "--max_time") {
+            config.max_time = atof(value.c_str());
+        } else {
+            values[name] = value;
+        }
+    }
+
+    const int num_args = md->num_arguments;
+    std::vector<halide_scalar_value_t> scalars(num_args);
+    std::vector<Buffer<>> buffers(num_args);
+    std::vector<void *> args(num_args);
+    std::vector<void *> handles(num_args, nullptr);
+
+    // The first explicitly sized input of each dimensionality.
+    std::map<int, std::vector<int>> input_sizes;
+    for (int i = 0; i < num_args; i++) {
+        const halide_filter_argument_t &a = md->arguments[i];
+        if (a.kind == halide_argument_kind_input_buffer && values.count(a.name)) {
+            std::vector<int> extents = Internal::parse_extents(values[a.name]);
+            if ((int)extents.size() != a.dimensions) {
+                fprintf(stderr, "%s has %d dimensions, but was given the size %s\n",
+                        a.name, a.dimensions, values[a.name].c_str());
+                return 1;
+            }
+            input_sizes.insert({a.dimensions, extents});
+        }
+    }
+
+    bool needs_bounds_query = false;
+    for (int i = 0; i < num_args; i++) {
+        const halide_filter_argument_t &a = md->arguments[i];
+        auto it = values.find(a.name);
+        const bool given = it != values.end();
+        if (a.kind == halide_argument_kind_input_scalar) {
+            if (given) {
+                if (!Internal::set_scalar(a.type, it->second, &scalars[i])) {
+                    fprintf(stderr, "Can't set %s to %s\n", a.name, it->second.c_str());
+                    return 1;
+                }
+            } else if (a.def) {
+                scalars[i] = *a.def;
+            } else {
+                memset(&scalars[i], 0, sizeof(scalars[i]));
+            }
+            args[i] = a.type.code == halide_type_handle ? (void *)&handles[i] : (void *)&scalars[i];
+            continue;
+        }
+
+        std::vector<int> extents;
+        if (given) {
+            extents = Internal::parse_extents(it->second);
+        } else if (a.kind == halide_argument_kind_output_buffer) {
+            if (input_sizes.count(a.dimensions)) {
+                extents = input_sizes[a.dimensions];
+            } else {
+                for (int d = 0; d < a.dimensions; d++) {
+                    extents.push_back(d < 2 ? 1024 : 1);
+                }
+            }
+        }
+        if (!extents.empty()) {
+            if ((int)extents.size() != a.dimensions) {
+                fprintf(stderr, "%s has %d dimensions, but was given the size %s\n",
+                        a.name, a.dimensions, it->second.c_str());
+                return 1;
+            }
+            buffers[i] = Buffer<>(a.type, extents);
+        } else {
+            // Leave the shape to a bounds query.
+            std::vector<halide_dimension_t> shape(a.dimensions);
+            buffers[i] = Buffer<>(a.type, nullptr, a.dimensions, shape.data());
+            needs_bounds_query = true;
+        }
+        args[i] = buffers[i].raw_buffer();
+    }
+
+    if (needs_bounds_query) {
+        int result = filter_argv(args.data());
+        if (result != 0) {
+            fprintf(stderr, "Bounds query failed with error %d\n", result);
+            return 1;
+        }
+        for (int i = 0; i < num_args; i++) {
+            if (md->arguments[i].kind != halide_argument_kind_input_scalar &&
+                !buffers[i].data()) {
+                buffers[i].allocate();
+            }
+        }
+    }
+
+    size_t output_pixels = 0;
+    for (int i = 0; i < num_args; i++) {
+        const halide_filter_argument_t &a = md->arguments[i];
+        if (a.kind == halide_argument_kind_input_buffer) {
+            Internal::fill_random(buffers[i]);
+        }
+        printf("%s%s", i == 0 ? "" : ", ", a.name);
+        if (a.kind != halide_argument_kind_input_scalar) {
+            for (int d = 0; d < buffers[i].dimensions(); d++) {
+                printf("%s%d", d == 0 ? "=" : "x", buffers[i].dim(d).extent());
+            }
+            if (a.kind == halide_argument_kind_output_buffer && output_pixels == 0) {
+                output_pixels = 1;
+                for (int d = 0; d < std::min(2, buffers[i].dimensions()); d++) {
+                    output_pixels *= buffers[i].dim(d).extent();
+                }
+            }
+        }
+    }
+    printf("\n");
+
+    // Run once untimed, both to check the arguments are acceptable and
+    // so that the profiler report doesn't include first-run costs.
+    int result = filter_argv(args.data());
+    if (result != 0) {
+        fprintf(stderr, "%s failed with error %d\n", md->name, result);
+        return 1;
+    }
+    if (strstr(md->target, "profile")) {
+        halide_profiler_reset();
+    }
+
+    config.warmup_iterations = 0;
+    BenchmarkResult r = benchmark([&]() { filter_argv(args.data()); }, config);
+    report_benchmark(md->name, r);
+
+    printf("%s: min %.4f ms, median %.4f ms, p90 %.4f ms over %d samples of %d iterations\n",
+           md->name, r.min * 1e3, r.median * 1e3, r.p90 * 1e3,
+           (int)r.samples, (int)r.iterations);
+    if (output_pixels) {
+        printf("%s: %.2f MPix/s\n", md->name, output_pixels / r.min / 1e6);
+    }
+    return 0;
+}
+
+}  // namespace Tools
+}  // namespace Halide
+
+#endif
@@ -5,12 +5,22 @@
 #define HALIDE_IMAGE_IO_H
 
 #include <algorithm>
+#include <cctype>
+#include <climits>
 #include <cstdarg>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
 #include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #ifndef HALIDE_NO_PNG
 #include "png.h"
 #endif
@@ -79,6 +89,37 @@ inline void convert(uint16_t in, int32_t &out) {out = in << 16;}
 inline void convert(uint16_t in, float &out) {out = in/65535.0f;}
 inline void convert(uint16_t in, double &out) {out = in/65535.0f;}
 
+// Convert a whole run of contiguous values at once. Keeping the loop
+// free of strides and channel arithmetic lets the compiler vectorize
+// it, which matters for large images.
+template<typename In, typename Out>
+inline void convert_n(const In *src, Out *dst, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        convert(src[i], dst[i]);
+    }
+}
+
+// Convert n interleaved pixels of 'channels' channels each into
+// planar destination channels that are 'plane' elements apart.
+template<typename In, typename Out>
+inline void convert_deinterleave_n(const In *src, Out *dst, size_t n, int channels, int64_t plane) {
+    for (int c = 0; c < channels; c++) {
+        const In *s = src + c;
+        Out *d = dst + c * plane;
+        for (size_t i = 0; i < n; i++) {
+            convert(s[i * channels], d[i]);
+        }
+    }
+}
+
+// Byte swap a run of big-endian 16-bit values to native order.
+inline void swap_endian_16_n(bool little_endian, uint16_t *data, size_t n) {
+    if (!little_endian) return;
+    for (size_t i = 0; i < n; i++) {
+        data[i] = (uint16_t)((data[i] << 8) | (data[i] >> 8));
+    }
+}
+
 
 inline bool ends_with_ignore_case(const std::string &ac, const std::string &bc) {
     if (ac.length() < bc.length()) { return false; }
@@ -99,6 +140,48 @@ inline void swap_endian_16(bool little_endian, uint16_t &value) {
     }
 }
 
+// Parse the header of a binary PGM (P5) or PPM (P6) file held in
+// memory. On success, *offset is the position of the first pixel.
+inline bool parse_pnm_header(const uint8_t *data, size_t size, int *channels,
+                             int *width, int *height, int *maxval, size_t *offset) {
+    if (size < 2 || (data[0] != 'P' && data[0] != 'p')) return false;
+    if (data[1] == '5') {
+        *channels = 1;
+    } else if (data[1] == '6') {
+        *channels = 3;
+    } else {
+        return false;
+    }
+    size_t pos = 2;
+    auto skip_space_and_comments = [&]() {
+        while (pos < size) {
+            if (data[pos] == '#') {
+                while (pos < size && data[pos] != '\n') pos++;
+            } else if (isspace(data[pos])) {
+                pos++;
+            } else {
+                break;
+            }
+        }
+    };
+    auto read_number = [&](int *value) {
+        skip_space_and_comments();
+        if (pos >= size || !isdigit(data[pos])) return false;
+        int64_t n = 0;
+        while (pos < size && isdigit(data[pos])) {
+            n = n * 10 + (data[pos++] - '0');
+            if (n > INT_MAX) return false;
+        }
+        *value = (int)n;
+        return true;
+    };
+    if (!read_number(width) || !read_number(height) || !read_number(maxval)) return false;
+    // A single whitespace character separates the header from the pixels.
+    if (pos >= size || !isspace(data[pos])) return false;
+    *offset = pos + 1;
+    return true;
+}
+
 struct FileOpener {
     FileOpener(const char* filename, const char* mode) : f(fopen(filename, mode)) {
         // nothing
@@ -376,25 +459,14 @@ bool load_pgm(const std::string &filename, ImageType *im) {
         std::vector<uint8_t> data(width*height);
         if (!check(fread((void *) &data[0], sizeof(uint8_t), width*height, f.f) == (size_t) (width*height), "Could not read PGM 8-bit data\n")) return false;
         typename ImageType::ElemType *im_data = (typename ImageType::ElemType*) im->data();
-        uint8_t *p = &data[0];
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                Internal::convert(*p++, *im_data++);
-            }
-        }
+        Internal::convert_n(&data[0], im_data, (size_t)width*height);
     } else if (bit_depth == 16) {
         bool little_endian = Internal::is_little_endian();
         std::vector<uint16_t> data(width*height);
         if (!check(fread((void *) &data[0], sizeof(uint16_t), width*height, f.f) == (size_t) (width*height), "Could not read PGM 16-bit data\n")) return false;
         typename ImageType::ElemType *im_data = (typename ImageType::ElemType*) im->data();
-        uint16_t *p = &data[0];
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                uint16_t value = *p++;
-                Internal::swap_endian_16(little_endian, value);
-                Internal::convert(value, *im_data++);
-            }
-        }
+        Internal::swap_endian_16_n(little_endian, &data[0], data.size());
+        Internal::convert_n(&data[0], im_data, (size_t)width*height);
     }
     (*im)(0,0,0) = (*im)(0,0,0);      /* Mark dirty inside read/write functions. */
 
@@ -477,38 +549,19 @@ bool load_ppm(const std::string &filename, ImageType *im) {
     *im = ImageType(width, height, channels);
 
     // convert the data to ImageType::ElemType
+    const size_t pixels = (size_t)width*height;
     if (bit_depth == 8) {
         std::vector<uint8_t> data(width*height*3);
         if (!check(fread((void *) &data[0], sizeof(uint8_t), width*height*3, f.f) == (size_t) (width*height*3), "Could not read PPM 8-bit data\n")) return false;
         typename ImageType::ElemType *im_data = (typename ImageType::ElemType*) im->data();
-        uint8_t *row = &data[0];
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                Internal::convert(*row++, im_data[(0*height+y)*width+x]);
-                Internal::convert(*row++, im_data[(1*height+y)*width+x]);
-                Internal::convert(*row++, im_data[(2*height+y)*width+x]);
-            }
-        }
+        Internal::convert_deinterleave_n(&data[0], im_data, pixels, 3, pixels);
     } else if (bit_depth == 16) {
         bool little_endian = Internal::is_little_endian();
         std::vector<uint16_t> data(width*height*3);
         if (!check(fread((void *) &data[0], sizeof(uint16_t), width*height*3, f.f) == (size_t) (width*height*3), "Could not read PPM 16-bit data\n")) return false;
         typename ImageType::ElemType *im_data = (typename ImageType::ElemType*) im->data();
-        uint16_t *row = &data[0];
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                uint16_t value;
-                value = *row++;
-                Internal::swap_endian_16(little_endian, value);
-                Internal::convert(value, im_data[(0*height+y)*width+x]);
-                value = *row++;
-                Internal::swap_endian_16(little_endian, value);
-                Internal::convert(value, im_data[(1*height+y)*width+x]);
-                value = *row++;
-                Internal::swap_endian_16(little_endian, value);
-                Internal::convert(value, im_data[(2*height+y)*width+x]);
-            }
-        }
+        Internal::swap_endian_16_n(little_endian, &data[0], data.size());
+        Internal::convert_deinterleave_n(&data[0], im_data, pixels, 3, pixels);
     }
     (*im)(0,0,0) = (*im)(0,0,0);      /* Mark dirty inside read/write functions. */
 
@@ -590,6 +643,241 @@ bool save_ppm(ImageType &im, const std::string &filename) {
     return true;
 }
 
+// A private, copy-on-write memory mapping of a whole file. The images
+// produced by map_pnm and map_raw point directly into the mapping, so
+// it must outlive them. Writing to those images never modifies the
+// file on disk.
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &filename) {
+        close();
+#ifdef _WIN32
+        return false;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        data_ = (uint8_t *)p;
+        size_ = (size_t)st.st_size;
+        return true;
+#endif
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (data_) {
+            munmap(data_, size_);
+        }
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    uint8_t *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    uint8_t *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Map a binary PGM or PPM file and wrap its pixels as an image without
+// copying or converting them. PPM files produce an interleaved image
+// (channel stride 1). The element size of ImageType must match the bit
+// depth of the file. 16-bit files are stored big-endian, so on
+// little-endian machines they are byte-swapped in place, which touches
+// (and privately copies) every page of the mapping. ImageType must
+// have the constructor and make_interleaved of Halide::Runtime::Buffer.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool map_pnm(const std::string &filename, MappedFile *file, ImageType *im) {
+    typedef typename ImageType::ElemType ElemType;
+
+    if (!check(file->open(filename), "File %s could not be mapped\n", filename.c_str())) return false;
+
+    int channels, width, height, maxval;
+    size_t offset;
+    if (!check(Internal::parse_pnm_header(file->data(), file->size(), &channels, &width, &height, &maxval, &offset),
+               "Could not read binary PGM/PPM header from %s\n", filename.c_str())) return false;
+
+    size_t bytes = 0;
+    if (maxval == 255) { bytes = 1; }
+    else if (maxval == 65535) { bytes = 2; }
+    else if (!check(false, "Invalid bit depth in PGM/PPM\n")) { return false; }
+
+    if (!check(sizeof(ElemType) == bytes,
+               "Can't map a %d-bit PGM/PPM file into an image with %d-byte elements\n",
+               (int)(bytes * 8), (int)sizeof(ElemType))) return false;
+    if (!check(offset % bytes == 0,
+               "Pixel data in %s is not aligned; use load_pgm/load_ppm instead\n", filename.c_str())) return false;
+
+    size_t n = (size_t)width * height * channels;
+    if (!check(offset + n * bytes <= file->size(), "File %s is truncated\n", filename.c_str())) return false;
+
+    ElemType *data = (ElemType *)(file->data() + offset);
+    if (bytes == 2) {
+        Internal::swap_endian_16_n(Internal::is_little_endian(), (uint16_t *)data, n);
+    }
+
+    if (channels == 1) {
+        *im = ImageType(data, width, height);
+    } else {
+        *im = ImageType::make_interleaved(data, width, height, channels);
+    }
+    return true;
+}
+
+// Map a headerless file of native-endian ElemType values, starting
+// 'offset' bytes into the file, and wrap it as a width x height (x
+// channels) image without copying. If interleaved is true the channels
+// of each pixel are adjacent; otherwise the file holds one plane per
+// channel.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool map_raw(const std::string &filename, MappedFile *file, ImageType *im,
+             int width, int height, int channels = 1, bool interleaved = true, size_t offset = 0) {
+    typedef typename ImageType::ElemType ElemType;
+
+    if (!check(file->open(filename), "File %s could not be mapped\n", filename.c_str())) return false;
+
+    size_t n = (size_t)width * height * channels;
+    if (!check(offset % sizeof(ElemType) == 0, "Offset %d is not aligned to the element size\n", (int)offset)) return false;
+    if (!check(offset + n * sizeof(ElemType) <= file->size(), "File %s is too small\n", filename.c_str())) return false;
+
+    ElemType *data = (ElemType *)(file->data() + offset);
+    if (channels == 1) {
+        *im = ImageType(data, width, height);
+    } else if (interleaved) {
+        *im = ImageType::make_interleaved(data, width, height, channels);
+    } else {
+        *im = ImageType(data, width, height, channels);
+    }
+    return true;
+}
+
+// Reads a binary PGM or PPM file a row at a time, so that images
+// larger than memory can be processed in strips.
+class PNMRowReader {
+public:
+    PNMRowReader() {}
+    ~PNMRowReader() { close(); }
+
+    PNMRowReader(const PNMRowReader &) = delete;
+    PNMRowReader &operator=(const PNMRowReader &) = delete;
+
+    template<Internal::CheckFunc check = Internal::CheckReturn>
+    bool open(const std::string &filename) {
+        close();
+        f = fopen(filename.c_str(), "rb");
+        if (!check(f != nullptr, "File %s could not be opened for reading\n", filename.c_str())) return false;
+
+        // The header is short; read enough of the file to parse it,
+        // then seek to the start of the pixels.
+        uint8_t header[1024];
+        size_t got = fread(header, 1, sizeof(header), f);
+        int maxval;
+        size_t offset;
+        if (!check(Internal::parse_pnm_header(header, got, &channels_, &width_, &height_, &maxval, &offset),
+                   "Could not read binary PGM/PPM header from %s\n", filename.c_str())) {
+            close();
+            return false;
+        }
+        if (maxval == 255) { bit_depth_ = 8; }
+        else if (maxval == 65535) { bit_depth_ = 16; }
+        else {
+            close();
+            return check(false, "Invalid bit depth in PGM/PPM\n");
+        }
+        if (!check(fseek(f, (long)offset, SEEK_SET) == 0, "Could not seek in %s\n", filename.c_str())) {
+            close();
+            return false;
+        }
+        row_ = 0;
+        return true;
+    }
+
+    void close() {
+        if (f) {
+            fclose(f);
+            f = nullptr;
+        }
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int channels() const { return channels_; }
+    int bit_depth() const { return bit_depth_; }
+
+    // The index of the next row to be read.
+    int row() const { return row_; }
+
+    // Read the next row into dst, converting to T. The row is
+    // width() * channels() values with the channels interleaved.
+    template<typename T>
+    bool read_row(T *dst) {
+        if (!f || row_ >= height_) return false;
+        size_t n = (size_t)width_ * channels_;
+        if (bit_depth_ == 8) {
+            buf8.resize(n);
+            if (fread(buf8.data(), 1, n, f) != n) return false;
+            Internal::convert_n(buf8.data(), dst, n);
+        } else {
+            buf16.resize(n);
+            if (fread(buf16.data(), 2, n, f) != n) return false;
+            Internal::swap_endian_16_n(Internal::is_little_endian(), buf16.data(), n);
+            Internal::convert_n(buf16.data(), dst, n);
+        }
+        row_++;
+        return true;
+    }
+
+    // Fill the next im->height() rows of the file into im, which must
+    // be width() pixels wide and have channels() channels. im may have
+    // any memory layout, and any mins; the first row read goes to
+    // the first row of im.
+    template<typename ImageType>
+    bool read_rows(ImageType *im) {
+        typedef typename ImageType::ElemType ElemType;
+        if (im->width() != width_ || im->channels() != channels_) return false;
+        const int x_min = im->dim(0).min(), y_min = im->dim(1).min();
+        const int c_min = im->dimensions() > 2 ? im->dim(2).min() : 0;
+        std::vector<ElemType> row(width_ * channels_);
+        for (int y = y_min; y < y_min + im->height(); y++) {
+            if (!read_row(row.data())) return false;
+            const ElemType *src = row.data();
+            if (im->dimensions() == 2) {
+                for (int x = x_min; x < x_min + width_; x++) {
+                    (*im)(x, y) = *src++;
+                }
+            } else {
+                for (int x = x_min; x < x_min + width_; x++) {
+                    for (int c = c_min; c < c_min + channels_; c++) {
+                        (*im)(x, y, c) = *src++;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    FILE *f = nullptr;
+    int width_ = 0, height_ = 0, channels_ = 0, bit_depth_ = 0, row_ = 0;
+    std::vector<uint8_t> buf8;
+    std::vector<uint16_t> buf16;
+};
+
 template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
 bool save_jpg(ImageType &im, const std::string &filename) {
 #ifdef HALIDE_NO_JPEG
@@ -0,0 +1,351 @@
+// A simple tiled, uncompressed on-disk image format that supports
+// reading and writing arbitrary rectangular regions, touching only
+// the tiles that overlap them. This makes it possible to run
+// pipelines over images that don't fit in memory, by loading only
+// the region of an input that bounds inference says is required.
+//
+// There are two ways to feed a pipeline from a tiled file:
+//
+// 1) Keep the ImageParam. Do a bounds query (for AOT-compiled
+// pipelines, call them with an input buffer with a null host
+// pointer; for JIT, use Func::infer_input_bounds), allocate the
+// requested region, and fill it with TiledImageFile::read_region.
+//
+// 2) Replace the input with an extern stage that calls
+// load_tiled_image_region, passing a pointer to an open
+// TiledImageFile as a handle argument. The extern stage is then
+// asked for exactly the region each consumer needs, so tiled
+// schedules of the consumers only ever load what they use.
+
+#ifndef HALIDE_TILED_IMAGE_H
+#define HALIDE_TILED_IMAGE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "HalideRuntime.h"
+
+namespace Halide {
+namespace Tools {
+
+// File layout. All fields are native-endian.
+//
+//   char     magic[8]          "HLTILE01"
+//   uint8_t  type code, type bits, type lanes, dimensions
+//   int32_t  extent[4]         the image's mins are always zero
+//   int32_t  tile_extent[4]
+//   padding up to 64 bytes
+//   tiles
+//
+// Tiles are stored with the tile index along dimension 0 varying
+// fastest. Each tile holds the product of the tile extents elements,
+// densely packed with dimension 0 innermost. Tiles at the edges of
+// the image are stored at full size, so the location of any tile can
+// be computed directly.
+class TiledImageFile {
+public:
+    static const int max_dimensions = 4;
+
+    TiledImageFile() {}
+    ~TiledImageFile() { close(); }
+
+    TiledImageFile(const TiledImageFile &) = delete;
+    TiledImageFile &operator=(const TiledImageFile &) = delete;
+
+    // Create a new file with the given shape, replacing any existing
+    // file. The contents are initially zero. The file stays open for
+    // reading and writing.
+    bool create(const std::string &filename, halide_type_t type, int dimensions,
+                const int *extents, const int *tile_extents) {
+        close();
+        if (dimensions < 1 || dimensions > max_dimensions || type.lanes != 1) return false;
+        type_ = type;
+        dimensions_ = dimensions;
+        for (int d = 0; d < max_dimensions; d++) {
+            extent_[d] = d < dimensions ? extents[d] : 1;
+            tile_extent_[d] = d < dimensions ? tile_extents[d] : 1;
+            if (extent_[d] < 1 || tile_extent_[d] < 1) return false;
+        }
+        compute_layout();
+
+        f = fopen(filename.c_str(), "w+b");
+        if (!f) return false;
+        uint8_t header[header_size];
+        memset(header, 0, sizeof(header));
+        memcpy(header, magic(), 8);
+        header[8] = type_.code;
+        header[9] = type_.bits;
+        header[10] = (uint8_t)type_.lanes;
+        header[11] = (uint8_t)dimensions_;
+        memcpy(header + 12, extent_, sizeof(extent_));
+        memcpy(header + 12 + sizeof(extent_), tile_extent_, sizeof(tile_extent_));
+        if (fwrite(header, 1, header_size, f) != header_size) {
+            close();
+            return false;
+        }
+        // Extend the file to its full size by writing the last
+        // byte. Most filesystems leave the rest sparse.
+        const uint8_t zero = 0;
+        int64_t size = header_size + num_tiles * tile_bytes;
+        if (!seek(size - 1) || fwrite(&zero, 1, 1, f) != 1) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // Open an existing file. If writable is true, write_region may be
+    // used to modify it in place.
+    bool open(const std::string &filename, bool writable = false) {
+        close();
+        f = fopen(filename.c_str(), writable ? "r+b" : "rb");
+        if (!f) return false;
+        uint8_t header[header_size];
+        if (fread(header, 1, header_size, f) != header_size ||
+            memcmp(header, magic(), 8) != 0) {
+            close();
+            return false;
+        }
+        type_.code = (halide_type_code_t)header[8];
+        type_.bits = header[9];
+        type_.lanes = header[10];
+        dimensions_ = header[11];
+        memcpy(extent_, header + 12, sizeof(extent_));
+        memcpy(tile_extent_, header + 12 + sizeof(extent_), sizeof(tile_extent_));
+        // Check the shape as create() does, so that a corrupt header
+        // can't make compute_layout() divide by zero.
+        if (dimensions_ < 1 || dimensions_ > max_dimensions || type_.lanes != 1) {
+            close();
+            return false;
+        }
+        for (int d = 0; d < max_dimensions; d++) {
+            if (extent_[d] < 1 || tile_extent_[d] < 1) {
+                close();
+                return false;
+            }
+        }
+        compute_layout();
+        return true;
+    }
+
+    void close() {
+        if (f) {
+            fclose(f);
+            f = nullptr;
+        }
+    }
+
+    bool is_open() const { return f != nullptr; }
+    halide_type_t type() const { return type_; }
+    int dimensions() const { return dimensions_; }
+    int extent(int d) const { return extent_[d]; }
+    int tile_extent(int d) const { return tile_extent_[d]; }
+
+    // Fill buf with the region of the image it covers (as given by
+    // its mins and extents), reading only the tiles that overlap
+    // it. Parts of buf outside the image are left untouched. buf may
+    // have any strides, but must have the same type and
+    // dimensionality as the file.
+    bool read_region(halide_buffer_t *buf) {
+        return for_each_tile(buf, false);
+    }
+
+    // Write the region covered by buf into the file. Tiles only
+    // partly covered by buf are read, updated and written back.
+    bool write_region(const halide_buffer_t *buf) {
+        return for_each_tile(const_cast<halide_buffer_t *>(buf), true);
+    }
+
+    // Create a file the shape of buf (whose mins must be zero) and
+    // write buf to it.
+    bool save(const std::string &filename, const halide_buffer_t *buf, const int *tile_extents) {
+        int extents[max_dimensions];
+        for (int d = 0; d < buf->dimensions && d < max_dimensions; d++) {
+            if (buf->dim[d].min != 0) return false;
+            extents[d] = buf->dim[d].extent;
+        }
+        return create(filename, buf->type, buf->dimensions, extents, tile_extents) &&
+            write_region(buf);
+    }
+
+private:
+    static const size_t header_size = 64;
+    static const char *magic() { return "HLTILE01"; }
+
+    FILE *f = nullptr;
+    halide_type_t type_;
+    int dimensions_ = 0;
+    int32_t extent_[max_dimensions];
+    int32_t tile_extent_[max_dimensions];
+
+    // Derived from the above.
+    int64_t tiles[max_dimensions];
+    int64_t tile_stride[max_dimensions];
+    int64_t num_tiles = 0, tile_bytes = 0;
+    size_t elem_size = 0;
+    std::vector<uint8_t> scratch;
+
+    void compute_layout() {
+        elem_size = (type_.bits + 7) / 8;
+        num_tiles = 1;
+        int64_t tile_elems = 1;
+        for (int d = 0; d < max_dimensions; d++) {
+            tiles[d] = (extent_[d] + tile_extent_[d] - 1) / tile_extent_[d];
+            num_tiles *= tiles[d];
+            tile_stride[d] = tile_elems;
+            tile_elems *= tile_extent_[d];
+        }
+        tile_bytes = tile_elems * elem_size;
+    }
+
+    bool seek(int64_t pos) {
+#ifdef _WIN32
+        return _fseeki64(f, pos, SEEK_SET) == 0;
+#else
+        return fseeko(f, (off_t)pos, SEEK_SET) == 0;
+#endif
+    }
+
+    // Visit every tile overlapping buf, copying between the tile and
+    // buf in the direction given by 'write'.
+    bool for_each_tile(halide_buffer_t *buf, bool write) {
+        if (!f || !buf->host || buf->dimensions != dimensions_ ||
+            buf->type.code != type_.code || buf->type.bits != type_.bits) {
+            return false;
+        }
+
+        // The range of tiles, and the range of coordinates in the
+        // image, covered by buf.
+        int lo[max_dimensions], hi[max_dimensions];
+        int64_t tile_lo[max_dimensions], tile_hi[max_dimensions];
+        for (int d = 0; d < max_dimensions; d++) {
+            if (d < dimensions_) {
+                lo[d] = std::max(buf->dim[d].min, 0);
+                hi[d] = std::min(buf->dim[d].min + buf->dim[d].extent, extent_[d]);
+            } else {
+                lo[d] = 0;
+                hi[d] = 1;
+            }
+            if (lo[d] >= hi[d]) return true;
+            tile_lo[d] = lo[d] / tile_extent_[d];
+            tile_hi[d] = (hi[d] - 1) / tile_extent_[d];
+        }
+
+        scratch.resize(tile_bytes);
+        int64_t t[max_dimensions];
+        for (int d = 0; d < max_dimensions; d++) {
+            t[d] = tile_lo[d];
+        }
+        while (true) {
+            int64_t index = 0;
+            for (int d = max_dimensions - 1; d >= 0; d--) {
+                index = index * tiles[d] + t[d];
+            }
+            int64_t offset = header_size + index * tile_bytes;
+
+            // Intersection of this tile with buf.
+            int box_min[max_dimensions], box_max[max_dimensions];
+            bool covers_tile = true;
+            for (int d = 0; d < max_dimensions; d++) {
+                int tile_min = (int)(t[d] * tile_extent_[d]);
+                box_min[d] = std::max(lo[d], tile_min);
+                box_max[d] = std::min(hi[d], tile_min + tile_extent_[d]);
+                covers_tile = covers_tile && box_min[d] == tile_min && box_max[d] == tile_min + tile_extent_[d];
+            }
+
+            if (!write || !covers_tile) {
+                if (!seek(offset) || fread(scratch.data(), 1, tile_bytes, f) != (size_t)tile_bytes) return false;
+            }
+            copy_box(buf, t, box_min, box_max, write);
+            if (write) {
+                if (!seek(offset) || fwrite(scratch.data(), 1, tile_bytes, f) != (size_t)tile_bytes) return false;
+            }
+
+            // Advance to the next tile.
+            int d = 0;
+            while (d < max_dimensions && ++t[d] > tile_hi[d]) {
+                t[d] = tile_lo[d];
+                d++;
+            }
+            if (d == max_dimensions) break;
+        }
+        return write ? fflush(f) == 0 : true;
+    }
+
+    // Copy the box [box_min, box_max) between buf and the tile in
+    // scratch with tile coordinates t.
+    void copy_box(halide_buffer_t *buf, const int64_t *t,
+                  const int *box_min, const int *box_max, bool to_tile) {
+        int c[max_dimensions];
+        for (int d = 0; d < max_dimensions; d++) {
+            c[d] = box_min[d];
+        }
+        const int run = box_max[0] - box_min[0];
+        const bool dense = buf->dim[0].stride == 1;
+        while (true) {
+            int64_t tile_off = 0, buf_off = 0;
+            for (int d = 0; d < max_dimensions; d++) {
+                tile_off += (c[d] - t[d] * tile_extent_[d]) * tile_stride[d];
+                if (d < dimensions_) {
+                    buf_off += (int64_t)(c[d] - buf->dim[d].min) * buf->dim[d].stride;
+                }
+            }
+            uint8_t *tile_ptr = scratch.data() + tile_off * elem_size;
+            uint8_t *buf_ptr = buf->host + buf_off * elem_size;
+            if (dense) {
+                if (to_tile) {
+                    memcpy(tile_ptr, buf_ptr, run * elem_size);
+                } else {
+                    memcpy(buf_ptr, tile_ptr, run * elem_size);
+                }
+            } else {
+                const int64_t stride = (int64_t)buf->dim[0].stride * elem_size;
+                for (int i = 0; i < run; i++) {
+                    if (to_tile) {
+                        memcpy(tile_ptr + i * elem_size, buf_ptr + i * stride, elem_size);
+                    } else {
+                        memcpy(buf_ptr + i * stride, tile_ptr + i * elem_size, elem_size);
+                    }
+                }
+            }
+
+            int d = 1;
+            while (d < max_dimensions && ++c[d] >= box_max[d]) {
+                c[d] = box_min[d];
+                d++;
+            }
+            if (d == max_dimensions) break;
+        }
+    }
+};
+
+// The body of an extern stage that produces a region of a tiled
+// image. 'file' must point to an open TiledImageFile. Bounds queries
+// are accepted as-is, and each real call loads just the tiles that
+// overlap the region requested. Extern stages must have C linkage,
+// so wrap it with a one-line function:
+//
+//   extern "C" int load_input(void *file, halide_buffer_t *out) {
+//       return Halide::Tools::load_tiled_image_region(file, out);
+//   }
+//
+// and define the stage with
+//
+//   Param<void *> file;
+//   input.define_extern("load_input", {file}, type, dims);
+inline int load_tiled_image_region(void *file, halide_buffer_t *out) {
+    if (!out->host) {
+        // Bounds query. We can produce any region.
+        return 0;
+    }
+    return ((TiledImageFile *)file)->read_region(out) ? 0 : -1;
+}
+
+}  // namespace Tools
+}  // namespace Halide
+
+#endif  // HALIDE_TILED_IMAGE_H
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+// Compares a set of benchmark results against a recorded baseline
+// and reports statistically significant slowdowns. Both files
+// contain one JSON object per line, in the format written by
+// Halide::Tools::report_benchmark (see tools/halide_benchmark.h). If
+// a name occurs more than once in a file, the fastest entry wins.
+//
+// Usage: HalideBenchmarkCompare baseline.json results.json [threshold]
+//
+// A benchmark is flagged as a regression if its median is more than
+// 'threshold' (default 0.05, i.e. 5%) slower than the baseline median,
+// and Welch's t-test on the two sets of samples says the difference
+// is significant at roughly the 1% level. The number of regressions
+// is printed, and the exit code is 1 if there were any, so the tool
+// can gate a build.
+
+namespace {
+
+using std::map;
+using std::string;
+
+struct Result {
+    double min = 0, median = 0, p90 = 0, mean = 0, stddev = 0;
+    double samples = 0;
+};
+
+// Find "key": in a line and parse the number that follows it.
+bool get_number(const string &line, const char *key, double *value) {
+    string k = string("\"") + key + "\":";
+    size_t pos = line.find(k);
+    if (pos == string::npos) return false;
+    const char *start = line.c_str() + pos + k.size();
+    char *end = nullptr;
+    *value = strtod(start, &end);
+    return end != start;
+}
+
+// Find "name": in a line and parse the (escaped) string that follows
+// it.
+bool get_name(const string &line, string *name) {
+    const string k = "\"name\": \"";
+    size_t pos = line.find(k);
+    if (pos == string::npos) return false;
+    name->clear();
+    for (pos += k.size(); pos < line.size(); pos++) {
+        char c = line[pos];
+        if (c == '"') {
+            return true;
+        } else if (c != '\\') {
+            *name += c;
+        } else if (++pos >= line.size()) {
+            return false;
+        } else if (line[pos] == 'u') {
+            if (pos + 4 >= line.size()) return false;
+            *name += (char)strtol(line.substr(pos + 1, 4).c_str(), nullptr, 16);
+            pos += 4;
+        } else {
+            *name += line[pos];
+        }
+    }
+    return false;
+}
+
+bool load(const char *filename, map<string, Result> *results) {
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        fprintf(stderr, "Could not open %s\n", filename);
+        return false;
+    }
+    char buf[4096];
+    int line_number = 0;
+    while (fgets(buf, sizeof(buf), f)) {
+        line_number++;
+        string line(buf);
+        if (line.find_first_not_of(" \t\r\n") == string::npos) continue;
+        string name;
+        Result r;
+        if (!get_name(line, &name) ||
+            !get_number(line, "min", &r.min) ||
+            !get_number(line, "median", &r.median) ||
+            !get_number(line, "p90", &r.p90) ||
+            !get_number(line, "mean", &r.mean) ||
+            !get_number(line, "stddev", &r.stddev) ||
+            !get_number(line, "samples", &r.samples)) {
+            fprintf(stderr, "%s:%d: Could not parse benchmark result\n", filename, line_number);
+            fclose(f);
+            return false;
+        }
+        auto it = results->find(name);
+        if (it == results->end() || r.min < it->second.min) {
+            (*results)[name] = r;
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+// Welch's t statistic for the difference of means. Positive means
+// 'b' is slower than 'a'.
+double welch_t(const Result &a, const Result &b) {
+    double va = a.stddev * a.stddev / std::max(a.samples, 1.0);
+    double vb = b.stddev * b.stddev / std::max(b.samples, 1.0);
+    double denom = sqrt(va + vb);
+    if (denom == 0) {
+        return b.mean > a.mean ? INFINITY : 0;
+    }
+    return (b.mean - a.mean) / denom;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "Usage: %s baseline.json results.json [threshold]\n", argv[0]);
+        return -1;
+    }
+
+    double threshold = 0.05;
+    if (argc == 4) {
+        threshold = atof(argv[3]);
+    }
+
+    // One-sided critical value of the t distribution for p = 0.01,
+    // using the normal approximation. The benchmark harness takes
+    // enough samples that the difference is negligible.
+    const double t_critical = 2.33;
+
+    map<string, Result> baseline, results;
+    if (!load(argv[1], &baseline) || !load(argv[2], &results)) {
+        return -1;
+    }
+
+    int regressions = 0, improvements = 0, missing = 0;
+    printf("%-40s %12s %12s %9s %8s  %s\n", "benchmark", "baseline(ms)", "current(ms)", "change", "t", "status");
+    for (const auto &it : results) {
+        const string &name = it.first;
+        const Result &cur = it.second;
+        auto b = baseline.find(name);
+        if (b == baseline.end()) {
+            printf("%-40s %12s %12.4f %9s %8s  no baseline\n", name.c_str(), "-", cur.median * 1e3, "-", "-");
+            missing++;
+            continue;
+        }
+        const Result &base = b->second;
+        double change = (cur.median - base.median) / base.median;
+        double t = welch_t(base, cur);
+        const char *status = "ok";
+        if (change > threshold && t > t_critical) {
+            status = "REGRESSION";
+            regressions++;
+        } else if (change < -threshold && t < -t_critical) {
+            status = "improved";
+            improvements++;
+        }
+        printf("%-40s %12.4f %12.4f %+8.1f%% %8.2f  %s\n",
+               name.c_str(), base.median * 1e3, cur.median * 1e3, change * 100, t, status);
+    }
+
+    for (const auto &it : baseline) {
+        if (!results.count(it.first)) {
+            printf("%-40s %12.4f %12s %9s %8s  not run\n", it.first.c_str(), it.second.median * 1e3, "-", "-", "-");
+        }
+    }
+
+    printf("\n%d regression(s), %d improvement(s), %d benchmark(s) without a baseline\n",
+           regressions, improvements, missing);
+
+    // The exit status is only eight bits, so don't return the count.
+    return regressions > 0 ? 1 : 0;
+}